@@ -0,0 +1,93 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include <string>
+#include <unistd.h>
+#include <iostream>
+#include <cstdlib>
+#include "synthetic_net.h"
+#include "synthetic_sim.h"
+
+//default btreceiver range (matches simulate_analyze.sh)
+#define DEFAULT_RANGE 100.0
+//default output file prefix
+#define DEFAULT_PREFIX "synthetic"
+
+/**
+ * Generate synthetic sumo bt and netstate outputs for a network
+ * (for scale testing the analysis transformer without sumo)
+ */
+int main(int argc, char **argv) {
+  int c;
+  //the path to the network file
+  std::string net_input_path;
+  //the directory to write the outputs to
+  std::string output_path;
+  //output file prefix (<prefix>.bt_output.xml, <prefix>.ns_output.xml, <prefix>.net.xml)
+  std::string prefix = DEFAULT_PREFIX;
+  //lanes per edge (the network is widened and written to <prefix>.net.xml if above 1)
+  int lanes = 1;
+
+  generator::sim_config_t config = {0, 0, 0, 0, DEFAULT_RANGE};
+
+  while ((c = getopt(argc, argv, "n:o:p:v:t:d:s:r:l:")) != -1) {
+    if (c == 'n') {
+      net_input_path = std::string(optarg);
+    } else if (c == 'o') {
+      output_path = std::string(optarg);
+    } else if (c == 'p') {
+      prefix = std::string(optarg);
+    } else if (c == 'v') {
+      config.vehicle_count = std::strtoull(optarg, NULL, 10);
+    } else if (c == 't') {
+      config.tower_count = std::strtoull(optarg, NULL, 10);
+    } else if (c == 'd') {
+      config.duration = std::atoi(optarg);
+    } else if (c == 's') {
+      config.seed = std::strtoull(optarg, NULL, 10);
+    } else if (c == 'r') {
+      config.range = std::atof(optarg);
+    } else if (c == 'l') {
+      lanes = std::atoi(optarg);
+    }
+  }
+
+  //validate arguments
+  if (net_input_path.empty() || output_path.empty()) {
+    std::cerr << "Usage: " << argv[0] << " -n <net.xml> -o <output_dir> -v <vehicles> -t <towers> "
+              << "-d <duration> [-s <seed>] [-r <range>] [-p <prefix>] [-l <lanes>]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if ((config.duration <= 0) || (config.range <= 0) || (lanes <= 0)) {
+    std::cerr << "ERR: duration, range and lanes must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  generator::network_t net;
+  if (!net.load(net_input_path)) {
+    std::cerr << "ERR: failed to load network: " << net_input_path << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string dir = output_path;
+  if (dir.back() != '/') {
+    dir += "/";
+  }
+
+  if (lanes > 1) {
+    //multi lane edges: the outputs refer to the widened network
+    net.widen(lanes);
+    if (!net.write(dir + prefix + ".net.xml")) {
+      return EXIT_FAILURE;
+    }
+    std::cerr << "INFO: wrote " << net.lanes.size() << " lanes (" << lanes << " per edge) to: "
+              << dir << prefix << ".net.xml" << std::endl;
+  }
+
+  return generator::run_simulation(net,
+                                   config,
+                                   dir + prefix + ".bt_output.xml",
+                                   dir + prefix + ".ns_output.xml");
+}
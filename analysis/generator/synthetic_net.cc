@@ -0,0 +1,350 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "synthetic_net.h"
+#include "../src/parse/xml_loader.h"
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <exception>
+#include <cstdio>
+#include <vector>
+
+#define NET_NODE        "net"
+#define EDGE_NODE       "edge"
+#define LANE_NODE       "lane"
+#define CONNECTION_NODE "connection"
+#define ID_ATTR         "id"
+#define FUNCTION_ATTR   "function"
+#define INTERNAL_VAL    "internal"
+#define SHAPE_ATTR      "shape"
+#define LENGTH_ATTR     "length"
+#define SPEED_ATTR      "speed"
+#define FROM_ATTR       "from"
+#define TO_ATTR         "to"
+#define FROM_LANE_ATTR  "fromLane"
+#define TO_LANE_ATTR    "toLane"
+
+//sumo default lane width
+#define LANE_WIDTH 3.2
+
+namespace generator {
+
+  /**
+   * Get the cartesian position of a point along the lane
+   * @param pos the position along the lane (0 to length)
+   * @param x   position x
+   * @param y   position y
+   */
+  void lane_t::position_at(double pos, double& x, double& y) const {
+    //the shape length and the lane length are not always the same, scale
+    double shape_pos = (this->length > 0) ? pos * (this->cumulative.back() / this->length) : 0;
+
+    for (size_t i=1; i<this->vertices.size(); i++) {
+      if ((shape_pos <= this->cumulative.at(i)) || (i == this->vertices.size() - 1)) {
+        double seg = this->cumulative.at(i) - this->cumulative.at(i - 1);
+        double t = (seg > 0) ? (shape_pos - this->cumulative.at(i - 1)) / seg : 0;
+        t = std::fmin(std::fmax(t, 0.0), 1.0);
+
+        x = this->vertices.at(i - 1).first + t * (this->vertices.at(i).first - this->vertices.at(i - 1).first);
+        y = this->vertices.at(i - 1).second + t * (this->vertices.at(i).second - this->vertices.at(i - 1).second);
+        return;
+      }
+    }
+
+    x = this->vertices.front().first;
+    y = this->vertices.front().second;
+  }
+
+  /**
+   * Compute the cumulative shape length at each vertex
+   */
+  void lane_t::measure() {
+    this->cumulative.clear();
+    this->cumulative.push_back(0);
+    for (size_t i=1; i<this->vertices.size(); i++) {
+      this->cumulative.push_back(this->cumulative.back() +
+        sqrt(pow(this->vertices.at(i).first - this->vertices.at(i - 1).first, 2) +
+             pow(this->vertices.at(i).second - this->vertices.at(i - 1).second, 2)));
+    }
+  }
+
+  /**
+   * Read the lanes of a (non internal) edge
+   * @param edge_node the edge node
+   * @param net       the network to add to
+   * @param lane_idx  lane id to lane index lookup
+   */
+  void add_edge_lanes(rapidxml::xml_node<> *edge_node,
+                      network_t& net,
+                      std::unordered_map<std::string,size_t>& lane_idx) {
+    std::string edge_id;
+
+    for (rapidxml::xml_attribute<> *edge_attr = edge_node->first_attribute();
+         edge_attr;
+         edge_attr = edge_attr->next_attribute()) {
+      if ((strcmp(edge_attr->name(),  FUNCTION_ATTR) == 0) &&
+          (strcmp(edge_attr->value(), INTERNAL_VAL) == 0)) {
+        //vehicles are only placed on normal edges
+        return;
+      } else if (strcmp(edge_attr->name(), ID_ATTR) == 0) {
+        edge_id = std::string(edge_attr->value());
+      }
+    }
+
+    size_t edge_idx = net.edges.size();
+    net.edges.push_back(edge_id);
+
+    for (rapidxml::xml_node<> *lane_node = edge_node->first_node(LANE_NODE);
+         lane_node;
+         lane_node = lane_node->next_sibling(LANE_NODE)) {
+      lane_t lane;
+      lane.edge_id = edge_id;
+      lane.edge_idx = edge_idx;
+      lane.length = 0;
+      lane.speed = 0;
+      int not_found = 4;
+
+      for (rapidxml::xml_attribute<> *lane_attr = lane_node->first_attribute();
+           lane_attr;
+           lane_attr = lane_attr->next_attribute()) {
+        if (strcmp(lane_attr->name(), ID_ATTR) == 0) {
+          lane.id = std::string(lane_attr->value());
+          not_found--;
+        } else if (strcmp(lane_attr->name(), LENGTH_ATTR) == 0) {
+          lane.length = atof(lane_attr->value());
+          not_found--;
+        } else if (strcmp(lane_attr->name(), SPEED_ATTR) == 0) {
+          lane.speed = atof(lane_attr->value());
+          not_found--;
+        } else if (strcmp(lane_attr->name(), SHAPE_ATTR) == 0) {
+          std::string shape = std::string(lane_attr->value());
+          if (!parse::parse_shape(shape, lane.vertices)) {
+            std::cerr << "ERR: failed to parse shape: " << shape << std::endl;
+            throw std::exception();
+          }
+          not_found--;
+        }
+      }
+
+      if (not_found > 0) {
+        std::cerr << "ERR: lane missing id, length, speed or shape" << std::endl;
+        throw std::exception();
+      }
+
+      //precompute cumulative shape lengths
+      lane.measure();
+
+      lane_idx.insert(std::make_pair(lane.id, net.lanes.size()));
+      net.lanes.push_back(std::move(lane));
+    }
+  }
+
+  /**
+   * Add a connection between two lanes (if both are drivable)
+   * @param connection_node the connection node
+   * @param net             the network
+   * @param lane_idx        lane id to lane index lookup
+   */
+  void add_connection(rapidxml::xml_node<> *connection_node,
+                      network_t& net,
+                      const std::unordered_map<std::string,size_t>& lane_idx) {
+    std::string from, to, from_lane, to_lane;
+
+    for (rapidxml::xml_attribute<> *attr = connection_node->first_attribute();
+         attr;
+         attr = attr->next_attribute()) {
+      if (strcmp(attr->name(), FROM_ATTR) == 0) {
+        from = std::string(attr->value());
+      } else if (strcmp(attr->name(), TO_ATTR) == 0) {
+        to = std::string(attr->value());
+      } else if (strcmp(attr->name(), FROM_LANE_ATTR) == 0) {
+        from_lane = std::string(attr->value());
+      } else if (strcmp(attr->name(), TO_LANE_ATTR) == 0) {
+        to_lane = std::string(attr->value());
+      }
+    }
+
+    //connections from or to internal lanes are not in the lookup
+    std::unordered_map<std::string,size_t>::const_iterator from_it = lane_idx.find(from + "_" + from_lane);
+    std::unordered_map<std::string,size_t>::const_iterator to_it = lane_idx.find(to + "_" + to_lane);
+
+    if ((from_it != lane_idx.end()) && (to_it != lane_idx.end())) {
+      net.lanes.at(from_it->second).next.push_back(to_it->second);
+    }
+  }
+
+  /**
+   * Load the lanes and connections from a sumo network file
+   * @param  path the path to the .net.xml file
+   * @return      success or failure
+   */
+  bool network_t::load(const std::string& path) {
+    std::unordered_map<std::string,size_t> lane_idx;
+
+    return parse::load_from_path(path, [this, &lane_idx] (const rapidxml::xml_document<>& doc) {
+      if (strcmp(doc.first_node()->name(), NET_NODE) != 0) {
+        std::cerr << "ERR doc root node not: " << NET_NODE << std::endl;
+        throw std::exception();
+      }
+
+      //edges always precede connections in a sumo network
+      for (rapidxml::xml_node<> *node = doc.first_node(NET_NODE)->first_node();
+           node;
+           node = node->next_sibling()) {
+        if (strcmp(node->name(), EDGE_NODE) == 0) {
+          add_edge_lanes(node, *this, lane_idx);
+        } else if (strcmp(node->name(), CONNECTION_NODE) == 0) {
+          add_connection(node, *this, lane_idx);
+        }
+      }
+
+      if (this->lanes.empty()) {
+        std::cerr << "ERR network has no drivable lanes" << std::endl;
+        throw std::exception();
+      }
+    });
+  }
+
+  /**
+   * Shift a lane shape to the left (each vertex along the mean normal of its segments)
+   * @param vertices the shape
+   * @param offset   the distance to shift by (negative to the right)
+   * @return         the shifted shape
+   */
+  std::vector<std::pair<double,double>> shift_left(const std::vector<std::pair<double,double>>& vertices, double offset) {
+    std::vector<std::pair<double,double>> shifted;
+
+    for (size_t i=0; i<vertices.size(); i++) {
+      double nx = 0, ny = 0;
+      //left normals of the segments before and after the vertex
+      for (size_t j : {i, i + 1}) {
+        if ((j > 0) && (j < vertices.size())) {
+          double dx = vertices[j].first - vertices[j - 1].first;
+          double dy = vertices[j].second - vertices[j - 1].second;
+          double len = sqrt(dx * dx + dy * dy);
+          if (len > 0) {
+            nx -= dy / len;
+            ny += dx / len;
+          }
+        }
+      }
+
+      double len = sqrt(nx * nx + ny * ny);
+      if (len > 0) {
+        nx /= len;
+        ny /= len;
+      }
+      shifted.emplace_back(vertices[i].first + nx * offset, vertices[i].second + ny * offset);
+    }
+    return shifted;
+  }
+
+  /**
+   * Widen every edge to a number of lanes: the first lane of the edge becomes the innermost lane
+   * and lane k (0 is the rightmost, like sumo) lies lanes - 1 - k lane widths to its right, lane k
+   * connects to lane k of each successor edge (on every other edge lane 0 gets an extra vertex,
+   * as lanes of a sumo edge don't always share vertices)
+   * @param lanes the number of lanes per edge
+   */
+  void network_t::widen(int lanes) {
+    //the first lane and the successor edges of each edge
+    std::vector<size_t> first(this->edges.size(), this->lanes.size());
+    std::vector<std::vector<size_t>> next_edges(this->edges.size());
+
+    for (size_t i=0; i<this->lanes.size(); i++) {
+      const lane_t& lane = this->lanes[i];
+      first[lane.edge_idx] = std::min(first[lane.edge_idx], i);
+      for (size_t n : lane.next) {
+        size_t next_edge = this->lanes[n].edge_idx;
+        if (std::find(next_edges[lane.edge_idx].begin(), next_edges[lane.edge_idx].end(), next_edge) == next_edges[lane.edge_idx].end()) {
+          next_edges[lane.edge_idx].push_back(next_edge);
+        }
+      }
+    }
+
+    //lanes of an edge stay adjacent (lane k of edge e is at e * lanes + k)
+    std::vector<lane_t> widened;
+    for (size_t e=0; e<this->edges.size(); e++) {
+      const lane_t& base = this->lanes.at(first[e]);
+
+      for (int k=0; k<lanes; k++) {
+        lane_t lane;
+        lane.id = this->edges[e] + "_" + std::to_string(k);
+        lane.edge_id = this->edges[e];
+        lane.edge_idx = e;
+        lane.length = base.length;
+        lane.speed = base.speed;
+        lane.vertices = shift_left(base.vertices, (k - (lanes - 1)) * LANE_WIDTH);
+
+        if ((e % 2 == 1) && (k == 0) && (lane.vertices.size() >= 2)) {
+          //split the first segment (the shape is unchanged)
+          lane.vertices.insert(lane.vertices.begin() + 1,
+            {(lane.vertices[0].first + lane.vertices[1].first) / 2, (lane.vertices[0].second + lane.vertices[1].second) / 2});
+        }
+        lane.measure();
+
+        for (size_t next_edge : next_edges[e]) {
+          lane.next.push_back(next_edge * lanes + k);
+        }
+        widened.push_back(std::move(lane));
+      }
+    }
+
+    this->lanes = std::move(widened);
+  }
+
+  /**
+   * Write the lanes and connections as a sumo network file (no junctions or internal lanes)
+   * @param  path the path to write to
+   * @return      success or failure
+   */
+  bool network_t::write(const std::string& path) const {
+    FILE *net_file = fopen(path.c_str(), "wb");
+    if (net_file == NULL) {
+      std::cerr << "ERR: failed to open " << path << std::endl;
+      return false;
+    }
+
+    fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n\n<net version=\"1.9\">\n", net_file);
+
+    for (size_t i=0; i<this->lanes.size(); i++) {
+      const lane_t& lane = this->lanes[i];
+      if ((i == 0) || (this->lanes[i - 1].edge_idx != lane.edge_idx)) {
+        fprintf(net_file, "    <edge id=\"%s\">\n", lane.edge_id.c_str());
+      }
+
+      //the index is the lane id suffix
+      fprintf(net_file, "        <lane id=\"%s\" index=\"%s\" speed=\"%.2f\" length=\"%.2f\" shape=\"",
+              lane.id.c_str(), lane.id.substr(lane.id.rfind('_') + 1).c_str(), lane.speed, lane.length);
+      for (size_t v=0; v<lane.vertices.size(); v++) {
+        fprintf(net_file, "%s%.2f,%.2f", v ? " " : "", lane.vertices[v].first, lane.vertices[v].second);
+      }
+      fputs("\"/>\n", net_file);
+
+      if ((i == this->lanes.size() - 1) || (this->lanes[i + 1].edge_idx != lane.edge_idx)) {
+        fputs("    </edge>\n", net_file);
+      }
+    }
+
+    for (const lane_t& lane : this->lanes) {
+      for (size_t n : lane.next) {
+        const lane_t& next = this->lanes[n];
+        fprintf(net_file, "    <connection from=\"%s\" to=\"%s\" fromLane=\"%s\" toLane=\"%s\"/>\n",
+                lane.edge_id.c_str(), next.edge_id.c_str(),
+                lane.id.substr(lane.id.rfind('_') + 1).c_str(), next.id.substr(next.id.rfind('_') + 1).c_str());
+      }
+    }
+
+    fputs("</net>\n", net_file);
+    bool success = (ferror(net_file) == 0);
+    fclose(net_file);
+
+    if (!success) {
+      std::cerr << "ERR: failed to write " << path << std::endl;
+    }
+    return success;
+  }
+}
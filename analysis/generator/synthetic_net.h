@@ -0,0 +1,80 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _SYNTHETIC_NET_H
+#define _SYNTHETIC_NET_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+namespace generator {
+  /*
+   * A drivable (non internal) lane in the network and its successors
+   */
+  struct lane_t {
+    //the lane id and the id of its parent edge
+    std::string id;
+    std::string edge_id;
+    //index of the parent edge in the network edge list
+    size_t edge_idx;
+    //lane length (sumo position units) and speed limit
+    double length;
+    double speed;
+    //the lane shape and the cumulative shape length at each vertex
+    std::vector<std::pair<double,double>> vertices;
+    std::vector<double> cumulative;
+    //indices of lanes reachable from the end of this lane
+    std::vector<size_t> next;
+
+    /**
+     * Get the cartesian position of a point along the lane
+     * @param pos the position along the lane (0 to length)
+     * @param x   position x
+     * @param y   position y
+     */
+    void position_at(double pos, double& x, double& y) const;
+
+    /**
+     * Compute the cumulative shape length at each vertex
+     */
+    void measure();
+  };
+
+  /*
+   * The lanes of a sumo network and the connections between them
+   */
+  struct network_t {
+    //all drivable lanes
+    std::vector<lane_t> lanes;
+    //all edge ids (lanes refer to these by index)
+    std::vector<std::string> edges;
+
+    /**
+     * Load the lanes and connections from a sumo network file
+     * @param  path the path to the .net.xml file
+     * @return      success or failure
+     */
+    [[nodiscard]] bool load(const std::string& path);
+
+    /**
+     * Widen every edge to a number of lanes: the first lane of the edge becomes the innermost lane
+     * and lane k (0 is the rightmost, like sumo) lies lanes - 1 - k lane widths to its right, lane k
+     * connects to lane k of each successor edge (on every other edge lane 0 gets an extra vertex,
+     * as lanes of a sumo edge don't always share vertices)
+     * @param lanes the number of lanes per edge
+     */
+    void widen(int lanes);
+
+    /**
+     * Write the lanes and connections as a sumo network file (no junctions or internal lanes)
+     * @param  path the path to write to
+     * @return      success or failure
+     */
+    [[nodiscard]] bool write(const std::string& path) const;
+  };
+}
+
+#endif /*_SYNTHETIC_NET_H*/
@@ -0,0 +1,446 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "synthetic_sim.h"
+#include <random>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <iostream>
+#include <cstdio>
+#include <cstdarg>
+#include <cmath>
+#include <algorithm>
+
+//tower output is spilled to disk beyond this size
+#define TOWER_BUFFER_LIMIT (1 << 20)
+//netstate output is flushed beyond this size
+#define NETSTATE_BUFFER_LIMIT (1 << 22)
+
+#define XML_HEADER "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n\n"
+#define NETSTATE_OPEN "<netstate xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" " \
+                      "xsi:noNamespaceSchemaLocation=\"http://sumo.dlr.de/xsd/netstate_file.xsd\">\n"
+#define NETSTATE_CLOSE "</netstate>\n"
+#define BT_OUTPUT_OPEN "<bt-output>\n"
+#define BT_OUTPUT_CLOSE "</bt-output>\n"
+
+//tower vehicle prefix (matches generation/tower_placer.py)
+#define TOWER_PREFIX "tower_"
+
+namespace generator {
+
+  /*
+   * Deterministic random source (std distributions are implementation defined)
+   */
+  struct rng_t {
+    std::mt19937_64 engine;
+
+    rng_t(uint64_t seed) : engine(seed) {}
+
+    /**
+     * @return uniform double in [0, 1)
+     */
+    double uniform() {
+      return (this->engine() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /**
+     * @param  lo lower bound
+     * @param  hi upper bound
+     * @return    uniform double in [lo, hi)
+     */
+    double uniform(double lo, double hi) {
+      return lo + (hi - lo) * this->uniform();
+    }
+
+    /**
+     * @param  n the number of options (> 0)
+     * @return   uniform index in [0, n)
+     */
+    size_t index(size_t n) {
+      return this->engine() % n;
+    }
+  };
+
+  /*
+   * The state of a vehicle at one timestep
+   */
+  struct sample_t {
+    int t;
+    double x;
+    double y;
+    double speed;
+    size_t lane;
+    double lane_pos;
+  };
+
+  /*
+   * A moving vehicle
+   */
+  struct vehicle_t {
+    std::string id;
+    //departure and arrival times
+    int depart;
+    int arrive;
+    //current lane and position along the lane
+    size_t lane;
+    double pos;
+    //fraction of the lane speed limit this vehicle drives at
+    double speed_factor;
+  };
+
+  /*
+   * A contiguous period where a tower sees a vehicle (a <seen> element)
+   */
+  struct contact_t {
+    int last_t;
+    std::vector<sample_t> points;
+  };
+
+  /*
+   * A tower (parked vehicle with a btreceiver device)
+   */
+  struct tower_t {
+    std::string id;
+    size_t lane;
+    double pos;
+    double x;
+    double y;
+    //open contacts by vehicle index (ordered to keep output deterministic)
+    std::map<size_t,contact_t> open;
+    //formatted <seen> elements not yet written to the spill file
+    std::string buffer;
+    std::string spill_path;
+    bool spilled;
+  };
+
+  /**
+   * Append printf style formatted text to a string
+   * @param out the string to append to
+   * @param fmt format string
+   */
+  void append_format(std::string& out, const char *fmt, ...) {
+    char stack_buff[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(stack_buff, sizeof(stack_buff), fmt, args);
+    va_end(args);
+
+    if (n < (int) sizeof(stack_buff)) {
+      out.append(stack_buff, n);
+    } else {
+      std::vector<char> heap_buff(n + 1);
+      va_start(args, fmt);
+      vsnprintf(heap_buff.data(), heap_buff.size(), fmt, args);
+      va_end(args);
+      out.append(heap_buff.data(), n);
+    }
+  }
+
+  /**
+   * Get the spatial grid cell key for a position
+   * @param  x    position x
+   * @param  y    position y
+   * @param  cell the cell size
+   * @param  dx   column offset
+   * @param  dy   row offset
+   * @return      the cell key
+   */
+  inline int64_t cell_key(double x, double y, double cell, int64_t dx, int64_t dy) {
+    int64_t ix = (int64_t) floor(x / cell) + dx;
+    int64_t iy = (int64_t) floor(y / cell) + dy;
+    return (int64_t) (((uint64_t) ix << 32) ^ (uint32_t) iy);
+  }
+
+  /**
+   * Write the open contact for a vehicle as a <seen> element (like the sumo btreceiver device)
+   * @param tower    the observing tower
+   * @param net      the network
+   * @param vehicle  the observed vehicle
+   * @param contact  the contact
+   */
+  void close_contact(tower_t& tower,
+                     const network_t& net,
+                     const vehicle_t& vehicle,
+                     const contact_t& contact) {
+    const sample_t& beg = contact.points.front();
+    const sample_t& end = contact.points.back();
+    const std::string& tower_lane = net.lanes.at(tower.lane).id;
+
+    append_format(tower.buffer,
+      "        <seen id=\"%s\" tBeg=\"%d.00\" observerPosBeg=\"%.2f,%.2f\" observerSpeedBeg=\"0.00\" "
+      "observerLaneIDBeg=\"%s\" observerLanePosBeg=\"%.2f\" seenPosBeg=\"%.2f,%.2f\" seenSpeedBeg=\"%.2f\" "
+      "seenLaneIDBeg=\"%s\" seenLanePosBeg=\"%.2f\" tEnd=\"%d.00\" observerPosEnd=\"%.2f,%.2f\" "
+      "observerSpeedEnd=\"0.00\" observerLaneIDEnd=\"%s\" observerLanePosEnd=\"%.2f\" seenPosEnd=\"%.2f,%.2f\" "
+      "seenSpeedEnd=\"%.2f\" seenLaneIDEnd=\"%s\" seenLanePosEnd=\"%.2f\">\n",
+      vehicle.id.c_str(), beg.t, tower.x, tower.y, tower_lane.c_str(), tower.pos,
+      beg.x, beg.y, beg.speed, net.lanes.at(beg.lane).id.c_str(), beg.lane_pos,
+      end.t, tower.x, tower.y, tower_lane.c_str(), tower.pos,
+      end.x, end.y, end.speed, net.lanes.at(end.lane).id.c_str(), end.lane_pos);
+
+    for (const sample_t& s : contact.points) {
+      append_format(tower.buffer,
+        "            <recognitionPoint t=\"%d.00\" observerPos=\"%.2f,%.2f\" observerSpeed=\"0.00\" "
+        "observerLaneID=\"%s\" observerLanePos=\"%.2f\" seenPos=\"%.2f,%.2f\" seenSpeed=\"%.2f\" "
+        "seenLaneID=\"%s\" seenLanePos=\"%.2f\"/>\n",
+        s.t, tower.x, tower.y, tower_lane.c_str(), tower.pos,
+        s.x, s.y, s.speed, net.lanes.at(s.lane).id.c_str(), s.lane_pos);
+    }
+
+    tower.buffer += "        </seen>\n";
+  }
+
+  /**
+   * Append the buffered output for a tower to its spill file
+   * @param  tower the tower
+   * @return       success or failure
+   */
+  [[nodiscard]] bool spill(tower_t& tower) {
+    FILE *spill_file = fopen(tower.spill_path.c_str(), tower.spilled ? "ab" : "wb");
+    if (spill_file == NULL) {
+      std::cerr << "ERR: failed to open " << tower.spill_path << std::endl;
+      return false;
+    }
+
+    bool success = fwrite(tower.buffer.data(), 1, tower.buffer.size(), spill_file) == tower.buffer.size();
+    fclose(spill_file);
+
+    tower.buffer.clear();
+    tower.spilled = true;
+    return success;
+  }
+
+  /**
+   * Write the bt output: each tower and all of the vehicles it has seen
+   * @param  towers  the towers
+   * @param  bt_path the path to write to
+   * @return         success or failure
+   */
+  [[nodiscard]] bool write_bt_output(std::vector<tower_t>& towers, const std::string& bt_path) {
+    FILE *bt_file = fopen(bt_path.c_str(), "wb");
+    if (bt_file == NULL) {
+      std::cerr << "ERR: failed to open " << bt_path << std::endl;
+      return false;
+    }
+
+    bool success = true;
+    fputs(XML_HEADER BT_OUTPUT_OPEN, bt_file);
+
+    for (tower_t& tower : towers) {
+      fprintf(bt_file, "    <bt id=\"%s\">\n", tower.id.c_str());
+
+      //copy anything that was spilled first (preserves order)
+      if (tower.spilled) {
+        FILE *spill_file = fopen(tower.spill_path.c_str(), "rb");
+        if (spill_file == NULL) {
+          std::cerr << "ERR: failed to reopen " << tower.spill_path << std::endl;
+          success = false;
+        } else {
+          char copy_buff[1 << 16];
+          size_t n;
+          while ((n = fread(copy_buff, 1, sizeof(copy_buff), spill_file)) > 0) {
+            fwrite(copy_buff, 1, n, bt_file);
+          }
+          fclose(spill_file);
+        }
+        remove(tower.spill_path.c_str());
+      }
+
+      fwrite(tower.buffer.data(), 1, tower.buffer.size(), bt_file);
+      fputs("    </bt>\n", bt_file);
+      tower.buffer.clear();
+    }
+
+    fputs(BT_OUTPUT_CLOSE, bt_file);
+    success = (fclose(bt_file) == 0) && success;
+    return success;
+  }
+
+  /**
+   * Move vehicles along the network and write sumo compatible outputs
+   * (equivalent to --bt-output and --netstate-dump)
+   * @param  net     the network
+   * @param  config  simulation parameters
+   * @param  bt_path the path to write the bt output to
+   * @param  ns_path the path to write the netstate output to
+   * @return         the status
+   */
+  int run_simulation(const network_t& net,
+                     const sim_config_t& config,
+                     const std::string& bt_path,
+                     const std::string& ns_path) {
+    rng_t rng(config.seed);
+
+    //place towers at random lane positions (like parking areas)
+    std::vector<tower_t> towers(config.tower_count);
+    std::unordered_map<int64_t,std::vector<size_t>> tower_grid;
+
+    for (size_t i=0; i<towers.size(); i++) {
+      tower_t& tower = towers.at(i);
+      tower.id = TOWER_PREFIX + std::to_string(i);
+      tower.lane = rng.index(net.lanes.size());
+      tower.pos = rng.uniform(0, net.lanes.at(tower.lane).length);
+      net.lanes.at(tower.lane).position_at(tower.pos, tower.x, tower.y);
+      tower.spill_path = bt_path + "." + std::to_string(i) + ".part";
+      tower.spilled = false;
+
+      tower_grid[cell_key(tower.x, tower.y, config.range, 0, 0)].push_back(i);
+    }
+
+    //schedule vehicles
+    std::vector<vehicle_t> vehicles(config.vehicle_count);
+    for (size_t i=0; i<vehicles.size(); i++) {
+      vehicle_t& vehicle = vehicles.at(i);
+      vehicle.id = std::to_string(i);
+      vehicle.depart = (int) rng.uniform(0, config.duration);
+      vehicle.arrive = vehicle.depart + (int) rng.uniform(config.duration / 4.0, config.duration);
+      vehicle.lane = rng.index(net.lanes.size());
+      vehicle.pos = rng.uniform(0, net.lanes.at(vehicle.lane).length);
+      vehicle.speed_factor = rng.uniform(0.7, 1.0);
+    }
+
+    FILE *ns_file = fopen(ns_path.c_str(), "wb");
+    if (ns_file == NULL) {
+      std::cerr << "ERR: failed to open " << ns_path << std::endl;
+      return EXIT_FAILURE;
+    }
+    fputs(XML_HEADER NETSTATE_OPEN, ns_file);
+
+    //vehicles on each lane for the current timestep
+    std::vector<std::vector<std::pair<size_t,sample_t>>> lane_vehicles(net.lanes.size());
+    std::vector<size_t> occupied;
+    std::string ns_buffer;
+    bool success = true;
+
+    for (int t=0; t<config.duration; t++) {
+      occupied.clear();
+
+      for (size_t vi=0; vi<vehicles.size(); vi++) {
+        vehicle_t& vehicle = vehicles.at(vi);
+        if ((t < vehicle.depart) || (t >= vehicle.arrive)) {
+          continue;
+        }
+
+        const lane_t& lane = net.lanes.at(vehicle.lane);
+        double speed = lane.speed * vehicle.speed_factor;
+
+        //record on the lane for the netstate
+        if (lane_vehicles.at(vehicle.lane).empty()) {
+          occupied.push_back(vehicle.lane);
+        }
+
+        //check for towers in range
+        sample_t sample = {t, 0, 0, speed, vehicle.lane, vehicle.pos};
+        lane.position_at(vehicle.pos, sample.x, sample.y);
+        lane_vehicles.at(vehicle.lane).push_back(std::make_pair(vi, sample));
+
+        for (int64_t dx=-1; dx<=1; dx++) {
+          for (int64_t dy=-1; dy<=1; dy++) {
+            std::unordered_map<int64_t,std::vector<size_t>>::const_iterator cell
+              = tower_grid.find(cell_key(sample.x, sample.y, config.range, dx, dy));
+            if (cell == tower_grid.end()) {
+              continue;
+            }
+
+            for (size_t ti : cell->second) {
+              tower_t& tower = towers.at(ti);
+              double d = sqrt(pow(tower.x - sample.x, 2) + pow(tower.y - sample.y, 2));
+              if (d <= config.range) {
+                contact_t& contact = tower.open[vi];
+                contact.last_t = t;
+                contact.points.push_back(sample);
+              }
+            }
+          }
+        }
+
+        //advance to the next timestep, crossing onto following lanes
+        vehicle.pos += speed;
+        while (vehicle.pos > net.lanes.at(vehicle.lane).length) {
+          const lane_t& current = net.lanes.at(vehicle.lane);
+          if (current.next.empty()) {
+            //dead end: vehicle leaves the simulation
+            vehicle.arrive = t + 1;
+            break;
+          }
+          vehicle.pos -= current.length;
+          vehicle.lane = current.next.at(rng.index(current.next.size()));
+        }
+      }
+
+      //close contacts that ended this timestep
+      for (tower_t& tower : towers) {
+        std::map<size_t,contact_t>::iterator it = tower.open.begin();
+        while (it != tower.open.end()) {
+          if (it->second.last_t != t) {
+            close_contact(tower, net, vehicles.at(it->first), it->second);
+            it = tower.open.erase(it);
+          } else {
+            it++;
+          }
+        }
+
+        if ((tower.buffer.size() > TOWER_BUFFER_LIMIT) && !spill(tower)) {
+          success = false;
+        }
+      }
+
+      //write the netstate timestep (lane indices are grouped by edge)
+      std::sort(occupied.begin(), occupied.end());
+      append_format(ns_buffer, "    <timestep time=\"%d.00\">\n", t);
+
+      for (size_t i=0; i<occupied.size(); i++) {
+        const lane_t& lane = net.lanes.at(occupied.at(i));
+        if ((i == 0) || (net.lanes.at(occupied.at(i - 1)).edge_idx != lane.edge_idx)) {
+          append_format(ns_buffer, "        <edge id=\"%s\">\n", lane.edge_id.c_str());
+        }
+
+        append_format(ns_buffer, "            <lane id=\"%s\">\n", lane.id.c_str());
+        for (const std::pair<size_t,sample_t>& v : lane_vehicles.at(occupied.at(i))) {
+          append_format(ns_buffer, "                <vehicle id=\"%s\" pos=\"%.2f\" speed=\"%.2f\"/>\n",
+                        vehicles.at(v.first).id.c_str(), v.second.lane_pos, v.second.speed);
+        }
+        ns_buffer += "            </lane>\n";
+        lane_vehicles.at(occupied.at(i)).clear();
+
+        if ((i == occupied.size() - 1) || (net.lanes.at(occupied.at(i + 1)).edge_idx != lane.edge_idx)) {
+          ns_buffer += "        </edge>\n";
+        }
+      }
+      ns_buffer += "    </timestep>\n";
+
+      if (ns_buffer.size() > NETSTATE_BUFFER_LIMIT) {
+        success = (fwrite(ns_buffer.data(), 1, ns_buffer.size(), ns_file) == ns_buffer.size()) && success;
+        ns_buffer.clear();
+      }
+
+      if ((config.duration >= 10) && ((t + 1) % (config.duration / 10) == 0)) {
+        std::cerr << "INFO: simulated " << (t + 1) << "/" << config.duration << " timesteps" << std::endl;
+      }
+    }
+
+    ns_buffer += NETSTATE_CLOSE;
+    success = (fwrite(ns_buffer.data(), 1, ns_buffer.size(), ns_file) == ns_buffer.size()) && success;
+    success = (fclose(ns_file) == 0) && success;
+
+    //close remaining contacts
+    for (tower_t& tower : towers) {
+      for (const std::pair<const size_t,contact_t>& open : tower.open) {
+        close_contact(tower, net, vehicles.at(open.first), open.second);
+      }
+      tower.open.clear();
+    }
+
+    success = write_bt_output(towers, bt_path) && success;
+
+    if (!success) {
+      std::cerr << "ERR: failed to write synthetic output" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cerr << "INFO: wrote bt output to: " << bt_path << std::endl;
+    std::cerr << "INFO: wrote netstate output to: " << ns_path << std::endl;
+    return EXIT_SUCCESS;
+  }
+}
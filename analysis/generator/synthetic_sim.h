@@ -0,0 +1,44 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _SYNTHETIC_SIM_H
+#define _SYNTHETIC_SIM_H
+
+#include <string>
+#include <stdint.h>
+#include "synthetic_net.h"
+
+namespace generator {
+  /*
+   * Parameters for a synthetic simulation run
+   */
+  struct sim_config_t {
+    //number of vehicles (excluding towers)
+    size_t vehicle_count;
+    //number of towers (parked btreceiver vehicles)
+    size_t tower_count;
+    //simulation length in seconds
+    int duration;
+    //random seed (the same seed always produces the same output)
+    uint64_t seed;
+    //the btreceiver range (sumo default is 100)
+    double range;
+  };
+
+  /**
+   * Move vehicles along the network and write sumo compatible outputs
+   * (equivalent to --bt-output and --netstate-dump)
+   * @param  net     the network
+   * @param  config  simulation parameters
+   * @param  bt_path the path to write the bt output to
+   * @param  ns_path the path to write the netstate output to
+   * @return         the status
+   */
+  int run_simulation(const network_t& net,
+                     const sim_config_t& config,
+                     const std::string& bt_path,
+                     const std::string& ns_path);
+}
+
+#endif /*_SYNTHETIC_SIM_H*/
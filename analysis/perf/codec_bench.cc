@@ -0,0 +1,202 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "../src/codec/int_codec.h"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+
+//default timed repetitions (best time is reported)
+#define DEFAULT_REPEAT 5
+#define PACKED_RECOGNITION_MAGIC "SMPKREC1"
+
+/**
+ * Read a file
+ * @param  path the path
+ * @param  data the contents
+ * @return      whether the file could be read
+ */
+static bool read_file(const std::string& path, std::string& data) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  std::ostringstream buff;
+  buff << in.rdbuf();
+  data = buff.str();
+  return true;
+}
+
+/**
+ * Best wall time of repeated runs
+ * @param  repeat the number of runs
+ * @param  fn     the function to time
+ * @return        seconds
+ */
+static double best_time(int repeat, const std::function<void()>& fn) {
+  double best = -1;
+  for (int i=0; i<repeat; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if ((best < 0) || (elapsed < best)) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+/**
+ * Read a little endian value and advance
+ * @param  in the position
+ * @return    the value
+ */
+template<typename T>
+static T take(const uint8_t *& in) {
+  T value;
+  memcpy(&value, in, sizeof(T));
+  in += sizeof(T);
+  return value;
+}
+
+/**
+ * Load the timestep column of each (tower, vehicle) series of a packed recognition output
+ * @param  path   the packed recognition output
+ * @param  series the decoded timestep columns
+ * @return        whether the file could be read
+ */
+static bool load_series(const std::string& path, std::vector<std::vector<int32_t>>& series) {
+  std::string data;
+  if (!read_file(path, data) || (data.compare(0, 8, PACKED_RECOGNITION_MAGIC) != 0)) {
+    return false;
+  }
+
+  const uint8_t *in = reinterpret_cast<const uint8_t*>(data.data()) + 8;
+  codec::codec_t codec = (codec::codec_t) take<uint32_t>(in);
+  uint32_t towers = take<uint32_t>(in);
+  uint32_t vehicles = take<uint32_t>(in);
+  take<double>(in);
+
+  //skip the dictionaries
+  for (uint32_t i=0; i<towers + vehicles; i++) {
+    in += take<uint16_t>(in);
+  }
+
+  for (uint32_t t=0; t<towers; t++) {
+    uint32_t count = take<uint32_t>(in);
+    for (uint32_t s=0; s<count; s++) {
+      take<uint32_t>(in);
+      uint32_t values = take<uint32_t>(in);
+      uint32_t bytes = take<uint32_t>(in);
+
+      series.emplace_back(values);
+      codec::decode_column(in, values, codec, series.back().data());
+      in += bytes + values * sizeof(uint16_t);
+    }
+  }
+  return true;
+}
+
+/**
+ * Benchmark the integer codecs on the timestep columns of a packed recognition
+ * output (written with --packed): encoded size and decode throughput of the raw
+ * int32 column, varint and bitpack
+ */
+int main(int argc, char **argv) {
+  int c;
+  int repeat = DEFAULT_REPEAT;
+
+  while ((c = getopt(argc, argv, "r:")) != -1) {
+    if (c == 'r') {
+      repeat = std::max(1, atoi(optarg));
+    } else {
+      std::cerr << "usage: " << argv[0] << " [-r repeat] <packed_recognition_output.bin>" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (optind >= argc) {
+    std::cerr << "usage: " << argv[0] << " [-r repeat] <packed_recognition_output.bin>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::vector<int32_t>> series;
+  if (!load_series(argv[optind], series)) {
+    std::cerr << "ERR: failed to read packed recognition output: " << argv[optind] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  size_t values = 0;
+  for (const std::vector<int32_t>& column : series) {
+    values += column.size();
+  }
+  std::vector<int32_t> out(values);
+
+  std::cout << std::left << std::setw(10) << "codec"
+            << std::right << std::setw(12) << "bytes" << std::setw(14) << "bits/value"
+            << std::setw(14) << "decode s" << std::setw(16) << "Mvalues/s" << std::endl;
+
+  auto report = [&](const std::string& name, size_t bytes, double decode_s) {
+    std::cout << std::left << std::setw(10) << name
+              << std::right << std::setw(12) << bytes
+              << std::setw(14) << std::fixed << std::setprecision(2) << (8.0 * bytes / values)
+              << std::setw(14) << std::setprecision(4) << decode_s
+              << std::setw(16) << std::setprecision(1) << (values / decode_s / 1e6)
+              << std::defaultfloat << std::endl;
+  };
+
+  //raw int32 columns (copy)
+  double raw_s = best_time(repeat, [&]() {
+    int32_t *dst = out.data();
+    for (const std::vector<int32_t>& column : series) {
+      memcpy(dst, column.data(), column.size() * sizeof(int32_t));
+      dst += column.size();
+    }
+  });
+  report("raw", values * sizeof(int32_t), raw_s);
+
+  int status = EXIT_SUCCESS;
+  for (codec::codec_t codec : {codec::CODEC_VARINT, codec::CODEC_BITPACK}) {
+    std::vector<codec::int_column_t> columns;
+    size_t bytes = 0;
+    for (const std::vector<int32_t>& column : series) {
+      columns.emplace_back(codec);
+      for (int32_t value : column) {
+        columns.back().append(value);
+      }
+      bytes += columns.back().bytes().size();
+    }
+
+    double decode_s = best_time(repeat, [&]() {
+      int32_t *dst = out.data();
+      for (const codec::int_column_t& column : columns) {
+        column.decode(dst);
+        dst += column.size();
+      }
+    });
+
+    //round trip
+    const int32_t *dst = out.data();
+    for (const std::vector<int32_t>& column : series) {
+      if (memcmp(dst, column.data(), column.size() * sizeof(int32_t)) != 0) {
+        std::cerr << "ERR: codec round trip differs" << std::endl;
+        status = EXIT_FAILURE;
+        break;
+      }
+      dst += column.size();
+    }
+
+    report((codec == codec::CODEC_VARINT) ? "varint" : "bitpack", bytes, decode_s);
+  }
+
+  return status;
+}
@@ -0,0 +1,63 @@
+"""Integer codec benchmark for the analysis transformer
+
+Runs analysis_transformer.o on a synthetic fixture with --packed for each
+--codec (varint, bitpack), with and without --quantize, and reports the end to
+end wall time and peak rss of each run, then runs codec_bench.o on the packed
+recognition output: encoded size and decode throughput of the timestep columns
+as raw int32, varint and bitpack
+"""
+import argparse
+import os
+import subprocess
+import sys
+
+import perf_check
+
+BENCH = os.path.join(perf_check.ANALYSIS_DIR, "codec_bench.o")
+CODECS = ["varint", "bitpack"]
+PACKED_RECOGNITION = "packed_recognition_output.bin"
+
+
+def log(msg):
+    sys.stderr.write("[codec_bench] %s\n" % msg)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--scale", default="medium",
+                        help="scale point to run (see perf_check.py)")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="timed repetitions (best time is used)")
+    parser.add_argument("--quantize", default="0.1",
+                        help="distance quantum (meters) of the compact runs")
+    args = parser.parse_args()
+
+    scales = {s[0]: s for s in perf_check.SCALES}
+    if args.scale not in scales:
+        log("unknown scale: %s" % args.scale)
+        return 1
+
+    #the last field holds the transformer arguments of the scale point
+    scale_args = scales[args.scale][-1]
+    bt_path, ns_path, net_path = perf_check.generate(*scales[args.scale][:-1])
+    out_dir = os.path.join(perf_check.FIXTURE_DIR, args.scale, "codecs")
+
+    for codec in CODECS:
+        for quantize in [None, args.quantize]:
+            extra = ["--packed", "--codec", codec]
+            if quantize:
+                extra += ["--quantize", quantize]
+
+            runs = [perf_check.run_transformer(bt_path, ns_path, net_path, out_dir, scale_args + extra)
+                    for _ in range(max(args.repeat, 1))]
+            wall = min(r[0] for r in runs)
+            rss = min(r[1] for r in runs)
+            log("%s%s: %.2fs end to end, peak rss %d KB" %
+                (codec, " --quantize %s" % quantize if quantize else "", wall, rss))
+
+    return subprocess.run([BENCH, "-r", str(args.repeat),
+                           os.path.join(out_dir, PACKED_RECOGNITION)]).returncode
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,151 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include <json.hpp>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <cstdlib>
+#include <unistd.h>
+
+typedef nlohmann::json json_t;
+
+//default timed repetitions (best time is reported)
+#define DEFAULT_REPEAT 3
+
+/*
+ * An output encoding
+ */
+struct format_t {
+  std::string name;
+  std::string extension;
+  std::function<std::string(const json_t&)> encode;
+  std::function<json_t(const std::string&)> decode;
+};
+
+static const std::vector<format_t> FORMATS = {
+  {"json", ".json",
+    [](const json_t& doc) { std::ostringstream out; out << doc << std::endl; return out.str(); },
+    [](const std::string& data) { return json_t::parse(data); }},
+  {"cbor", ".cbor",
+    [](const json_t& doc) { std::string out; json_t::to_cbor(doc, out); return out; },
+    [](const std::string& data) { return json_t::from_cbor(data); }},
+  {"msgpack", ".msgpack",
+    [](const json_t& doc) { std::string out; json_t::to_msgpack(doc, out); return out; },
+    [](const std::string& data) { return json_t::from_msgpack(data); }},
+};
+
+/**
+ * Read a file
+ * @param  path the path
+ * @param  data the contents
+ * @return      whether the file could be read
+ */
+static bool read_file(const std::string& path, std::string& data) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  std::ostringstream buff;
+  buff << in.rdbuf();
+  data = buff.str();
+  return true;
+}
+
+/**
+ * Best wall time of repeated runs
+ * @param  repeat the number of runs
+ * @param  fn     the function to time
+ * @return        seconds
+ */
+static double best_time(int repeat, const std::function<void()>& fn) {
+  double best = -1;
+  for (int i=0; i<repeat; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if ((best < 0) || (elapsed < best)) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+/**
+ * Benchmark the output encodings of json outputs: encode time, size and
+ * decode time (nlohmann as the reference decoder), and check that
+ * transformer outputs written with --format next to the json output decode
+ * to the same document
+ */
+int main(int argc, char **argv) {
+  int c;
+  int repeat = DEFAULT_REPEAT;
+
+  while ((c = getopt(argc, argv, "r:")) != -1) {
+    if (c == 'r') {
+      repeat = std::max(1, atoi(optarg));
+    } else {
+      std::cerr << "usage: " << argv[0] << " [-r repeat] <output.json>..." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (optind >= argc) {
+    std::cerr << "usage: " << argv[0] << " [-r repeat] <output.json>..." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int status = EXIT_SUCCESS;
+  std::cout << std::left << std::setw(32) << "output" << std::setw(10) << "format"
+            << std::right << std::setw(12) << "bytes" << std::setw(10) << "ratio"
+            << std::setw(12) << "encode s" << std::setw(12) << "decode s" << std::endl;
+
+  for (int i=optind; i<argc; i++) {
+    const std::string path = argv[i];
+    std::string text;
+    if (!read_file(path, text)) {
+      std::cerr << "ERR: failed to read: " << path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    const json_t doc = json_t::parse(text);
+    const std::string base = path.substr(0, path.size() - std::string(".json").size());
+    const std::string name = base.substr(base.find_last_of('/') + 1);
+
+    for (const format_t& format : FORMATS) {
+      std::string encoded;
+      json_t decoded;
+      double encode_s = best_time(repeat, [&]() { encoded = format.encode(doc); });
+      double decode_s = best_time(repeat, [&]() { decoded = format.decode(encoded); });
+
+      if (decoded != doc) {
+        std::cerr << "ERR: " << format.name << " round trip differs: " << path << std::endl;
+        status = EXIT_FAILURE;
+      }
+
+      //transformer output in this format (if written)
+      std::string written;
+      if ((format.name != "json") && read_file(base + format.extension, written)) {
+        if (format.decode(written) != doc) {
+          std::cerr << "ERR: " << base << format.extension << " differs from " << path << std::endl;
+          status = EXIT_FAILURE;
+        }
+      }
+
+      std::cout << std::left << std::setw(32) << name << std::setw(10) << format.name
+                << std::right << std::setw(12) << encoded.size()
+                << std::setw(10) << std::fixed << std::setprecision(3)
+                << ((double) encoded.size() / text.size())
+                << std::setw(12) << encode_s << std::setw(12) << decode_s
+                << std::defaultfloat << std::endl;
+    }
+  }
+
+  return status;
+}
@@ -0,0 +1,55 @@
+"""Output encoding benchmark for the analysis transformer
+
+Runs analysis_transformer.o on a synthetic fixture once per --format (json,
+cbor, msgpack) into one output directory, reports the end to end wall time and
+output sizes, then runs format_bench.o on the json outputs: encode time, size
+and decode time of each encoding, and a check that the cbor and msgpack outputs
+decode to the json output
+"""
+import argparse
+import os
+import subprocess
+import sys
+
+import perf_check
+
+BENCH = os.path.join(perf_check.ANALYSIS_DIR, "format_bench.o")
+FORMATS = [("json", ".json"), ("cbor", ".cbor"), ("msgpack", ".msgpack")]
+
+
+def log(msg):
+    sys.stderr.write("[format_bench] %s\n" % msg)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--scale", default="medium",
+                        help="scale point to run (see perf_check.py)")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="timed repetitions (best time is used)")
+    args = parser.parse_args()
+
+    scales = {s[0]: s for s in perf_check.SCALES}
+    if args.scale not in scales:
+        log("unknown scale: %s" % args.scale)
+        return 1
+
+    #the last field holds the transformer arguments of the scale point
+    scale_args = scales[args.scale][-1]
+    bt_path, ns_path, net_path = perf_check.generate(*scales[args.scale][:-1])
+    out_dir = os.path.join(perf_check.FIXTURE_DIR, args.scale, "formats")
+
+    for name, ext in FORMATS:
+        runs = [perf_check.run_transformer(bt_path, ns_path, net_path, out_dir, scale_args + ["--format", name])
+                for _ in range(max(args.repeat, 1))]
+        wall = min(r[0] for r in runs)
+        size = sum(os.path.getsize(os.path.join(out_dir, o[:-len(".json")] + ext))
+                   for o in perf_check.OUTPUTS)
+        log("%s: %.2fs end to end, %d bytes written" % (name, wall, size))
+
+    outputs = [os.path.join(out_dir, o) for o in perf_check.OUTPUTS]
+    return subprocess.run([BENCH, "-r", str(args.repeat)] + outputs).returncode
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,193 @@
+"""End to end performance regression check for the analysis transformer
+
+For each scale point, generates synthetic simulation outputs (output_generator.o),
+runs analysis_transformer.o on them and checks:
+  - the three json outputs are unchanged (canonicalised sha256 vs golden digests)
+  - wall time and peak rss are within a tolerance of the stored baseline
+"""
+import argparse
+import hashlib
+import json
+import os
+import resource
+import subprocess
+import sys
+import time
+
+PERF_DIR = os.path.dirname(os.path.abspath(__file__))
+ANALYSIS_DIR = os.path.dirname(PERF_DIR)
+REPO_DIR = os.path.dirname(ANALYSIS_DIR)
+
+TRANSFORMER = os.path.join(ANALYSIS_DIR, "analysis_transformer.o")
+GENERATOR = os.path.join(ANALYSIS_DIR, "output_generator.o")
+NET_PATH = os.path.join(REPO_DIR, "data", "grid", "grid.net.xml")
+FIXTURE_DIR = os.path.join(PERF_DIR, "fixtures")
+GOLDEN_DIR = os.path.join(PERF_DIR, "golden")
+BASELINE_PATH = os.path.join(PERF_DIR, "baseline.json")
+
+OUTPUTS = ["tower_output.json", "tower_coverage_output.json", "vehicle_history_output.json"]
+
+#name, vehicles, towers, duration (s), seed, lanes per edge, transformer arguments
+SCALES = [
+    ("small", 100, 81, 300, 1, 1, []),
+    #multi lane network (widened by the generator), lanes grouped by edge
+    ("edge_segments", 100, 81, 300, 4, 3, ["--edge-segments"]),
+    #more than 10 lanes per edge (lane ids don't sort by index)
+    ("edge_segments_wide", 100, 81, 300, 5, 12, ["--edge-segments"]),
+    ("medium", 300, 81, 600, 2, 1, []),
+    ("large", 600, 81, 900, 3, 1, []),
+]
+
+
+def log(msg):
+    sys.stderr.write("[perf_check] %s\n" % msg)
+
+
+def canonical_digest(path):
+    """Hash a json output with hash map ordered arrays sorted
+    (the order of towers and vehicles follows unordered_map iteration)"""
+    with open(path) as f:
+        obj = json.load(f)
+
+    for key, id_key in (("towers", "tower_id"), ("vehicles", "vehicle_id")):
+        arr = obj.get(key)
+        if isinstance(arr, list) and arr and isinstance(arr[0], dict) and id_key in arr[0]:
+            arr.sort(key=lambda e: e[id_key])
+
+    encoded = json.dumps(obj, sort_keys=True, separators=(",", ":")).encode()
+    return hashlib.sha256(encoded).hexdigest()
+
+
+def generate(name, vehicles, towers, duration, seed, lanes):
+    """Generate the fixture for a scale point (if not already generated),
+    with more than one lane per edge the generator also writes the widened network"""
+    out_dir = os.path.join(FIXTURE_DIR, name)
+    bt_path = os.path.join(out_dir, "synthetic.bt_output.xml")
+    ns_path = os.path.join(out_dir, "synthetic.ns_output.xml")
+    net_path = os.path.join(out_dir, "synthetic.net.xml") if lanes > 1 else NET_PATH
+    stamp_path = os.path.join(out_dir, "params")
+    params = "%d %d %d %d" % (vehicles, towers, duration, seed)
+    if lanes > 1:
+        params += " %d" % lanes
+
+    if os.path.exists(stamp_path) and open(stamp_path).read() == params:
+        return bt_path, ns_path, net_path
+
+    os.makedirs(out_dir, exist_ok=True)
+    log("generating %s (%s)" % (name, params))
+    subprocess.run([GENERATOR, "-n", NET_PATH, "-o", out_dir,
+                    "-v", str(vehicles), "-t", str(towers),
+                    "-d", str(duration), "-s", str(seed), "-l", str(lanes)],
+                   check=True, stderr=subprocess.DEVNULL)
+    with open(stamp_path, "w") as f:
+        f.write(params)
+    return bt_path, ns_path, net_path
+
+
+def run_transformer(bt_path, ns_path, net_path, out_dir, extra_args):
+    """Run the transformer once, return (wall seconds, peak rss kb)"""
+    os.makedirs(out_dir, exist_ok=True)
+    cmd = [TRANSFORMER, "-b", bt_path, "-r", ns_path, "-n", net_path, "-o", out_dir] + extra_args
+
+    #fork so that RUSAGE_CHILDREN only reflects this run
+    pid = os.fork()
+    if pid == 0:
+        devnull = os.open(os.devnull, os.O_WRONLY)
+        os.dup2(devnull, 2)
+        try:
+            os.execv(cmd[0], cmd)
+        finally:
+            os._exit(127)
+
+    start = time.monotonic()
+    _, status, usage = os.wait4(pid, 0)
+    wall = time.monotonic() - start
+
+    if os.waitstatus_to_exitcode(status) != 0:
+        raise RuntimeError("transformer failed: %s" % " ".join(cmd))
+    return wall, usage.ru_maxrss
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--update", action="store_true",
+                        help="record new golden digests and baseline instead of checking")
+    parser.add_argument("--tolerance", type=float,
+                        default=float(os.environ.get("PERF_TOLERANCE", "0.25")),
+                        help="allowed fractional regression in wall time and peak rss")
+    parser.add_argument("--repeat", type=int, default=int(os.environ.get("PERF_REPEAT", "1")),
+                        help="runs per scale point (best time is used)")
+    parser.add_argument("--scales", default="",
+                        help="comma separated subset of scale points to run")
+    parser.add_argument("transformer_args", nargs="*",
+                        help="extra arguments passed through to the transformer (after --)")
+    args = parser.parse_args()
+
+    selected = set(args.scales.split(",")) if args.scales else None
+    baseline = {}
+    if os.path.exists(BASELINE_PATH):
+        with open(BASELINE_PATH) as f:
+            baseline = json.load(f)
+
+    failures = []
+
+    for name, vehicles, towers, duration, seed, lanes, scale_args in SCALES:
+        if selected and name not in selected:
+            continue
+
+        bt_path, ns_path, net_path = generate(name, vehicles, towers, duration, seed, lanes)
+        out_dir = os.path.join(FIXTURE_DIR, name, "out")
+
+        runs = [run_transformer(bt_path, ns_path, net_path, out_dir, scale_args + args.transformer_args)
+                for _ in range(max(args.repeat, 1))]
+        wall = min(r[0] for r in runs)
+        rss = max(r[1] for r in runs)
+        digests = {o: canonical_digest(os.path.join(out_dir, o)) for o in OUTPUTS}
+        golden_path = os.path.join(GOLDEN_DIR, name + ".json")
+
+        log("%s: %.2fs, %d KB peak rss" % (name, wall, rss))
+
+        if args.update:
+            os.makedirs(GOLDEN_DIR, exist_ok=True)
+            with open(golden_path, "w") as f:
+                json.dump(digests, f, indent=2, sort_keys=True)
+                f.write("\n")
+            baseline[name] = {"wall_s": round(wall, 3), "peak_rss_kb": rss}
+            continue
+
+        #output equality
+        if not os.path.exists(golden_path):
+            failures.append("%s: no golden digests (run with --update)" % name)
+        else:
+            with open(golden_path) as f:
+                golden = json.load(f)
+            for o in OUTPUTS:
+                if golden.get(o) != digests[o]:
+                    failures.append("%s: %s differs from golden output" % (name, o))
+
+        #performance
+        base = baseline.get(name)
+        if base is None:
+            failures.append("%s: no baseline (run with --update)" % name)
+            continue
+        if wall > base["wall_s"] * (1 + args.tolerance):
+            failures.append("%s: wall time %.2fs exceeds baseline %.2fs" % (name, wall, base["wall_s"]))
+        if rss > base["peak_rss_kb"] * (1 + args.tolerance):
+            failures.append("%s: peak rss %d KB exceeds baseline %d KB" % (name, rss, base["peak_rss_kb"]))
+
+    if args.update:
+        with open(BASELINE_PATH, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        log("updated golden digests and baseline")
+        return 0
+
+    for failure in failures:
+        log("FAIL " + failure)
+    if not failures:
+        log("OK")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
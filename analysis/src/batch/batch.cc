@@ -0,0 +1,260 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "batch.h"
+#include "../types/arena.h"
+#include "../types/network.h"
+#include "../stats/perf_counters.h"
+#include "../stats/phase_stats.h"
+#include "../stream/gzip_source.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <cerrno>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//peak memory of a run relative to its largest input (xml dom, recognitions, json output)
+#define MEMORY_FACTOR 7
+
+namespace batch {
+  /**
+   * Get the size of a file
+   * @param  path the path
+   * @return      the size in bytes (0 if missing)
+   */
+  uint64_t file_size(const std::string& path) {
+    struct stat f_info;
+    if ((stat(path.c_str(), &f_info) != 0) || (f_info.st_mode & S_IFDIR)) {
+      return 0;
+    }
+    return f_info.st_size;
+  }
+
+  /**
+   * Get the size of an input once inflated (the file size unless gzip compressed)
+   * @param  path the path
+   * @return      the size in bytes (0 if missing)
+   */
+  uint64_t input_size(const std::string& path) {
+    uint64_t size = file_size(path);
+    uint64_t inflated;
+    if ((size > 0) && stream::inflated_size(path, inflated)) {
+      return inflated;
+    }
+    return size;
+  }
+
+  /**
+   * Load a batch manifest: one "<bt output> <netstate> <output dir>" per line
+   * ('#' comments, output directories are created if missing and must differ between lines)
+   * @param  path      the path to the manifest
+   * @param  scenarios the scenarios
+   * @return           success or failure
+   */
+  bool load_manifest(const std::string& path, std::vector<scenario_t>& scenarios) {
+    std::ifstream in_file(path);
+    if (!in_file) {
+      std::cerr << "ERR: unable to open batch manifest: " << path << std::endl;
+      return false;
+    }
+
+    std::string line;
+    size_t line_no = 0;
+    //the line of each output directory (resolved: concurrent scenarios must not share one)
+    std::unordered_map<std::string,size_t> output_lines;
+
+    while (std::getline(in_file, line)) {
+      line_no++;
+      line = line.substr(0, line.find('#'));
+
+      std::istringstream sstream(line);
+      scenario_t scenario;
+      if (!(sstream >> scenario.bt_output_path)) {
+        //blank
+        continue;
+      }
+
+      if (!(sstream >> scenario.raw_output_path >> scenario.output_path)) {
+        std::cerr << "ERR: " << path << ":" << line_no << ": expected <bt output> <netstate> <output dir>" << std::endl;
+        return false;
+      }
+
+      uint64_t bt_size = file_size(scenario.bt_output_path);
+      uint64_t raw_size = file_size(scenario.raw_output_path);
+
+      if ((bt_size == 0) || (raw_size == 0)) {
+        std::cerr << "ERR: " << path << ":" << line_no << ": missing or empty input file" << std::endl;
+        return false;
+      }
+
+      if ((mkdir(scenario.output_path.c_str(), 0755) != 0) && (errno != EEXIST)) {
+        std::cerr << "ERR: " << path << ":" << line_no << ": unable to create output directory: "
+                  << scenario.output_path << std::endl;
+        return false;
+      }
+
+      char *resolved = realpath(scenario.output_path.c_str(), NULL);
+      if (resolved == NULL) {
+        std::cerr << "ERR: " << path << ":" << line_no << ": unable to resolve output directory: "
+                  << scenario.output_path << std::endl;
+        return false;
+      }
+
+      std::pair<std::unordered_map<std::string,size_t>::iterator,bool> output_line
+        = output_lines.emplace(std::string(resolved), line_no);
+      free(resolved);
+
+      if (!output_line.second) {
+        std::cerr << "ERR: " << path << ":" << line_no << ": output directory already used on line "
+                  << output_line.first->second << ": " << scenario.output_path << std::endl;
+        return false;
+      }
+
+      //compressed xml inflates several times
+      scenario.memory_estimate = MEMORY_FACTOR * std::max(input_size(scenario.bt_output_path),
+                                                          input_size(scenario.raw_output_path));
+      scenarios.push_back(scenario);
+    }
+
+    if (scenarios.empty()) {
+      std::cerr << "ERR: no scenarios in batch manifest: " << path << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Process every scenario in a manifest against one network, parsed once and shared,
+   * on a bounded pool of workers that only start a scenario when its estimated memory
+   * fits in the budget (a scenario larger than the budget runs alone)
+   * @param  manifest_path  the path to the manifest
+   * @param  net_input_path the path to the sumo network input file
+   * @param  options        run options (batch jobs and memory budget)
+   * @return                success or failure (any scenario failed)
+   */
+  int process_batch(const std::string& manifest_path,
+                    const std::string& net_input_path,
+                    const process_options_t& options) {
+    std::vector<scenario_t> scenarios;
+    if (!load_manifest(manifest_path, scenarios)) {
+      return EXIT_FAILURE;
+    }
+
+    //counters are shared by all workers (opened once)
+    process_options_t scenario_options = options;
+    if (options.perf_counters) {
+      stats::perf_counters_open();
+      scenario_options.perf_counters = false;
+    }
+
+    //the network is parsed once and only read by the workers
+    types::arena_t network_arena;
+    types::network_t& network = network_arena.make<types::network_t>();
+    if (!load_network(net_input_path, network, options.trajectories || options.roi, options)) {
+      return EXIT_FAILURE;
+    }
+
+    //defaults: a worker per core, half of physical memory
+    unsigned jobs = options.batch_jobs ? options.batch_jobs : std::max(1u, std::thread::hardware_concurrency());
+    uint64_t budget = options.batch_memory_budget;
+    if (budget == 0) {
+      budget = (uint64_t) sysconf(_SC_PHYS_PAGES) * (uint64_t) sysconf(_SC_PAGE_SIZE) / 2;
+    }
+    jobs = std::min(jobs, (unsigned) scenarios.size());
+
+    std::cerr << "INFO: batch of " << scenarios.size() << " scenarios, " << network.edges.size() << " segments, "
+              << jobs << " workers, memory budget " << (budget >> 20) << " MB" << std::endl;
+
+    std::mutex lock;
+    std::condition_variable released;
+    //the next scenario to start (in manifest order)
+    size_t next = 0;
+    size_t running = 0;
+    uint64_t reserved = 0;
+    std::vector<int> status(scenarios.size(), EXIT_FAILURE);
+
+    //run scenarios until none are left
+    auto run_worker = [&] () {
+      while (true) {
+        size_t i;
+        {
+          //wait until the next scenario fits in the budget
+          std::unique_lock<std::mutex> guard(lock);
+          while ((next < scenarios.size()) &&
+                 (running > 0) &&
+                 (reserved + scenarios[next].memory_estimate > budget)) {
+            released.wait(guard);
+          }
+
+          if (next >= scenarios.size()) {
+            return;
+          }
+
+          i = next++;
+          running++;
+          reserved += scenarios[i].memory_estimate;
+        }
+
+        const scenario_t& scenario = scenarios[i];
+        std::cerr << "INFO: batch [" << (i + 1) << "/" << scenarios.size() << "] " << scenario.output_path
+                  << " (estimated " << (scenario.memory_estimate >> 20) << " MB)" << std::endl;
+
+        status[i] = process_output_data(scenario.bt_output_path,
+                                        net_input_path,
+                                        scenario.raw_output_path,
+                                        scenario.output_path,
+                                        scenario_options,
+                                        &network);
+
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          running--;
+          reserved -= scenario.memory_estimate;
+        }
+        released.notify_all();
+      }
+    };
+
+    if (jobs == 1) {
+      //a single worker runs on this thread and reports its own phases
+      run_worker();
+
+    } else {
+      //the allocator and perf counters are process wide: concurrent workers would report each
+      //other's phases, so only the whole batch is reported (perf counts include the workers once joined)
+      stats::phase_begin("batch scenarios");
+      stats::phase_elements(scenarios.size());
+
+      std::vector<std::thread> workers;
+      for (unsigned w=0; w<jobs; w++) {
+        workers.emplace_back([&] () {
+          stats::phase_stats_enable(false);
+          run_worker();
+        });
+      }
+
+      for (std::thread& worker : workers) {
+        worker.join();
+      }
+      stats::phase_end();
+    }
+
+    size_t failed = std::count_if(status.begin(), status.end(), [] (int stat) { return stat != EXIT_SUCCESS; });
+    for (size_t i=0; i<scenarios.size(); i++) {
+      if (status[i] != EXIT_SUCCESS) {
+        std::cerr << "ERR: batch scenario failed: " << scenarios[i].output_path << std::endl;
+      }
+    }
+
+    std::cerr << "INFO: batch complete, " << (scenarios.size() - failed) << "/" << scenarios.size() << " succeeded" << std::endl;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+}
@@ -0,0 +1,48 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "../process.h"
+
+namespace batch {
+  /*
+   * One simulation output to process
+   */
+  struct scenario_t {
+    std::string bt_output_path;
+    std::string raw_output_path;
+    std::string output_path;
+    //estimated peak memory to process (bytes)
+    uint64_t memory_estimate;
+  };
+
+  /**
+   * Load a batch manifest: one "<bt output> <netstate> <output dir>" per line
+   * ('#' comments, output directories are created if missing and must differ between lines)
+   * @param  path      the path to the manifest
+   * @param  scenarios the scenarios
+   * @return           success or failure
+   */
+  [[nodiscard]] bool load_manifest(const std::string& path, std::vector<scenario_t>& scenarios);
+
+  /**
+   * Process every scenario in a manifest against one network, parsed once and shared,
+   * on a bounded pool of workers that only start a scenario when its estimated memory
+   * fits in the budget (a scenario larger than the budget runs alone)
+   * @param  manifest_path  the path to the manifest
+   * @param  net_input_path the path to the sumo network input file
+   * @param  options        run options (batch jobs and memory budget)
+   * @return                success or failure (any scenario failed)
+   */
+  int process_batch(const std::string& manifest_path,
+                    const std::string& net_input_path,
+                    const process_options_t& options);
+}
+
+#endif /*_BATCH_H*/
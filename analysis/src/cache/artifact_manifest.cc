@@ -0,0 +1,164 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "artifact_manifest.h"
+#include "content_hash.h"
+#include "../output/render_output.h"
+#include <fstream>
+#include <iostream>
+#include <exception>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace cache {
+
+  typedef nlohmann::json json_t;
+
+  #define MANIFEST_VERSION 1
+
+  #define VERSION_KEY "version"
+  #define INPUTS_KEY  "inputs"
+  #define STAGES_KEY  "stages"
+  #define PATH_KEY    "path"
+  #define HASH_KEY    "hash"
+  #define OUTPUTS_KEY "outputs"
+
+  /**
+   * Constructor: load the manifest of the last run in the output directory
+   * @param out_dir_path the output directory
+   */
+  artifact_manifest_t::artifact_manifest_t(const std::string& out_dir_path)
+    : out_dir_path(out_dir_path), previous(nullptr), current(json_t::object()) {
+    this->current[VERSION_KEY] = MANIFEST_VERSION;
+    this->current[INPUTS_KEY] = json_t::object();
+    this->current[STAGES_KEY] = json_t::object();
+
+    std::ifstream in_file(output::join(out_dir_path, ARTIFACT_MANIFEST_FILENAME));
+    if (!in_file) {
+      //first run
+      return;
+    }
+
+    try {
+      json_t last = json_t::parse(in_file);
+      if (last.is_object() && (last.value(VERSION_KEY, 0) == MANIFEST_VERSION) &&
+          last[INPUTS_KEY].is_object() && last[STAGES_KEY].is_object()) {
+        this->previous = last;
+      }
+
+    } catch (const std::exception& e) {
+      std::cerr << "WARN: ignoring invalid artifact manifest: " << e.what() << std::endl;
+    }
+  }
+
+  /**
+   * Record an input file or derived input
+   * @param name the input name
+   * @param path the path (empty for derived inputs)
+   * @param hash the content hash
+   */
+  void artifact_manifest_t::set_input(const std::string& name, const std::string& path, uint64_t hash) {
+    json_t input = json_t::object();
+    if (!path.empty()) {
+      input[PATH_KEY] = path;
+    }
+    input[HASH_KEY] = hash_hex(hash);
+    this->current[INPUTS_KEY][name] = input;
+  }
+
+  /**
+   * Get the hash of an input in the last run
+   * @param  name the input name
+   * @param  hash the hash
+   * @return      whether the last run recorded the input
+   */
+  bool artifact_manifest_t::previous_input(const std::string& name, uint64_t& hash) const {
+    if (this->previous.is_null() || !this->previous[INPUTS_KEY].contains(name)) {
+      return false;
+    }
+
+    const json_t& input = this->previous[INPUTS_KEY][name];
+    if (!input.contains(HASH_KEY) || !input[HASH_KEY].is_string()) {
+      return false;
+    }
+    hash = strtoull(input[HASH_KEY].get<std::string>().c_str(), NULL, 16);
+    return true;
+  }
+
+  /**
+   * Check whether a stage of the last run had the same inputs and all of its outputs still exist
+   * @param  stage  the stage name
+   * @param  inputs the inputs of the stage in this run
+   * @return        whether the stage can be skipped
+   */
+  bool artifact_manifest_t::is_fresh(const std::string& stage, const json_t& inputs) const {
+    if (this->previous.is_null() || !this->previous[STAGES_KEY].contains(stage)) {
+      return false;
+    }
+
+    const json_t& last = this->previous[STAGES_KEY][stage];
+    if (!last.contains(INPUTS_KEY) || (last[INPUTS_KEY] != inputs) ||
+        !last.contains(OUTPUTS_KEY) || !last[OUTPUTS_KEY].is_array()) {
+      return false;
+    }
+
+    for (const json_t& output : last[OUTPUTS_KEY]) {
+      struct stat f_info;
+      if (!output.is_string() ||
+          (stat(output::join(this->out_dir_path, output.get<std::string>()).c_str(), &f_info) != 0)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Record the inputs and outputs of a stage of this run
+   * @param stage   the stage name
+   * @param inputs  the inputs of the stage
+   * @param outputs the output files (relative to the output directory)
+   */
+  void artifact_manifest_t::record(const std::string& stage, const json_t& inputs, const std::vector<std::string>& outputs) {
+    json_t entry = json_t::object();
+    entry[INPUTS_KEY] = inputs;
+    entry[OUTPUTS_KEY] = outputs;
+    this->current[STAGES_KEY][stage] = entry;
+  }
+
+  /**
+   * Remove the manifest from the output directory (before outputs are rewritten,
+   * so a failed run never leaves a manifest describing outputs it replaced)
+   */
+  void artifact_manifest_t::invalidate() const {
+    remove(this->out_dir_path);
+  }
+
+  /**
+   * Remove the manifest from an output directory (runs that rewrite outputs without
+   * recording a manifest, so a later incremental run can't skip stages against it)
+   * @param out_dir_path the output directory
+   */
+  void artifact_manifest_t::remove(const std::string& out_dir_path) {
+    unlink(output::join(out_dir_path, ARTIFACT_MANIFEST_FILENAME).c_str());
+  }
+
+  /**
+   * Write the manifest of this run
+   * @return the status
+   */
+  int artifact_manifest_t::write() const {
+    std::string full_path = output::join(this->out_dir_path, ARTIFACT_MANIFEST_FILENAME);
+    std::ofstream out_file(full_path);
+
+    if (!out_file) {
+      std::cerr << "ERR: failed to open artifact manifest: " << full_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    out_file << this->current.dump(2) << std::endl;
+    std::cerr << "INFO: wrote artifact manifest to: " << full_path << std::endl;
+    return EXIT_SUCCESS;
+  }
+}
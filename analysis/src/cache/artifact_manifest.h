@@ -0,0 +1,90 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _ARTIFACT_MANIFEST_H
+#define _ARTIFACT_MANIFEST_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <json.hpp>
+
+namespace cache {
+
+  #define ARTIFACT_MANIFEST_FILENAME "analysis_manifest.json"
+
+  /*
+   * Records the inputs (content hashes, options) behind each output stage of a run
+   * so a later run into the same directory can skip stages that are up to date
+   * @see docs/output.md
+   */
+  struct artifact_manifest_t {
+  private:
+    std::string out_dir_path;
+    //the manifest of the last complete run (null if none)
+    nlohmann::json previous;
+    //the manifest of this run
+    nlohmann::json current;
+
+  public:
+    /**
+     * Constructor: load the manifest of the last run in the output directory
+     * @param out_dir_path the output directory
+     */
+    artifact_manifest_t(const std::string& out_dir_path);
+
+    /**
+     * Record an input file or derived input
+     * @param name the input name
+     * @param path the path (empty for derived inputs)
+     * @param hash the content hash
+     */
+    void set_input(const std::string& name, const std::string& path, uint64_t hash);
+
+    /**
+     * Get the hash of an input in the last run
+     * @param  name the input name
+     * @param  hash the hash
+     * @return      whether the last run recorded the input
+     */
+    bool previous_input(const std::string& name, uint64_t& hash) const;
+
+    /**
+     * Check whether a stage of the last run had the same inputs and all of its outputs still exist
+     * @param  stage  the stage name
+     * @param  inputs the inputs of the stage in this run
+     * @return        whether the stage can be skipped
+     */
+    bool is_fresh(const std::string& stage, const nlohmann::json& inputs) const;
+
+    /**
+     * Record the inputs and outputs of a stage of this run
+     * @param stage   the stage name
+     * @param inputs  the inputs of the stage
+     * @param outputs the output files (relative to the output directory)
+     */
+    void record(const std::string& stage, const nlohmann::json& inputs, const std::vector<std::string>& outputs);
+
+    /**
+     * Remove the manifest from the output directory (before outputs are rewritten,
+     * so a failed run never leaves a manifest describing outputs it replaced)
+     */
+    void invalidate() const;
+
+    /**
+     * Remove the manifest from an output directory (runs that rewrite outputs without
+     * recording a manifest, so a later incremental run can't skip stages against it)
+     * @param out_dir_path the output directory
+     */
+    static void remove(const std::string& out_dir_path);
+
+    /**
+     * Write the manifest of this run
+     * @return the status
+     */
+    int write() const;
+  };
+}
+
+#endif /*_ARTIFACT_MANIFEST_H*/
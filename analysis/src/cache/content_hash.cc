@@ -0,0 +1,55 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "content_hash.h"
+#include <iostream>
+#include <vector>
+#include <stdio.h>
+
+namespace cache {
+
+  //bytes read per call
+  #define HASH_CHUNK (1 << 20)
+
+  /**
+   * Hash the contents of a file
+   * @param  path the path to the file
+   * @param  hash the content hash
+   * @return      success or failure
+   */
+  bool hash_file(const std::string& path, uint64_t& hash) {
+    FILE *file_p = fopen(path.c_str(), "rb");
+    if (file_p == NULL) {
+      std::cerr << "ERR: unable to open file for hashing: " << path << std::endl;
+      return false;
+    }
+
+    std::vector<char> buff(HASH_CHUNK);
+    size_t n;
+    hash = FNV_OFFSET;
+
+    while ((n = fread(buff.data(), 1, buff.size(), file_p)) > 0) {
+      hash = fnv1a(buff.data(), n, hash);
+    }
+
+    bool success = !ferror(file_p);
+    fclose(file_p);
+
+    if (!success) {
+      std::cerr << "ERR: failed to read file for hashing: " << path << std::endl;
+    }
+    return success;
+  }
+
+  /**
+   * Format a hash as 16 hex digits
+   * @param  hash the hash
+   * @return      the hex string
+   */
+  std::string hash_hex(uint64_t hash) {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) hash);
+    return std::string(hex);
+  }
+}
@@ -0,0 +1,49 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _CONTENT_HASH_H
+#define _CONTENT_HASH_H
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace cache {
+
+  //64 bit FNV-1a parameters
+  #define FNV_OFFSET 0xcbf29ce484222325ULL
+  #define FNV_PRIME  0x100000001b3ULL
+
+  /**
+   * Hash bytes with 64 bit FNV-1a (stable across runs and machines)
+   * @param  data the bytes
+   * @param  size the number of bytes
+   * @param  hash the hash to continue from
+   * @return      the hash
+   */
+  inline uint64_t fnv1a(const void *data, size_t size, uint64_t hash = FNV_OFFSET) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (size_t i=0; i<size; i++) {
+      hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+  }
+
+  /**
+   * Hash the contents of a file
+   * @param  path the path to the file
+   * @param  hash the content hash
+   * @return      success or failure
+   */
+  [[nodiscard]] bool hash_file(const std::string& path, uint64_t& hash);
+
+  /**
+   * Format a hash as 16 hex digits
+   * @param  hash the hash
+   * @return      the hex string
+   */
+  std::string hash_hex(uint64_t hash);
+}
+
+#endif /*_CONTENT_HASH_H*/
@@ -0,0 +1,240 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "net_cache.h"
+#include "content_hash.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <string_view>
+#include <cstring>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace cache {
+
+  #define NET_CACHE_MAGIC  "SMNETC01"
+  #define NET_CACHE_SUFFIX ".netcache"
+
+  static_assert(sizeof(net_cache_header_t) == 40, "net cache header layout");
+  static_assert(sizeof(net_cache_lane_t) == 24, "net cache lane layout");
+
+  /**
+   * Get the cache path for a network
+   * @param  net_input_path the path to the sumo network file
+   * @param  cache_dir      the cache directory (empty: next to the network file)
+   * @param  content_hash   the content hash of the network file
+   * @return                the cache path
+   */
+  std::string net_cache_path(const std::string& net_input_path,
+                             const std::string& cache_dir,
+                             uint64_t content_hash) {
+    size_t slash = net_input_path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "." : net_input_path.substr(0, slash);
+    std::string name = (slash == std::string::npos) ? net_input_path : net_input_path.substr(slash + 1);
+
+    if (!cache_dir.empty()) {
+      dir = cache_dir;
+    }
+    return dir + "/" + name + "." + hash_hex(content_hash) + NET_CACHE_SUFFIX;
+  }
+
+  /**
+   * Append the lanes of a shape map to the cache sections (in id order)
+   * @param shapes   the lane shapes
+   * @param lanes    lane records
+   * @param vertices vertex coordinates
+   * @param ids      lane id bytes
+   */
+  void append_lanes(const types::road_edge_map_t& shapes,
+                    std::vector<net_cache_lane_t>& lanes,
+                    std::vector<double>& vertices,
+                    std::string& ids) {
+    std::vector<types::road_edge_map_t::const_iterator> sorted;
+    sorted.reserve(shapes.size());
+    for (types::road_edge_map_t::const_iterator it = shapes.begin(); it != shapes.end(); it++) {
+      sorted.push_back(it);
+    }
+    std::sort(sorted.begin(), sorted.end(), [] (const auto& a, const auto& b) { return a->first < b->first; });
+
+    for (const types::road_edge_map_t::const_iterator& it : sorted) {
+      net_cache_lane_t lane;
+      lane.length = it->second.get_length();
+      lane.id_offset = (uint32_t) ids.size();
+      lane.id_size = (uint32_t) it->first.size();
+      lane.first_vertex = (uint32_t) (vertices.size() / 2);
+      lane.vertex_count = (uint32_t) it->second.get_vertices().size();
+
+      ids.append(it->first.data(), it->first.size());
+      for (const std::pair<double,double>& v : it->second.get_vertices()) {
+        vertices.push_back(v.first);
+        vertices.push_back(v.second);
+      }
+      lanes.push_back(lane);
+    }
+  }
+
+  /**
+   * Write a network (including internal lanes) to a cache file
+   * @param  path         the cache path (written atomically)
+   * @param  content_hash the content hash of the network file
+   * @param  network      the network
+   * @return              success or failure
+   */
+  bool write_net_cache(const std::string& path,
+                       uint64_t content_hash,
+                       const types::network_t& network) {
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "net cache is little endian");
+
+    std::vector<net_cache_lane_t> lanes;
+    std::vector<double> vertices;
+    std::string ids;
+
+    append_lanes(network.edge_shapes, lanes, vertices, ids);
+    size_t lane_count = lanes.size();
+    append_lanes(network.internal_shapes, lanes, vertices, ids);
+
+    net_cache_header_t header;
+    memcpy(header.magic, NET_CACHE_MAGIC, sizeof(header.magic));
+    header.content_hash = content_hash;
+    header.lane_count = (uint32_t) lane_count;
+    header.internal_count = (uint32_t) (lanes.size() - lane_count);
+    header.vertex_count = vertices.size() / 2;
+    header.id_bytes = ids.size();
+
+    //readers never see a partial file
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    {
+      std::ofstream out_file(tmp_path, std::ios::binary);
+      if (!out_file) {
+        std::cerr << "WARN: unable to write network cache: " << tmp_path << std::endl;
+        return false;
+      }
+
+      out_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out_file.write(reinterpret_cast<const char*>(lanes.data()), lanes.size() * sizeof(net_cache_lane_t));
+      out_file.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(double));
+      out_file.write(ids.data(), ids.size());
+
+      if (!out_file) {
+        std::cerr << "WARN: failed to write network cache: " << tmp_path << std::endl;
+        unlink(tmp_path.c_str());
+        return false;
+      }
+    }
+
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+      std::cerr << "WARN: unable to write network cache: " << path << std::endl;
+      unlink(tmp_path.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Add cached lanes to a shape map (and segment ids)
+   * @param lanes    lane records
+   * @param count    the number of records
+   * @param vertices vertex coordinates
+   * @param ids      lane id bytes
+   * @param shapes   the lane shapes
+   * @param edges    segment ids (null for internal lanes)
+   */
+  void add_lanes(const net_cache_lane_t *lanes,
+                 size_t count,
+                 const double *vertices,
+                 const char *ids,
+                 types::road_edge_map_t& shapes,
+                 types::id_set_t *edges) {
+    shapes.reserve(shapes.size() + count);
+
+    for (size_t i=0; i<count; i++) {
+      std::pmr::string lane_id(ids + lanes[i].id_offset, lanes[i].id_size);
+      if (edges != nullptr) {
+        edges->insert(lane_id);
+      }
+
+      //constructed in the map's arena
+      types::road_edge_t& edge = shapes.try_emplace(lane_id).first->second;
+      edge.set_length(lanes[i].length);
+
+      const double *v = vertices + 2 * (size_t) lanes[i].first_vertex;
+      for (uint32_t j=0; j<lanes[i].vertex_count; j++) {
+        edge.add_vertex(v[2 * j], v[2 * j + 1]);
+      }
+    }
+  }
+
+  /**
+   * Load a network from a cache file
+   * @param  path           the cache path
+   * @param  content_hash   the expected content hash
+   * @param  network        the network to load into
+   * @param  internal_lanes whether to load internal (junction) lane shapes
+   * @return                whether the cache exists and is valid
+   */
+  bool load_net_cache(const std::string& path,
+                      uint64_t content_hash,
+                      types::network_t& network,
+                      bool internal_lanes) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      //not cached yet
+      return false;
+    }
+
+    struct stat f_info;
+    if ((fstat(fd, &f_info) != 0) || ((size_t) f_info.st_size < sizeof(net_cache_header_t))) {
+      close(fd);
+      std::cerr << "WARN: ignoring truncated network cache: " << path << std::endl;
+      return false;
+    }
+
+    size_t size = f_info.st_size;
+    void *mem = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+      std::cerr << "WARN: unable to map network cache: " << path << std::endl;
+      return false;
+    }
+
+    const char *base = static_cast<const char*>(mem);
+    const net_cache_header_t *header = reinterpret_cast<const net_cache_header_t*>(base);
+
+    //section bounds
+    size_t lane_total = (size_t) header->lane_count + header->internal_count;
+    size_t lanes_at = sizeof(net_cache_header_t);
+    size_t vertices_at = lanes_at + lane_total * sizeof(net_cache_lane_t);
+    size_t ids_at = vertices_at + header->vertex_count * 2 * sizeof(double);
+
+    bool valid = (memcmp(header->magic, NET_CACHE_MAGIC, sizeof(header->magic)) == 0) &&
+                 (header->content_hash == content_hash) &&
+                 (ids_at + header->id_bytes == size);
+
+    const net_cache_lane_t *lanes = reinterpret_cast<const net_cache_lane_t*>(base + lanes_at);
+    for (size_t i=0; valid && (i<lane_total); i++) {
+      valid = ((uint64_t) lanes[i].id_offset + lanes[i].id_size <= header->id_bytes) &&
+              ((uint64_t) lanes[i].first_vertex + lanes[i].vertex_count <= header->vertex_count);
+    }
+
+    if (valid) {
+      const double *vertices = reinterpret_cast<const double*>(base + vertices_at);
+      const char *ids = base + ids_at;
+
+      add_lanes(lanes, header->lane_count, vertices, ids, network.edge_shapes, &network.edges);
+      if (internal_lanes) {
+        add_lanes(lanes + header->lane_count, header->internal_count, vertices, ids, network.internal_shapes, nullptr);
+      }
+    } else {
+      std::cerr << "WARN: ignoring invalid network cache: " << path << std::endl;
+    }
+
+    munmap(mem, size);
+    return valid;
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _NET_CACHE_H
+#define _NET_CACHE_H
+
+#include <string>
+#include <stdint.h>
+#include "../types/network.h"
+
+namespace cache {
+  /*
+   * Parsed network cache file (little endian, sections 8 byte aligned so the
+   * file can be mapped and read in place):
+   *   header
+   *   lane records (segments in id order, then internal lanes in id order)
+   *   vertices (x, y doubles, contiguous per lane)
+   *   lane id bytes
+   * The file name carries the content hash of the net file, so an edited
+   * network never matches an old cache
+   */
+  struct net_cache_header_t {
+    char magic[8];
+    uint64_t content_hash;
+    uint32_t lane_count;
+    uint32_t internal_count;
+    uint64_t vertex_count;
+    uint64_t id_bytes;
+  };
+
+  struct net_cache_lane_t {
+    //lane length (-1 if not set)
+    double length;
+    uint32_t id_offset;
+    uint32_t id_size;
+    uint32_t first_vertex;
+    uint32_t vertex_count;
+  };
+
+  /**
+   * Get the cache path for a network
+   * @param  net_input_path the path to the sumo network file
+   * @param  cache_dir      the cache directory (empty: next to the network file)
+   * @param  content_hash   the content hash of the network file
+   * @return                the cache path
+   */
+  std::string net_cache_path(const std::string& net_input_path,
+                             const std::string& cache_dir,
+                             uint64_t content_hash);
+
+  /**
+   * Write a network (including internal lanes) to a cache file
+   * @param  path         the cache path (written atomically)
+   * @param  content_hash the content hash of the network file
+   * @param  network      the network
+   * @return              success or failure
+   */
+  [[nodiscard]] bool write_net_cache(const std::string& path,
+                                     uint64_t content_hash,
+                                     const types::network_t& network);
+
+  /**
+   * Load a network from a cache file
+   * @param  path           the cache path
+   * @param  content_hash   the expected content hash
+   * @param  network        the network to load into
+   * @param  internal_lanes whether to load internal (junction) lane shapes
+   * @return                whether the cache exists and is valid
+   */
+  [[nodiscard]] bool load_net_cache(const std::string& path,
+                                    uint64_t content_hash,
+                                    types::network_t& network,
+                                    bool internal_lanes);
+}
+
+#endif /*_NET_CACHE_H*/
@@ -0,0 +1,291 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "int_codec.h"
+#include <cmath>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace codec {
+
+  //32 bit lanes in a packed word
+  #define BITPACK_LANES 4
+  //values in each lane of a block
+  #define BITPACK_LANE_VALUES (BITPACK_BLOCK / BITPACK_LANES)
+
+  /**
+   * Parse a codec name (varint or bitpack)
+   * @param  name  the name
+   * @param  codec the parsed codec
+   * @return       whether the name is a supported codec
+   */
+  bool parse_codec(const std::string& name, codec_t& codec) {
+    if (name == "varint") {
+      codec = CODEC_VARINT;
+    } else if (name == "bitpack") {
+      codec = CODEC_BITPACK;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Append a varint
+   * @param out   the destination
+   * @param value the value
+   */
+  inline void put_varint(std::pmr::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+      out.push_back((uint8_t) (value | 0x80));
+      value >>= 7;
+    }
+    out.push_back((uint8_t) value);
+  }
+
+  /**
+   * Read a varint
+   * @param  in    the source
+   * @param  value the value
+   * @return       the byte after the varint
+   */
+  inline const uint8_t *get_varint(const uint8_t *in, uint32_t& value) {
+    value = 0;
+    for (unsigned shift=0; ; shift+=7) {
+      uint8_t byte = *in++;
+      value |= (uint32_t) (byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return in;
+      }
+    }
+  }
+
+  /**
+   * Get the bit width of the widest value in a block
+   * @param  in the block (BITPACK_BLOCK values)
+   * @return    the bit width (0 to 32)
+   */
+  unsigned block_bits(const uint32_t *in) {
+    uint32_t all = 0;
+    for (size_t i=0; i<BITPACK_BLOCK; i++) {
+      all |= in[i];
+    }
+    return all ? 32 - __builtin_clz(all) : 0;
+  }
+
+#ifdef __SSE2__
+  /**
+   * Pack a block of values
+   * @param in   the block (BITPACK_BLOCK values, all less than 2^bits)
+   * @param bits the bit width
+   * @param out  the packed block (bits * 16 bytes)
+   */
+  void pack_block(const uint32_t *in, unsigned bits, uint8_t *out) {
+    __m128i *dst = reinterpret_cast<__m128i*>(out);
+    __m128i word = _mm_setzero_si128();
+    unsigned shift = 0;
+
+    //value i of every lane goes to the same bit offset of its lane
+    for (size_t i=0; (i<BITPACK_LANE_VALUES) && bits; i++) {
+      __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in) + i);
+      word = _mm_or_si128(word, _mm_sll_epi32(value, _mm_cvtsi32_si128(shift)));
+      shift += bits;
+
+      if (shift >= 32) {
+        _mm_storeu_si128(dst++, word);
+        shift -= 32;
+        //the bits that did not fit (shift by 32 clears the word)
+        word = _mm_srl_epi32(value, _mm_cvtsi32_si128(bits - shift));
+      }
+    }
+  }
+
+  /**
+   * Unpack a block of values
+   * @param in   the packed block (bits * 16 bytes)
+   * @param bits the bit width
+   * @param out  the block (BITPACK_BLOCK values)
+   */
+  void unpack_block(const uint8_t *in, unsigned bits, uint32_t *out) {
+    __m128i *dst = reinterpret_cast<__m128i*>(out);
+    if (!bits) {
+      memset(out, 0, BITPACK_BLOCK * sizeof(uint32_t));
+      return;
+    }
+
+    const __m128i *src = reinterpret_cast<const __m128i*>(in);
+    const __m128i mask = _mm_set1_epi32((bits == 32) ? -1 : (int) ((1u << bits) - 1));
+    __m128i word = _mm_loadu_si128(src++);
+    unsigned shift = 0;
+    unsigned words = 1;
+
+    for (size_t i=0; i<BITPACK_LANE_VALUES; i++) {
+      __m128i value = _mm_srl_epi32(word, _mm_cvtsi32_si128(shift));
+      shift += bits;
+
+      if ((shift >= 32) && (words < bits)) {
+        word = _mm_loadu_si128(src++);
+        words++;
+        shift -= 32;
+        //the high bits of a value split across words
+        if (shift) {
+          value = _mm_or_si128(value, _mm_sll_epi32(word, _mm_cvtsi32_si128(bits - shift)));
+        }
+      }
+      _mm_storeu_si128(dst++, _mm_and_si128(value, mask));
+    }
+  }
+#else
+  /**
+   * Pack a block of values
+   * @param in   the block (BITPACK_BLOCK values, all less than 2^bits)
+   * @param bits the bit width
+   * @param out  the packed block (bits * 16 bytes)
+   */
+  void pack_block(const uint32_t *in, unsigned bits, uint8_t *out) {
+    for (size_t lane=0; lane<BITPACK_LANES; lane++) {
+      uint64_t word = 0;
+      unsigned shift = 0;
+      size_t w = 0;
+
+      for (size_t i=0; (i<BITPACK_LANE_VALUES) && bits; i++) {
+        word |= (uint64_t) in[i * BITPACK_LANES + lane] << shift;
+        shift += bits;
+
+        if (shift >= 32) {
+          uint32_t packed = (uint32_t) word;
+          memcpy(out + (w++ * BITPACK_LANES + lane) * sizeof(uint32_t), &packed, sizeof(uint32_t));
+          word >>= 32;
+          shift -= 32;
+        }
+      }
+    }
+  }
+
+  /**
+   * Unpack a block of values
+   * @param in   the packed block (bits * 16 bytes)
+   * @param bits the bit width
+   * @param out  the block (BITPACK_BLOCK values)
+   */
+  void unpack_block(const uint8_t *in, unsigned bits, uint32_t *out) {
+    const uint64_t mask = (bits == 32) ? 0xffffffffu : ((1u << bits) - 1);
+
+    for (size_t lane=0; lane<BITPACK_LANES; lane++) {
+      uint64_t word = 0;
+      unsigned available = 0;
+      size_t w = 0;
+
+      for (size_t i=0; i<BITPACK_LANE_VALUES; i++) {
+        if (available < bits) {
+          uint32_t packed;
+          memcpy(&packed, in + (w++ * BITPACK_LANES + lane) * sizeof(uint32_t), sizeof(uint32_t));
+          word |= (uint64_t) packed << available;
+          available += 32;
+        }
+        out[i * BITPACK_LANES + lane] = (uint32_t) (word & mask);
+        word >>= bits;
+        available -= bits;
+      }
+    }
+  }
+#endif
+
+  /**
+   * Constructor
+   * @param codec the codec
+   * @param alloc the allocator for the encoded data
+   */
+  int_column_t::int_column_t(codec_t codec, const allocator_type& alloc)
+    : data(alloc),
+      tail_offset(0),
+      count(0),
+      last(0),
+      codec(codec) {}
+
+  /**
+   * Append a value
+   * @param value the value
+   */
+  void int_column_t::append(int32_t value) {
+    put_varint(this->data, zigzag(value - this->last));
+    this->last = value;
+    this->count++;
+
+    //repack a full tail as a block (bit width byte, packed deltas)
+    if ((this->codec == CODEC_BITPACK) && ((this->count % BITPACK_BLOCK) == 0)) {
+      uint32_t deltas[BITPACK_BLOCK];
+      const uint8_t *in = this->data.data() + this->tail_offset;
+      for (size_t i=0; i<BITPACK_BLOCK; i++) {
+        in = get_varint(in, deltas[i]);
+      }
+
+      unsigned bits = block_bits(deltas);
+      this->data.resize(this->tail_offset + 1 + bits * BITPACK_BLOCK / 8);
+      this->data[this->tail_offset] = (uint8_t) bits;
+      pack_block(deltas, bits, this->data.data() + this->tail_offset + 1);
+      this->tail_offset = this->data.size();
+    }
+  }
+
+  /**
+   * Decode an encoded column
+   * @param  in    the encoded column
+   * @param  count the number of values
+   * @param  codec the codec
+   * @param  out   the values (count values are written)
+   * @return       the byte after the column
+   */
+  const uint8_t *decode_column(const uint8_t *in, size_t count, codec_t codec, int32_t *out) {
+    int32_t value = 0;
+    size_t i = 0;
+
+    if (codec == CODEC_BITPACK) {
+      uint32_t deltas[BITPACK_BLOCK];
+      for (; i + BITPACK_BLOCK <= count; i+=BITPACK_BLOCK) {
+        unsigned bits = *in++;
+        unpack_block(in, bits, deltas);
+        in += bits * BITPACK_BLOCK / 8;
+
+        for (size_t j=0; j<BITPACK_BLOCK; j++) {
+          value += unzigzag(deltas[j]);
+          out[i + j] = value;
+        }
+      }
+    }
+
+    //varint tail
+    for (; i<count; i++) {
+      uint32_t delta;
+      in = get_varint(in, delta);
+      value += unzigzag(delta);
+      out[i] = value;
+    }
+    return in;
+  }
+
+  /**
+   * Decode the column
+   * @param out the values (size() values are written)
+   */
+  void int_column_t::decode(int32_t *out) const {
+    decode_column(this->data.data(), this->count, this->codec, out);
+  }
+
+  /**
+   * Quantize a non negative value to fixed point (saturating)
+   * @param  value the value
+   * @param  scale fixed point units per unit of value (e.g. 10 for decimetres)
+   * @return       the fixed point value
+   */
+  uint16_t quantize(double value, double scale) {
+    double fixed = std::round(value * scale);
+    if (!(fixed > 0)) {
+      return 0;
+    }
+    return (fixed >= UINT16_MAX) ? UINT16_MAX : (uint16_t) fixed;
+  }
+}
@@ -0,0 +1,174 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _INT_CODEC_H
+#define _INT_CODEC_H
+
+#include <string>
+#include <memory_resource>
+#include <vector>
+#include <stdint.h>
+
+namespace codec {
+
+  //values in a bit packed block
+  #define BITPACK_BLOCK 128
+
+  /*
+   * Integer column codecs (both delta encode the column first)
+   */
+  enum codec_t {
+    //zigzag delta, LEB128 varint per value
+    CODEC_VARINT  = 0,
+    //zigzag delta, blocks of 128 values bit packed at the block's widest delta
+    //(4 interleaved 32 bit lanes, packed and unpacked with SSE2)
+    CODEC_BITPACK = 1
+  };
+
+  /**
+   * Parse a codec name (varint or bitpack)
+   * @param  name  the name
+   * @param  codec the parsed codec
+   * @return       whether the name is a supported codec
+   */
+  [[nodiscard]] bool parse_codec(const std::string& name, codec_t& codec);
+
+  /**
+   * Map a signed delta to an unsigned value (small magnitudes stay small)
+   * @param  value the value
+   * @return       the zigzag value
+   */
+  inline uint32_t zigzag(int32_t value) {
+    return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+  }
+
+  /**
+   * Reverse zigzag
+   * @param  value the zigzag value
+   * @return       the value
+   */
+  inline int32_t unzigzag(uint32_t value) {
+    return (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+  }
+
+  /**
+   * Get the bit width of the widest value in a block
+   * @param  in the block (BITPACK_BLOCK values)
+   * @return    the bit width (0 to 32)
+   */
+  unsigned block_bits(const uint32_t *in);
+
+  /**
+   * Pack a block of values
+   * @param in   the block (BITPACK_BLOCK values, all less than 2^bits)
+   * @param bits the bit width
+   * @param out  the packed block (bits * 16 bytes)
+   */
+  void pack_block(const uint32_t *in, unsigned bits, uint8_t *out);
+
+  /**
+   * Unpack a block of values
+   * @param in   the packed block (bits * 16 bytes)
+   * @param bits the bit width
+   * @param out  the block (BITPACK_BLOCK values)
+   */
+  void unpack_block(const uint8_t *in, unsigned bits, uint32_t *out);
+
+  /**
+   * Decode an encoded column
+   * @param  in    the encoded column
+   * @param  count the number of values
+   * @param  codec the codec
+   * @param  out   the values (count values are written)
+   * @return       the byte after the column
+   */
+  const uint8_t *decode_column(const uint8_t *in, size_t count, codec_t codec, int32_t *out);
+
+  /*
+   * An integer column encoded as it is appended. Full bit packed blocks are
+   * followed by the varint encoded tail (the whole column with the varint codec)
+   */
+  struct int_column_t {
+  public:
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+  private:
+    //packed blocks, then the varint tail
+    std::pmr::vector<uint8_t> data;
+    //start of the varint tail in data
+    uint32_t tail_offset;
+    uint32_t count;
+    //the last value (delta base)
+    int32_t last;
+    codec_t codec;
+
+  public:
+    /**
+     * Constructor
+     * @param codec the codec
+     * @param alloc the allocator for the encoded data
+     */
+    int_column_t(codec_t codec, const allocator_type& alloc = {});
+
+    /**
+     * Append a value
+     * @param value the value
+     */
+    void append(int32_t value);
+
+    /**
+     * Decode the column
+     * @param out the values (size() values are written)
+     */
+    void decode(int32_t *out) const;
+
+    /**
+     * @return the number of values
+     */
+    size_t size() const {
+      return this->count;
+    }
+
+    /**
+     * @return the last value appended
+     */
+    int32_t back() const {
+      return this->last;
+    }
+
+    /**
+     * @return the codec
+     */
+    codec_t get_codec() const {
+      return this->codec;
+    }
+
+    /**
+     * @return the encoded column
+     */
+    const std::pmr::vector<uint8_t>& bytes() const {
+      return this->data;
+    }
+  };
+
+  /**
+   * Quantize a non negative value to fixed point (saturating)
+   * @param  value the value
+   * @param  scale fixed point units per unit of value (e.g. 10 for decimetres)
+   * @return       the fixed point value
+   */
+  uint16_t quantize(double value, double scale);
+
+  /**
+   * Get the value of a fixed point value
+   * @param  value the fixed point value
+   * @param  scale fixed point units per unit of value
+   * @return       the value
+   */
+  inline double dequantize(uint16_t value, double scale) {
+    return value / scale;
+  }
+}
+
+#endif /*_INT_CODEC_H*/
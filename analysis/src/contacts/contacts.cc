@@ -0,0 +1,66 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "contacts.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+namespace contacts {
+  /**
+   * Collect the contacts of every tower (from contact intervals or merged from per timestep recognitions)
+   * @param tower_recognitions tower recognitions
+   * @param tower_ids          the tower ids (sorted, contact tower indices refer to these)
+   * @param contacts           the contacts (grouped by tower)
+   */
+  void collect_contacts(const types::tower_recognitions_map_t& tower_recognitions,
+                        std::vector<std::string>& tower_ids,
+                        std::vector<contact_t>& contacts) {
+    //stable tower order
+    for (const std::pair<const std::pmr::string,types::tower_recognitions_t>& tower : tower_recognitions) {
+      tower_ids.emplace_back(tower.first);
+    }
+    std::sort(tower_ids.begin(), tower_ids.end());
+
+    std::unordered_map<std::string_view,uint32_t> vehicle_index;
+
+    for (uint32_t t=0; t<tower_ids.size(); t++) {
+      const types::tower_recognitions_t& tower = tower_recognitions.at(std::pmr::string(tower_ids[t]));
+
+      if (tower.has_intervals()) {
+        for (const auto& vehicle : tower.contact_intervals()) {
+          uint32_t v = vehicle_index.emplace(vehicle.first, vehicle_index.size()).first->second;
+          for (const types::contact_interval_t& interval : vehicle.second) {
+            contacts.push_back({v, t, interval.start, interval.end});
+          }
+        }
+
+      } else {
+        //single timestep contacts, merged below
+        size_t first = contacts.size();
+        tower.expand([&] (int ts, const std::pmr::string& vehicle_id, double) {
+          uint32_t v = vehicle_index.emplace(vehicle_id, vehicle_index.size()).first->second;
+          contacts.push_back({v, t, ts, ts});
+        });
+
+        std::sort(contacts.begin() + first, contacts.end(), [] (const contact_t& a, const contact_t& b) {
+          return (a.vehicle != b.vehicle) ? (a.vehicle < b.vehicle) : (a.start < b.start);
+        });
+
+        //merge consecutive timesteps
+        size_t out = first;
+        for (size_t i=first; i<contacts.size(); i++) {
+          if ((out > first) &&
+              (contacts[out - 1].vehicle == contacts[i].vehicle) &&
+              (contacts[out - 1].end + 1 >= contacts[i].start)) {
+            contacts[out - 1].end = std::max(contacts[out - 1].end, contacts[i].end);
+          } else {
+            contacts[out++] = contacts[i];
+          }
+        }
+        contacts.resize(out);
+      }
+    }
+  }
+}
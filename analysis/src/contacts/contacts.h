@@ -0,0 +1,38 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _CONTACTS_H
+#define _CONTACTS_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "../types/tower_recognitions.h"
+
+namespace contacts {
+  /*
+   * A run of consecutive timesteps in which a vehicle is in range of a tower
+   */
+  struct contact_t {
+    //vehicle index (order of first appearance)
+    uint32_t vehicle;
+    //tower index (in the sorted tower ids)
+    uint32_t tower;
+    //first and last timestep (inclusive)
+    int start;
+    int end;
+  };
+
+  /**
+   * Collect the contacts of every tower (from contact intervals or merged from per timestep recognitions)
+   * @param tower_recognitions tower recognitions
+   * @param tower_ids          the tower ids (sorted, contact tower indices refer to these)
+   * @param contacts           the contacts (grouped by tower)
+   */
+  void collect_contacts(const types::tower_recognitions_map_t& tower_recognitions,
+                        std::vector<std::string>& tower_ids,
+                        std::vector<contact_t>& contacts);
+}
+
+#endif /*_CONTACTS_H*/
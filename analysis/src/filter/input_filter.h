@@ -0,0 +1,59 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _INPUT_FILTER_H
+#define _INPUT_FILTER_H
+
+#include <memory_resource>
+#include <string>
+#include "region.h"
+#include "../sample/vehicle_sample.h"
+#include "../types/network.h"
+
+namespace filter {
+  /*
+   * What to keep while parsing the inputs (everything by default): elements
+   * outside the filter are skipped before they are copied. Also how vehicles
+   * map to segments
+   */
+  struct input_filter_t {
+    //vehicles kept (all if not set)
+    sample::vehicle_sample_t *sample = nullptr;
+    //region of interest (towers outside are skipped)
+    const region_t *region = nullptr;
+    //the lanes in the region of interest, once the network is loaded
+    //(netstate vehicles on other lanes are skipped)
+    const types::network_t *network = nullptr;
+    //time window [t_start, t_end) and stride (seconds, every stride-th second from t_start)
+    bool windowed = false;
+    int t_start = 0;
+    int t_end = 0;
+    int stride = 1;
+    //vehicles are recorded on edges (all lanes of an edge are one segment) instead of lanes
+    bool edge_segments = false;
+
+    /**
+     * Check if a timestep is kept
+     * @param  ts the timestep (seconds)
+     * @return    whether the timestep is in the time window and on the stride (or no window is set)
+     */
+    bool keep_time(int ts) const {
+      return !this->windowed ||
+             ((ts >= this->t_start) && (ts < this->t_end) && (((ts - this->t_start) % this->stride) == 0));
+    }
+
+    /**
+     * Check if the vehicles on a lane are kept
+     * @param  lane_id the lane id
+     * @return         whether the lane is in the region of interest (or no region is set)
+     */
+    bool keep_lane(const std::pmr::string& lane_id) const {
+      return (this->network == nullptr) ||
+             (this->network->edge_shapes.find(lane_id) != this->network->edge_shapes.end()) ||
+             (this->network->internal_shapes.find(lane_id) != this->network->internal_shapes.end());
+    }
+  };
+}
+
+#endif /*_INPUT_FILTER_H*/
@@ -0,0 +1,216 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "region.h"
+#include "../parse/xml_loader.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
+#define SHAPE_ATTR_PREFIX "shape=\""
+
+namespace filter {
+
+  typedef std::pair<double,double> point_t;
+
+  /**
+   * Orientation of the turn a -> b -> c
+   * @return positive (counter clockwise), negative (clockwise) or 0 (collinear)
+   */
+  inline double orientation(const point_t& a, const point_t& b, const point_t& c) {
+    return (b.first - a.first) * (c.second - a.second) - (b.second - a.second) * (c.first - a.first);
+  }
+
+  /**
+   * Check if two segments intersect (touching counts)
+   * @param  a0,a1 the first segment
+   * @param  b0,b1 the second segment
+   * @return       whether the segments intersect
+   */
+  bool segments_intersect(const point_t& a0, const point_t& a1,
+                          const point_t& b0, const point_t& b1) {
+    double d0 = orientation(b0, b1, a0);
+    double d1 = orientation(b0, b1, a1);
+    double d2 = orientation(a0, a1, b0);
+    double d3 = orientation(a0, a1, b1);
+
+    if ((((d0 > 0) && (d1 < 0)) || ((d0 < 0) && (d1 > 0))) &&
+        (((d2 > 0) && (d3 < 0)) || ((d2 < 0) && (d3 > 0)))) {
+      return true;
+    }
+
+    //collinear endpoints on the other segment
+    auto on_segment = [] (const point_t& p, const point_t& q, const point_t& r) {
+      return (std::min(p.first, q.first) <= r.first) && (r.first <= std::max(p.first, q.first)) &&
+             (std::min(p.second, q.second) <= r.second) && (r.second <= std::max(p.second, q.second));
+    };
+    return ((d0 == 0) && on_segment(b0, b1, a0)) ||
+           ((d1 == 0) && on_segment(b0, b1, a1)) ||
+           ((d2 == 0) && on_segment(a0, a1, b0)) ||
+           ((d3 == 0) && on_segment(a0, a1, b1));
+  }
+
+  /**
+   * Check if a point is in the region
+   * @param  x,y the point
+   * @return     whether the point is inside (or on the boundary of) the region
+   */
+  bool region_t::contains(double x, double y) const {
+    if ((x < this->min_x) || (x > this->max_x) || (y < this->min_y) || (y > this->max_y)) {
+      return false;
+    } else if (this->is_box) {
+      return true;
+    }
+
+    //even-odd ray cast
+    bool inside = false;
+    for (size_t i=0, j=this->polygon.size() - 1; i<this->polygon.size(); j=i++) {
+      const point_t& a = this->polygon[i];
+      const point_t& b = this->polygon[j];
+      if (((a.second > y) != (b.second > y)) &&
+          (x < (b.first - a.first) * (y - a.second) / (b.second - a.second) + a.first)) {
+        inside = !inside;
+      }
+    }
+    return inside;
+  }
+
+  /**
+   * Check if any part of a shape (polyline) is in the region
+   * @param  shape the shape vertices
+   * @return       whether the shape is not entirely outside the region
+   */
+  bool region_t::intersects(const std::vector<std::pair<double,double>>& shape) const {
+    if (shape.empty()) {
+      return false;
+    }
+
+    //shape bounding box
+    double min_x = shape[0].first, max_x = shape[0].first;
+    double min_y = shape[0].second, max_y = shape[0].second;
+    for (const point_t& p : shape) {
+      min_x = std::min(min_x, p.first);
+      max_x = std::max(max_x, p.first);
+      min_y = std::min(min_y, p.second);
+      max_y = std::max(max_y, p.second);
+    }
+
+    if ((max_x < this->min_x) || (min_x > this->max_x) || (max_y < this->min_y) || (min_y > this->max_y)) {
+      return false;
+    }
+
+    for (const point_t& p : shape) {
+      if (this->contains(p.first, p.second)) {
+        return true;
+      }
+    }
+
+    //a shape with no vertex inside is in the region only if it crosses the boundary
+    for (size_t s=1; s<shape.size(); s++) {
+      for (size_t i=0, j=this->polygon.size() - 1; i<this->polygon.size(); j=i++) {
+        if (segments_intersect(shape[s - 1], shape[s], this->polygon[j], this->polygon[i])) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Parse a bounding box "<min x>,<min y>,<max x>,<max y>"
+   * @param  spec   the bounding box
+   * @param  region the parsed region
+   * @return        whether the spec is a bounding box
+   */
+  bool parse_box(const std::string& spec, region_t& region) {
+    double v[4];
+    const char *p = spec.c_str();
+
+    for (int i=0; i<4; i++) {
+      char *end = NULL;
+      v[i] = strtod(p, &end);
+      if ((end == p) || (*end != ((i < 3) ? ',' : '\0'))) {
+        return false;
+      }
+      p = end + 1;
+    }
+
+    if ((v[0] >= v[2]) || (v[1] >= v[3])) {
+      return false;
+    }
+
+    region.min_x = v[0];
+    region.min_y = v[1];
+    region.max_x = v[2];
+    region.max_y = v[3];
+    region.polygon = {{v[0], v[1]}, {v[2], v[1]}, {v[2], v[3]}, {v[0], v[3]}};
+    region.is_box = true;
+    return true;
+  }
+
+  /**
+   * Parse a region of interest from either:
+   *  - a bounding box "<min x>,<min y>,<max x>,<max y>"
+   *  - a polygon file: a sumo shape ("x,y x,y ...", whitespace or newline separated)
+   *    or a sumo additional file (the shape of the first poly)
+   * @param  spec   the bounding box or the path to the polygon file
+   * @param  region the parsed region
+   * @return        success or failure
+   */
+  bool parse_region(const std::string& spec, region_t& region) {
+    std::ifstream in(spec);
+    if (!in) {
+      if (!parse_box(spec, region)) {
+        std::cerr << "ERR: roi must be <min x>,<min y>,<max x>,<max y> or a polygon file: " << spec << std::endl;
+        return false;
+      }
+      return true;
+    }
+
+    std::stringstream buff;
+    buff << in.rdbuf();
+    std::string contents = buff.str();
+
+    //the shape attribute of an additional file
+    size_t shape_start = contents.find(SHAPE_ATTR_PREFIX);
+    if (shape_start != std::string::npos) {
+      shape_start += std::string(SHAPE_ATTR_PREFIX).size();
+      contents = contents.substr(shape_start, contents.find('"', shape_start) - shape_start);
+    }
+
+    //single space separated vertices
+    std::stringstream words(contents);
+    std::string word;
+    std::string shape;
+    while (words >> word) {
+      shape += (shape.empty() ? "" : " ") + word;
+    }
+
+    region.polygon.clear();
+    bool parsed = parse::parse_shape(shape, region.polygon);
+
+    //a closed shape repeats the first vertex
+    if (parsed && (region.polygon.front() == region.polygon.back())) {
+      region.polygon.pop_back();
+    }
+
+    if (!parsed || (region.polygon.size() < 3)) {
+      std::cerr << "ERR: roi polygon needs at least 3 vertices: " << spec << std::endl;
+      return false;
+    }
+
+    region.min_x = region.max_x = region.polygon[0].first;
+    region.min_y = region.max_y = region.polygon[0].second;
+    for (const point_t& p : region.polygon) {
+      region.min_x = std::min(region.min_x, p.first);
+      region.max_x = std::max(region.max_x, p.first);
+      region.min_y = std::min(region.min_y, p.second);
+      region.max_y = std::max(region.max_y, p.second);
+    }
+    region.is_box = false;
+    return true;
+  }
+}
@@ -0,0 +1,54 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _REGION_H
+#define _REGION_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace filter {
+  /*
+   * A region of interest: a bounding box or a polygon (network coordinates)
+   */
+  struct region_t {
+    //bounding box (of the polygon)
+    double min_x = 0.0;
+    double min_y = 0.0;
+    double max_x = 0.0;
+    double max_y = 0.0;
+    //the polygon vertices (the box corners for a bounding box)
+    std::vector<std::pair<double,double>> polygon;
+    //whether the region is the bounding box
+    bool is_box = true;
+
+    /**
+     * Check if a point is in the region
+     * @param  x,y the point
+     * @return     whether the point is inside (or on the boundary of) the region
+     */
+    bool contains(double x, double y) const;
+
+    /**
+     * Check if any part of a shape (polyline) is in the region
+     * @param  shape the shape vertices
+     * @return       whether the shape is not entirely outside the region
+     */
+    bool intersects(const std::vector<std::pair<double,double>>& shape) const;
+  };
+
+  /**
+   * Parse a region of interest from either:
+   *  - a bounding box "<min x>,<min y>,<max x>,<max y>"
+   *  - a polygon file: a sumo shape ("x,y x,y ...", whitespace or newline separated)
+   *    or a sumo additional file (the shape of the first poly)
+   * @param  spec   the bounding box or the path to the polygon file
+   * @param  region the parsed region
+   * @return        success or failure
+   */
+  [[nodiscard]] bool parse_region(const std::string& spec, region_t& region);
+}
+
+#endif /*_REGION_H*/
@@ -0,0 +1,73 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "handoff_graph.h"
+#include <algorithm>
+#include "../contacts/contacts.h"
+
+namespace handoff {
+  /**
+   * Get the histogram bucket of a transition time
+   * @param  gap the transition time (timesteps)
+   * @return     the bucket
+   */
+  size_t handoff_bucket(int64_t gap) {
+    size_t bucket = 0;
+    while ((gap > 0) && (bucket < HANDOFF_BUCKETS - 1)) {
+      gap >>= 1;
+      bucket++;
+    }
+    return bucket;
+  }
+
+  /**
+   * Build the handoff graph from the contact sequence of each vehicle: after a contact with
+   * a tower ends, the vehicle is handed off to the tower of the next contact (ordered by end)
+   * with a different tower, the transition time being the gap until that contact starts
+   * @param tower_recognitions tower recognitions (per timestep or intervals)
+   * @param graph              the graph
+   */
+  void build_handoff_graph(const types::tower_recognitions_map_t& tower_recognitions,
+                           handoff_graph_t& graph) {
+    std::vector<contacts::contact_t> all_contacts;
+    contacts::collect_contacts(tower_recognitions, graph.tower_ids, all_contacts);
+    graph.towers.assign(graph.tower_ids.size(), tower_handoffs_t());
+
+    //contact sequence of each vehicle
+    std::sort(all_contacts.begin(), all_contacts.end(), [] (const contacts::contact_t& a, const contacts::contact_t& b) {
+      if (a.vehicle != b.vehicle) {
+        return a.vehicle < b.vehicle;
+      }
+      if (a.end != b.end) {
+        return a.end < b.end;
+      }
+      return (a.start != b.start) ? (a.start < b.start) : (a.tower < b.tower);
+    });
+
+    for (size_t i=0; i<all_contacts.size(); i++) {
+      const contacts::contact_t& from = all_contacts[i];
+      tower_handoffs_t& handoffs = graph.towers[from.tower];
+      handoffs.departures++;
+
+      //the next contact of this vehicle with another tower
+      size_t j = i + 1;
+      while ((j < all_contacts.size()) &&
+             (all_contacts[j].vehicle == from.vehicle) &&
+             (all_contacts[j].tower == from.tower)) {
+        j++;
+      }
+
+      if ((j == all_contacts.size()) || (all_contacts[j].vehicle != from.vehicle)) {
+        handoffs.exits++;
+        continue;
+      }
+
+      int64_t gap = std::max(0, all_contacts[j].start - from.end);
+      handoff_edge_t& edge = handoffs.next[all_contacts[j].tower];
+      edge.count++;
+      edge.gap_sum += gap;
+      edge.histogram[handoff_bucket(gap)]++;
+    }
+  }
+}
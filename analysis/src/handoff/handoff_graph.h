@@ -0,0 +1,68 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _HANDOFF_GRAPH_H
+#define _HANDOFF_GRAPH_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include "../types/tower_recognitions.h"
+
+namespace handoff {
+  //transition time histogram buckets: 0 (overlapping contact), then [2^(k-1), 2^k) timesteps
+  #define HANDOFF_BUCKETS 12
+
+  /*
+   * Handoffs from one tower to another
+   */
+  struct handoff_edge_t {
+    uint64_t count = 0;
+    //sum of transition times (timesteps between leaving and the next contact, 0 if overlapping)
+    uint64_t gap_sum = 0;
+    uint64_t histogram[HANDOFF_BUCKETS] = {0};
+  };
+
+  /*
+   * Contacts leaving one tower
+   */
+  struct tower_handoffs_t {
+    //contact intervals that ended
+    uint64_t departures = 0;
+    //contacts not followed by another tower
+    uint64_t exits = 0;
+    //handoffs by next tower index
+    std::unordered_map<uint32_t,handoff_edge_t> next;
+  };
+
+  /*
+   * Weighted tower -> tower handoff graph
+   */
+  struct handoff_graph_t {
+    //tower ids (sorted)
+    std::vector<std::string> tower_ids;
+    //handoffs for each tower (same order)
+    std::vector<tower_handoffs_t> towers;
+  };
+
+  /**
+   * Get the histogram bucket of a transition time
+   * @param  gap the transition time (timesteps)
+   * @return     the bucket
+   */
+  size_t handoff_bucket(int64_t gap);
+
+  /**
+   * Build the handoff graph from the contact sequence of each vehicle: after a contact with
+   * a tower ends, the vehicle is handed off to the tower of the next contact (ordered by end)
+   * with a different tower, the transition time being the gap until that contact starts
+   * @param tower_recognitions tower recognitions (per timestep or intervals)
+   * @param graph              the graph
+   */
+  void build_handoff_graph(const types::tower_recognitions_map_t& tower_recognitions,
+                           handoff_graph_t& graph);
+}
+
+#endif /*_HANDOFF_GRAPH_H*/
@@ -0,0 +1,112 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "tower_load.h"
+#include "../contacts/contacts.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace load {
+  /**
+   * Compute the load on each tower at each timestep
+   * @param tower_recognitions tower recognitions (per timestep or intervals)
+   * @param tower_load         the load matrices
+   */
+  void compute_tower_load(const types::tower_recognitions_map_t& tower_recognitions,
+                          tower_load_t& tower_load) {
+    std::vector<contacts::contact_t> all_contacts;
+    contacts::collect_contacts(tower_recognitions, tower_load.tower_ids, all_contacts);
+
+    if (all_contacts.empty()) {
+      return;
+    }
+
+    //the timestep range
+    int first = std::numeric_limits<int>::max();
+    int last = std::numeric_limits<int>::min();
+    for (const contacts::contact_t& contact : all_contacts) {
+      first = std::min(first, contact.start);
+      last = std::max(last, contact.end);
+    }
+
+    tower_load.first_ts = first;
+    tower_load.timesteps = last - first + 1;
+    tower_load.in_range.assign(tower_load.tower_ids.size() * tower_load.timesteps, 0);
+    tower_load.arrivals.assign(tower_load.tower_ids.size() * tower_load.timesteps, 0);
+
+    for (const contacts::contact_t& contact : all_contacts) {
+      size_t row = contact.tower * tower_load.timesteps;
+      tower_load.arrivals[row + (contact.start - first)]++;
+      for (int ts=contact.start; ts<=contact.end; ts++) {
+        tower_load.in_range[row + (ts - first)]++;
+      }
+    }
+  }
+
+  /**
+   * Get a percentile (nearest rank)
+   * @param  sorted sorted values
+   * @param  p      the percentile (0-1)
+   * @return        the value
+   */
+  inline uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+    size_t rank = (size_t) ceil(p * sorted.size());
+    return sorted[(rank > 0) ? rank - 1 : 0];
+  }
+
+  /**
+   * Summarize the load of each tower over time
+   * @param tower_load the load matrices
+   * @param summaries  statistics for each tower (same order as the tower ids)
+   */
+  void summarize_tower_load(const tower_load_t& tower_load,
+                            std::vector<tower_load_summary_t>& summaries) {
+    size_t n = tower_load.timesteps;
+    summaries.assign(tower_load.tower_ids.size(), tower_load_summary_t());
+
+    if (n == 0) {
+      return;
+    }
+
+    //the highest load at each timestep
+    std::vector<uint32_t> ts_max(n, 0);
+    for (size_t t=0; t<tower_load.tower_ids.size(); t++) {
+      for (size_t i=0; i<n; i++) {
+        ts_max[i] = std::max(ts_max[i], tower_load.in_range[t * n + i]);
+      }
+    }
+
+    std::vector<uint32_t> sorted;
+    for (size_t t=0; t<tower_load.tower_ids.size(); t++) {
+      const uint32_t *row = &tower_load.in_range[t * n];
+      const uint32_t *arrivals = &tower_load.arrivals[t * n];
+      tower_load_summary_t& summary = summaries[t];
+
+      uint64_t total = 0;
+      size_t peak = 0;
+      for (size_t i=0; i<n; i++) {
+        total += row[i];
+        summary.arrivals += arrivals[i];
+        if (row[i] > row[peak]) {
+          peak = i;
+        }
+        if ((row[i] > 0) && (row[i] == ts_max[i])) {
+          summary.straggler_timesteps++;
+        }
+      }
+
+      sorted.assign(row, row + n);
+      std::sort(sorted.begin(), sorted.end());
+
+      summary.mean = (double) total / n;
+      summary.p50 = percentile(sorted, 0.50);
+      summary.p90 = percentile(sorted, 0.90);
+      summary.p95 = percentile(sorted, 0.95);
+      summary.p99 = percentile(sorted, 0.99);
+      summary.max = sorted.back();
+      summary.peak_ts = tower_load.first_ts + (int) peak;
+    }
+  }
+}
@@ -0,0 +1,63 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _TOWER_LOAD_H
+#define _TOWER_LOAD_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "../types/tower_recognitions.h"
+
+namespace load {
+  /*
+   * Dense tower x timestep load matrices (a row per tower)
+   */
+  struct tower_load_t {
+    //tower ids (sorted)
+    std::vector<std::string> tower_ids;
+    //the first timestep and the number of timesteps (every timestep from first to last recognition)
+    int first_ts = 0;
+    size_t timesteps = 0;
+    //vehicles in range of each tower at each timestep
+    std::vector<uint32_t> in_range;
+    //vehicles that came into range of each tower at each timestep
+    std::vector<uint32_t> arrivals;
+  };
+
+  /*
+   * Load statistics over time for a tower
+   */
+  struct tower_load_summary_t {
+    double mean;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p95;
+    uint32_t p99;
+    uint32_t max;
+    //the first timestep at max load
+    int peak_ts;
+    uint64_t arrivals;
+    //timesteps at which this tower had the highest load of all towers
+    uint64_t straggler_timesteps;
+  };
+
+  /**
+   * Compute the load on each tower at each timestep
+   * @param tower_recognitions tower recognitions (per timestep or intervals)
+   * @param tower_load         the load matrices
+   */
+  void compute_tower_load(const types::tower_recognitions_map_t& tower_recognitions,
+                          tower_load_t& tower_load);
+
+  /**
+   * Summarize the load of each tower over time
+   * @param tower_load the load matrices
+   * @param summaries  statistics for each tower (same order as the tower ids)
+   */
+  void summarize_tower_load(const tower_load_t& tower_load,
+                            std::vector<tower_load_summary_t>& summaries);
+}
+
+#endif /*_TOWER_LOAD_H*/
@@ -3,12 +3,88 @@
  */
 
 #include <string>
+#include <vector>
+#include <sstream>
 #include <unistd.h>
+#include <getopt.h>
 #include <iostream>
 #include "process.h"
+#include "batch/batch.h"
+#include "output/output_file.h"
+#include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
 
+//long only options
+#define OPT_PERF_COUNTERS 256
+#define OPT_WHAT_IF       257
+#define OPT_RANGE         258
+#define OPT_TRAJECTORIES  259
+#define OPT_RANGES        260
+#define OPT_INTERVALS     261
+#define OPT_CURVE_STEP    262
+#define OPT_HANDOFFS      263
+#define OPT_TOWER_LOAD    264
+#define OPT_BATCH         265
+#define OPT_JOBS          266
+#define OPT_MEM_BUDGET    267
+#define OPT_NET_CACHE     268
+#define OPT_CACHE_DIR     269
+#define OPT_INCREMENTAL   270
+#define OPT_FOLLOW        271
+#define OPT_FOLLOW_IDLE   272
+#define OPT_TRACI         273
+#define OPT_TRACI_END     274
+#define OPT_COMPRESS      275
+#define OPT_FORMAT        276
+#define OPT_ARROW         277
+#define OPT_QUANTIZE      278
+#define OPT_CODEC         279
+#define OPT_PACKED        280
+#define OPT_SAMPLE_RATE   281
+#define OPT_SEED          282
+#define OPT_ROI           283
+#define OPT_T_START       284
+#define OPT_T_END         285
+#define OPT_STRIDE        286
+#define OPT_EDGE_SEGMENTS 287
+
+static const struct option long_options[] = {
+  {"perf-counters", no_argument, NULL, OPT_PERF_COUNTERS},
+  {"what-if", required_argument, NULL, OPT_WHAT_IF},
+  {"range", required_argument, NULL, OPT_RANGE},
+  {"trajectories", no_argument, NULL, OPT_TRAJECTORIES},
+  {"ranges", required_argument, NULL, OPT_RANGES},
+  {"intervals", no_argument, NULL, OPT_INTERVALS},
+  {"curve-step", required_argument, NULL, OPT_CURVE_STEP},
+  {"handoffs", no_argument, NULL, OPT_HANDOFFS},
+  {"tower-load", no_argument, NULL, OPT_TOWER_LOAD},
+  {"batch", required_argument, NULL, OPT_BATCH},
+  {"jobs", required_argument, NULL, OPT_JOBS},
+  {"mem-budget", required_argument, NULL, OPT_MEM_BUDGET},
+  {"net-cache", no_argument, NULL, OPT_NET_CACHE},
+  {"cache-dir", required_argument, NULL, OPT_CACHE_DIR},
+  {"incremental", no_argument, NULL, OPT_INCREMENTAL},
+  {"follow", no_argument, NULL, OPT_FOLLOW},
+  {"follow-timeout", required_argument, NULL, OPT_FOLLOW_IDLE},
+  {"traci", required_argument, NULL, OPT_TRACI},
+  {"traci-end", required_argument, NULL, OPT_TRACI_END},
+  {"compress", required_argument, NULL, OPT_COMPRESS},
+  {"format", required_argument, NULL, OPT_FORMAT},
+  {"arrow", no_argument, NULL, OPT_ARROW},
+  {"quantize", required_argument, NULL, OPT_QUANTIZE},
+  {"codec", required_argument, NULL, OPT_CODEC},
+  {"packed", no_argument, NULL, OPT_PACKED},
+  {"sample-rate", required_argument, NULL, OPT_SAMPLE_RATE},
+  {"seed", required_argument, NULL, OPT_SEED},
+  {"roi", required_argument, NULL, OPT_ROI},
+  {"t-start", required_argument, NULL, OPT_T_START},
+  {"t-end", required_argument, NULL, OPT_T_END},
+  {"stride", required_argument, NULL, OPT_STRIDE},
+  {"edge-segments", no_argument, NULL, OPT_EDGE_SEGMENTS},
+  {NULL, 0, NULL, 0}
+};
+
 /**
  * Check if the file exists for the given path
  * @param  path path to the file
@@ -31,6 +107,48 @@ inline bool is_dir(const std::string& path) {
          (d_info.st_mode & S_IFDIR);
 }
 
+/**
+ * Parse a comma separated list of ranges
+ * @param  list   the list
+ * @param  ranges the parsed ranges
+ * @return        whether all ranges are positive numbers
+ */
+bool parse_ranges(const std::string& list, std::vector<double>& ranges) {
+  std::stringstream sstream(list);
+  std::string range;
+
+  while (std::getline(sstream, range, ',')) {
+    char *end = NULL;
+    double r = strtod(range.c_str(), &end);
+    if ((end == range.c_str()) || (*end != '\0') || (r <= 0)) {
+      return false;
+    }
+    ranges.push_back(r);
+  }
+  return !ranges.empty();
+}
+
+/**
+ * Parse a traci server address
+ * @param  address the address ("<host>:<port>" or "<port>" for localhost)
+ * @param  host    the parsed host
+ * @param  port    the parsed port
+ * @return         whether the address is valid
+ */
+bool parse_traci_address(const std::string& address, std::string& host, int& port) {
+  size_t split = address.rfind(':');
+  host = (split == std::string::npos) ? "localhost" : address.substr(0, split);
+  std::string port_str = (split == std::string::npos) ? address : address.substr(split + 1);
+
+  char *end = NULL;
+  long p = strtol(port_str.c_str(), &end, 10);
+  if (host.empty() || (end == port_str.c_str()) || (*end != '\0') || (p <= 0) || (p > 65535)) {
+    return false;
+  }
+  port = (int) p;
+  return true;
+}
+
 /**
  * Run analysis pipeline
  */
@@ -44,8 +162,17 @@ int main(int argc, char **argv) {
   std::string raw_output_path;
   //the location to write the output to
   std::string output_path;
+  //tower positions to evaluate (instead of bt output)
+  std::string what_if_path;
+  //manifest of outputs to process against the network
+  std::string batch_path;
+  //traci server to step (instead of bt output and netstate)
+  std::string traci_host;
+  int traci_port = 0;
+  //run options
+  process_options_t options;
 
-  while ((c = getopt(argc, argv, "b:o:n:r:")) != -1) {
+  while ((c = getopt_long(argc, argv, "b:o:n:r:", long_options, NULL)) != -1) {
     if (c == 'b') {
       bt_output_path = std::string(optarg);
     } else if (c == 'o') {
@@ -54,11 +181,228 @@ int main(int argc, char **argv) {
       net_input_path = std::string(optarg);
     } else if (c == 'r') {
       raw_output_path = std::string(optarg);
+    } else if (c == OPT_PERF_COUNTERS) {
+      options.perf_counters = true;
+    } else if (c == OPT_WHAT_IF) {
+      what_if_path = std::string(optarg);
+    } else if (c == OPT_RANGE) {
+      options.range = atof(optarg);
+    } else if (c == OPT_TRAJECTORIES) {
+      options.trajectories = true;
+    } else if (c == OPT_RANGES) {
+      if (!parse_ranges(std::string(optarg), options.ranges)) {
+        std::cerr << "ERR: ranges must be a comma separated list of positive numbers: " << optarg << std::endl;
+        return EXIT_FAILURE;
+      }
+    } else if (c == OPT_INTERVALS) {
+      options.intervals = true;
+    } else if (c == OPT_CURVE_STEP) {
+      options.curve_step = atoi(optarg);
+    } else if (c == OPT_HANDOFFS) {
+      options.handoffs = true;
+    } else if (c == OPT_TOWER_LOAD) {
+      options.tower_load = true;
+    } else if (c == OPT_BATCH) {
+      batch_path = std::string(optarg);
+    } else if (c == OPT_JOBS) {
+      options.batch_jobs = std::max(1, atoi(optarg));
+    } else if (c == OPT_MEM_BUDGET) {
+      //megabytes
+      options.batch_memory_budget = (uint64_t) std::max(1, atoi(optarg)) << 20;
+    } else if (c == OPT_NET_CACHE) {
+      options.net_cache = true;
+    } else if (c == OPT_CACHE_DIR) {
+      //implies the cache
+      options.net_cache = true;
+      options.cache_dir = std::string(optarg);
+    } else if (c == OPT_INCREMENTAL) {
+      options.incremental = true;
+    } else if (c == OPT_FOLLOW) {
+      options.follow = true;
+    } else if (c == OPT_FOLLOW_IDLE) {
+      //seconds
+      options.follow_timeout = std::max(1, atoi(optarg));
+    } else if (c == OPT_TRACI) {
+      if (!parse_traci_address(std::string(optarg), traci_host, traci_port)) {
+        std::cerr << "ERR: traci address must be <host>:<port>: " << optarg << std::endl;
+        return EXIT_FAILURE;
+      }
+    } else if (c == OPT_TRACI_END) {
+      options.traci_end = atof(optarg);
+    } else if (c == OPT_COMPRESS) {
+      //json outputs (none, gzip or zstd when built with it)
+      output::compression_t compression;
+      if (!output::parse_compression(std::string(optarg), compression)) {
+        std::cerr << "ERR: unsupported output compression: " << optarg << std::endl;
+        return EXIT_FAILURE;
+      }
+      output::set_compression(compression);
+    } else if (c == OPT_FORMAT) {
+      //json output encoding (json, cbor or msgpack)
+      output::format_t format;
+      if (!output::parse_format(std::string(optarg), format)) {
+        std::cerr << "ERR: unsupported output format: " << optarg << std::endl;
+        return EXIT_FAILURE;
+      }
+      output::set_format(format);
+    } else if (c == OPT_ARROW) {
+      options.arrow = true;
+    } else if (c == OPT_QUANTIZE) {
+      //meters per distance unit (compact recognition storage)
+      options.dist_quantum = atof(optarg);
+      if (options.dist_quantum <= 0) {
+        std::cerr << "ERR: distance quantum must be positive" << std::endl;
+        return EXIT_FAILURE;
+      }
+    } else if (c == OPT_CODEC) {
+      //timestep columns (varint or bitpack)
+      if (!codec::parse_codec(std::string(optarg), options.codec)) {
+        std::cerr << "ERR: unsupported codec: " << optarg << std::endl;
+        return EXIT_FAILURE;
+      }
+    } else if (c == OPT_PACKED) {
+      options.packed = true;
+    } else if (c == OPT_SAMPLE_RATE) {
+      //fraction of vehicles kept
+      options.sample_rate = atof(optarg);
+      if ((options.sample_rate <= 0) || (options.sample_rate > 1)) {
+        std::cerr << "ERR: sample rate must be in (0, 1]" << std::endl;
+        return EXIT_FAILURE;
+      }
+    } else if (c == OPT_SEED) {
+      options.sample_seed = strtoull(optarg, NULL, 10);
+    } else if (c == OPT_ROI) {
+      //bounding box or polygon file
+      filter::region_t region;
+      if (!filter::parse_region(std::string(optarg), region)) {
+        return EXIT_FAILURE;
+      }
+      options.roi = region;
+    } else if (c == OPT_T_START) {
+      //time window (seconds)
+      options.t_start = atoi(optarg);
+      options.windowed = true;
+    } else if (c == OPT_T_END) {
+      options.t_end = atoi(optarg);
+      options.windowed = true;
+    } else if (c == OPT_STRIDE) {
+      options.stride = atoi(optarg);
+      options.windowed = true;
+    } else if (c == OPT_EDGE_SEGMENTS) {
+      //lanes grouped by edge
+      options.edge_segments = true;
     }
   }
 
   //validate arguments
-  if (!is_file(bt_output_path)) {
+  if (!options.cache_dir.empty() && !is_dir(options.cache_dir)) {
+    std::cerr << "ERR: cache directory does not exist: " << options.cache_dir << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (options.windowed && ((options.stride <= 0) || (options.t_end <= options.t_start))) {
+    std::cerr << "ERR: stride must be positive and the time window end after its start" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if ((options.stride > 1) && (options.intervals || options.handoffs || options.tower_load)) {
+    //contacts are runs of consecutive timesteps: a stride would split each into single samples
+    std::cerr << "ERR: --stride can't be used with --intervals, --handoffs or --tower-load" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (options.incremental && !what_if_path.empty()) {
+    //what-if recognitions are always recomputed from the netstate
+    std::cerr << "WARN: --incremental has no effect with --what-if" << std::endl;
+  }
+
+  if (options.follow && (options.incremental || !what_if_path.empty())) {
+    //inputs are hashed (incremental) or indexed (what-if) only once complete
+    std::cerr << "ERR: --follow can't be used with --incremental or --what-if" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!options.ranges.empty() && what_if_path.empty()) {
+    std::cerr << "ERR: --ranges requires --what-if" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if ((options.sample_rate < 1) && options.incremental) {
+    //the sampling stats are only known for the stages that run
+    std::cerr << "ERR: --sample-rate can't be used with --incremental" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (options.roi && options.follow) {
+    //the netstate is followed before the network (the lanes in the region) is loaded
+    std::cerr << "ERR: --roi can't be used with --follow" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if ((options.dist_quantum > 0) && options.intervals) {
+    //intervals are built from the raw recognitions
+    std::cerr << "ERR: --quantize can't be used with --intervals" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (options.curve_step < 0) {
+    std::cerr << "ERR: curve step must not be negative" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!batch_path.empty()) {
+    //every scenario is processed from its bt output and netstate
+    if (!traci_host.empty() || !what_if_path.empty()) {
+      std::cerr << "ERR: --batch can't be used with --traci or --what-if" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (!is_file(net_input_path)) {
+      std::cerr << "ERR: network input file does not exist: " << net_input_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    //each manifest entry has its own inputs and output directory
+    return batch::process_batch(batch_path, net_input_path, options);
+  }
+
+  if (!traci_host.empty()) {
+    //the session replaces the bt output and netstate inputs
+    if (options.follow || options.incremental || !what_if_path.empty()) {
+      std::cerr << "ERR: --traci can't be used with --follow, --incremental or --what-if" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (options.range <= 0) {
+      std::cerr << "ERR: range must be positive" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (!is_file(net_input_path)) {
+      std::cerr << "ERR: network input file does not exist: " << net_input_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (!is_dir(output_path)) {
+      std::cerr << "ERR: output directory does not exist: " << output_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return process_traci_data(traci_host, traci_port, net_input_path, output_path, options);
+  }
+
+  if (!what_if_path.empty()) {
+    if (!is_file(what_if_path)) {
+      std::cerr << "ERR: tower positions file does not exist: " << what_if_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (options.range <= 0) {
+      std::cerr << "ERR: range must be positive" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  } else if (!options.follow && !is_file(bt_output_path)) {
     std::cerr << "ERR: bt output file does not exist: " << bt_output_path << std::endl;
     return EXIT_FAILURE;
   }
@@ -68,7 +412,8 @@ int main(int argc, char **argv) {
     return EXIT_FAILURE;
   }
 
-  if (!is_file(raw_output_path)) {
+  //followed outputs may not have been created yet
+  if (!options.follow && !is_file(raw_output_path)) {
     std::cerr << "ERR: simulation raw output file does not exist: " << raw_output_path << std::endl;
     return EXIT_FAILURE;
   }
@@ -78,6 +423,11 @@ int main(int argc, char **argv) {
     return EXIT_FAILURE;
   }
 
+  if (!what_if_path.empty()) {
+    //recompute recognitions from vehicle trajectories
+    return process_what_if_data(what_if_path, net_input_path, raw_output_path, output_path, options);
+  }
+
   //process the data and write to output file
-  return process_output_data(bt_output_path, net_input_path, raw_output_path, output_path);
+  return process_output_data(bt_output_path, net_input_path, raw_output_path, output_path, options);
 }
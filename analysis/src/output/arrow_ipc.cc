@@ -0,0 +1,504 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "arrow_ipc.h"
+#include <utility>
+#include <algorithm>
+#include <cstring>
+
+namespace output {
+
+  #define ARROW_MAGIC          "ARROW1"
+  #define ARROW_CONTINUATION   0xffffffff
+  #define ARROW_ALIGNMENT      8
+
+  //Schema.fbs / Message.fbs / File.fbs values
+  #define METADATA_V5          4
+  #define HEADER_SCHEMA        1
+  #define HEADER_DICTIONARY    2
+  #define HEADER_RECORD_BATCH  3
+  #define TYPE_INT             2
+  #define TYPE_FLOATING_POINT  3
+  #define TYPE_UTF8            5
+  #define PRECISION_DOUBLE     2
+
+  /**
+   * Round up to the arrow buffer alignment
+   * @param  len the length
+   * @return     the padded length
+   */
+  inline uint64_t pad_length(uint64_t len) {
+    return (len + ARROW_ALIGNMENT - 1) & ~((uint64_t) ARROW_ALIGNMENT - 1);
+  }
+
+  /*
+   * Minimal flatbuffer builder (built back to front like the flatbuffers library:
+   * objects are referred to by their distance from the end of the buffer, and
+   * children are built before the tables that refer to them)
+   */
+  struct fb_builder_t {
+  private:
+    //the buffer, reversed
+    std::vector<uint8_t> rev;
+    //fields of the open table (field id, reference)
+    std::vector<std::pair<int,uint32_t>> fields;
+    //size when the open table was started
+    uint32_t table_end = 0;
+
+    /**
+     * Pad so that after prepending bytes the size is aligned
+     * @param bytes     the size to be prepended
+     * @param alignment the alignment
+     */
+    void pre_align(size_t bytes, size_t alignment) {
+      while ((this->rev.size() + bytes) % alignment) {
+        this->rev.push_back(0);
+      }
+    }
+
+    /**
+     * Prepend raw bytes
+     * @param data the bytes
+     * @param len  the length
+     */
+    void put(const void *data, size_t len) {
+      const uint8_t *bytes = static_cast<const uint8_t*>(data);
+      for (size_t i=len; i>0; i--) {
+        this->rev.push_back(bytes[i - 1]);
+      }
+    }
+
+    /**
+     * Prepend an aligned scalar
+     * @param value the value
+     */
+    template<typename T>
+    void prepend(T value) {
+      this->pre_align(sizeof(T), sizeof(T));
+      this->put(&value, sizeof(T));
+    }
+
+    /**
+     * Prepend an offset to an object built earlier
+     * @param ref the object
+     */
+    void prepend_offset(uint32_t ref) {
+      this->pre_align(sizeof(uint32_t), sizeof(uint32_t));
+      uint32_t value = this->size() + sizeof(uint32_t) - ref;
+      this->put(&value, sizeof(uint32_t));
+    }
+
+  public:
+    /**
+     * @return the current size (the reference of the last object)
+     */
+    uint32_t size() const {
+      return (uint32_t) this->rev.size();
+    }
+
+    /**
+     * Start a table (no other objects can be built until it ends)
+     */
+    void start_table() {
+      this->fields.clear();
+      this->table_end = this->size();
+    }
+
+    /**
+     * Add a scalar field to the open table
+     * @param id    the field id
+     * @param value the value
+     */
+    template<typename T>
+    void add_scalar(int id, T value) {
+      this->prepend(value);
+      this->fields.emplace_back(id, this->size());
+    }
+
+    /**
+     * Add an offset field (table, vector or string) to the open table
+     * @param id  the field id
+     * @param ref the object
+     */
+    void add_offset(int id, uint32_t ref) {
+      this->prepend_offset(ref);
+      this->fields.emplace_back(id, this->size());
+    }
+
+    /**
+     * End the open table (the vtable is written directly before it)
+     * @return the table
+     */
+    uint32_t end_table() {
+      int count = 0;
+      for (const std::pair<int,uint32_t>& field : this->fields) {
+        count = std::max(count, field.first + 1);
+      }
+
+      uint16_t vtable_size = (uint16_t) (2 * sizeof(uint16_t) + count * sizeof(uint16_t));
+      this->prepend<int32_t>(vtable_size);
+      uint32_t table = this->size();
+
+      std::vector<uint16_t> offsets(count, 0);
+      for (const std::pair<int,uint32_t>& field : this->fields) {
+        offsets[field.first] = (uint16_t) (table - field.second);
+      }
+      for (int i=count; i>0; i--) {
+        this->put(&offsets[i - 1], sizeof(uint16_t));
+      }
+
+      uint16_t inline_size = (uint16_t) (table - this->table_end);
+      this->put(&inline_size, sizeof(uint16_t));
+      this->put(&vtable_size, sizeof(uint16_t));
+      return table;
+    }
+
+    /**
+     * Create a string
+     * @param  value the string
+     * @return       the string object
+     */
+    uint32_t create_string(const std::string& value) {
+      this->pre_align(value.size() + 1, sizeof(uint32_t));
+      this->rev.push_back(0);
+      this->put(value.data(), value.size());
+      this->prepend<uint32_t>((uint32_t) value.size());
+      return this->size();
+    }
+
+    /**
+     * Create a vector of offsets (tables)
+     * @param  refs the objects
+     * @return      the vector
+     */
+    uint32_t create_offset_vector(const std::vector<uint32_t>& refs) {
+      this->pre_align(refs.size() * sizeof(uint32_t), sizeof(uint32_t));
+      for (size_t i=refs.size(); i>0; i--) {
+        this->prepend_offset(refs[i - 1]);
+      }
+      this->prepend<uint32_t>((uint32_t) refs.size());
+      return this->size();
+    }
+
+    /**
+     * Create a vector of structs made of 8 byte words (Buffer, FieldNode, Block)
+     * @param  words       the struct fields
+     * @param  struct_size the words in each struct
+     * @return             the vector
+     */
+    uint32_t create_struct_vector(const std::vector<int64_t>& words, size_t struct_size) {
+      this->pre_align(words.size() * sizeof(int64_t), sizeof(int64_t));
+      for (size_t i=words.size(); i>0; i--) {
+        this->put(&words[i - 1], sizeof(int64_t));
+      }
+      this->prepend<uint32_t>((uint32_t) (words.size() / struct_size));
+      return this->size();
+    }
+
+    /**
+     * Finish the buffer
+     * @param  root the root table
+     * @return      the buffer (size a multiple of 8)
+     */
+    std::string finish(uint32_t root) {
+      this->pre_align(sizeof(uint32_t), ARROW_ALIGNMENT);
+      this->prepend_offset(root);
+      return std::string(this->rev.rbegin(), this->rev.rend());
+    }
+  };
+
+  /**
+   * Build a 32 bit signed Int type table
+   * @param  fb the builder
+   * @return    the table
+   */
+  uint32_t build_int32_type(fb_builder_t& fb) {
+    fb.start_table();
+    fb.add_scalar<int32_t>(0, 32);
+    fb.add_scalar<uint8_t>(1, 1);
+    return fb.end_table();
+  }
+
+  /**
+   * Build the schema table
+   * @param  fb     the builder
+   * @param  fields the columns
+   * @return        the table
+   */
+  uint32_t build_schema(fb_builder_t& fb, const std::vector<arrow_field_t>& fields) {
+    std::vector<uint32_t> field_refs;
+
+    for (size_t i=0; i<fields.size(); i++) {
+      const arrow_field_t& field = fields[i];
+      uint32_t name = fb.create_string(field.name);
+      uint32_t children = fb.create_offset_vector({});
+      uint32_t type = 0;
+      uint32_t dictionary = 0;
+      uint8_t type_type = TYPE_INT;
+
+      if (field.type == ARROW_FLOAT64) {
+        fb.start_table();
+        fb.add_scalar<int16_t>(0, PRECISION_DOUBLE);
+        type = fb.end_table();
+        type_type = TYPE_FLOATING_POINT;
+
+      } else if (field.type == ARROW_DICTIONARY) {
+        //Utf8 (no fields)
+        fb.start_table();
+        type = fb.end_table();
+        type_type = TYPE_UTF8;
+
+        //DictionaryEncoding: id, indexType
+        uint32_t index_type = build_int32_type(fb);
+        fb.start_table();
+        fb.add_scalar<int64_t>(0, (int64_t) i);
+        fb.add_offset(1, index_type);
+        dictionary = fb.end_table();
+
+      } else {
+        type = build_int32_type(fb);
+      }
+
+      //Field: name, nullable, type_type, type, dictionary, children
+      fb.start_table();
+      fb.add_offset(0, name);
+      fb.add_offset(3, type);
+      if (dictionary) {
+        fb.add_offset(4, dictionary);
+      }
+      fb.add_offset(5, children);
+      fb.add_scalar<uint8_t>(1, 0);
+      fb.add_scalar<uint8_t>(2, type_type);
+      field_refs.push_back(fb.end_table());
+    }
+
+    uint32_t field_vector = fb.create_offset_vector(field_refs);
+
+    //Schema: endianness (little), fields
+    fb.start_table();
+    fb.add_offset(1, field_vector);
+    fb.add_scalar<int16_t>(0, 0);
+    return fb.end_table();
+  }
+
+  /**
+   * Build a record batch table
+   * @param  fb      the builder
+   * @param  rows    the number of rows
+   * @param  columns the number of columns (one field node each)
+   * @param  buffers the body buffers (offset, length pairs)
+   * @return         the table
+   */
+  uint32_t build_record_batch(fb_builder_t& fb, size_t rows, size_t columns, const std::vector<int64_t>& buffers) {
+    std::vector<int64_t> node_words;
+    for (size_t i=0; i<columns; i++) {
+      //length, null count
+      node_words.push_back((int64_t) rows);
+      node_words.push_back(0);
+    }
+
+    uint32_t nodes = fb.create_struct_vector(node_words, 2);
+    uint32_t buffer_vector = fb.create_struct_vector(buffers, 2);
+
+    //RecordBatch: length, nodes, buffers
+    fb.start_table();
+    fb.add_scalar<int64_t>(0, (int64_t) rows);
+    fb.add_offset(1, nodes);
+    fb.add_offset(2, buffer_vector);
+    return fb.end_table();
+  }
+
+  /**
+   * Build a message
+   * @param  fb          the builder
+   * @param  header_type the message header type
+   * @param  header      the header table
+   * @param  body_length the body length
+   * @return             the flatbuffer
+   */
+  std::string build_message(fb_builder_t& fb, uint8_t header_type, uint32_t header, uint64_t body_length) {
+    //Message: version, header_type, header, bodyLength
+    fb.start_table();
+    fb.add_scalar<int64_t>(3, (int64_t) body_length);
+    fb.add_offset(2, header);
+    fb.add_scalar<int16_t>(0, METADATA_V5);
+    fb.add_scalar<uint8_t>(1, header_type);
+    return fb.finish(fb.end_table());
+  }
+
+  /**
+   * Get the body layout of buffers (offset, length pairs, 8 byte aligned)
+   * @param  buffers the buffers
+   * @param  length  the body length
+   * @return         the layout
+   */
+  std::vector<int64_t> buffer_layout(const std::vector<std::string_view>& buffers, uint64_t& length) {
+    std::vector<int64_t> layout;
+    length = 0;
+    for (const std::string_view& buffer : buffers) {
+      layout.push_back((int64_t) length);
+      layout.push_back((int64_t) buffer.size());
+      length += pad_length(buffer.size());
+    }
+    return layout;
+  }
+
+  /**
+   * Constructor: open the file and write the schema
+   * @param path   the path to write to
+   * @param fields the columns
+   */
+  arrow_file_t::arrow_file_t(const std::string& path, const std::vector<arrow_field_t>& fields)
+    : path(path),
+      file(path, std::ios::binary),
+      fields(fields),
+      offset(0) {
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "arrow output is little endian");
+
+    const char magic[ARROW_ALIGNMENT] = ARROW_MAGIC;
+    this->write_raw(magic, sizeof(magic));
+
+    fb_builder_t fb;
+    uint32_t schema = build_schema(fb, this->fields);
+    this->write_message(build_message(fb, HEADER_SCHEMA, schema, 0), {});
+  }
+
+  /**
+   * Write bytes to the file
+   * @param data the data
+   * @param len  the length
+   */
+  void arrow_file_t::write_raw(const void *data, size_t len) {
+    this->file.write(static_cast<const char*>(data), len);
+    this->offset += len;
+  }
+
+  /**
+   * Write an encapsulated message (metadata and body buffers)
+   * @param  metadata the flatbuffer message
+   * @param  buffers  the body buffers (each padded to 8 bytes)
+   * @return          the block of the message
+   */
+  arrow_block_t arrow_file_t::write_message(const std::string& metadata,
+                                            const std::vector<std::string_view>& buffers) {
+    static const char padding[ARROW_ALIGNMENT] = {0};
+    arrow_block_t block = {this->offset, 0, 0};
+
+    //continuation, metadata length (padded so the body starts aligned)
+    uint32_t continuation = ARROW_CONTINUATION;
+    int32_t metadata_length = (int32_t) (pad_length(2 * sizeof(uint32_t) + metadata.size()) - 2 * sizeof(uint32_t));
+    this->write_raw(&continuation, sizeof(continuation));
+    this->write_raw(&metadata_length, sizeof(metadata_length));
+    this->write_raw(metadata.data(), metadata.size());
+    this->write_raw(padding, metadata_length - metadata.size());
+    block.metadata_length = 2 * sizeof(uint32_t) + metadata_length;
+
+    for (const std::string_view& buffer : buffers) {
+      this->write_raw(buffer.data(), buffer.size());
+      this->write_raw(padding, pad_length(buffer.size()) - buffer.size());
+      block.body_length += pad_length(buffer.size());
+    }
+    return block;
+  }
+
+  /**
+   * Write the dictionary of a dictionary column (before any record batch)
+   * @param field  the column index
+   * @param values the dictionary values (indexed by the column)
+   */
+  void arrow_file_t::write_dictionary(size_t field, const std::vector<std::string_view>& values) {
+    std::vector<int32_t> offsets = {0};
+    std::string data;
+    for (const std::string_view& value : values) {
+      data.append(value);
+      offsets.push_back((int32_t) data.size());
+    }
+
+    //validity (none), offsets, data
+    std::vector<std::string_view> buffers = {
+      std::string_view(),
+      std::string_view(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(int32_t)),
+      std::string_view(data)
+    };
+    uint64_t body_length = 0;
+    std::vector<int64_t> layout = buffer_layout(buffers, body_length);
+
+    fb_builder_t fb;
+    uint32_t batch = build_record_batch(fb, values.size(), 1, layout);
+
+    //DictionaryBatch: id, data
+    fb.start_table();
+    fb.add_scalar<int64_t>(0, (int64_t) field);
+    fb.add_offset(1, batch);
+    uint32_t dictionary = fb.end_table();
+
+    this->dictionary_blocks.push_back(
+      this->write_message(build_message(fb, HEADER_DICTIONARY, dictionary, body_length), buffers));
+  }
+
+  /**
+   * Write a record batch
+   * @param rows    the number of rows
+   * @param columns the column values (int32_t, double or int32_t indices by field type)
+   */
+  void arrow_file_t::write_batch(size_t rows, const std::vector<const void*>& columns) {
+    std::vector<std::string_view> buffers;
+    for (size_t i=0; i<this->fields.size(); i++) {
+      size_t width = (this->fields[i].type == ARROW_FLOAT64) ? sizeof(double) : sizeof(int32_t);
+      //validity (none), values
+      buffers.push_back(std::string_view());
+      buffers.push_back(std::string_view(static_cast<const char*>(columns[i]), rows * width));
+    }
+    uint64_t body_length = 0;
+    std::vector<int64_t> layout = buffer_layout(buffers, body_length);
+
+    fb_builder_t fb;
+    uint32_t batch = build_record_batch(fb, rows, this->fields.size(), layout);
+
+    this->batch_blocks.push_back(
+      this->write_message(build_message(fb, HEADER_RECORD_BATCH, batch, body_length), buffers));
+  }
+
+  /**
+   * Write the footer and close the file
+   * @return success or failure
+   */
+  bool arrow_file_t::close() {
+    //end of stream
+    const uint32_t eos[2] = {ARROW_CONTINUATION, 0};
+    this->write_raw(eos, sizeof(eos));
+
+    //Block: offset, metaDataLength (padded to 8 bytes), bodyLength
+    auto block_words = [](const std::vector<arrow_block_t>& blocks) {
+      std::vector<int64_t> words;
+      for (const arrow_block_t& block : blocks) {
+        words.push_back((int64_t) block.offset);
+        words.push_back((int64_t) block.metadata_length);
+        words.push_back((int64_t) block.body_length);
+      }
+      return words;
+    };
+
+    fb_builder_t fb;
+    uint32_t schema = build_schema(fb, this->fields);
+    uint32_t dictionaries = fb.create_struct_vector(block_words(this->dictionary_blocks), 3);
+    uint32_t batches = fb.create_struct_vector(block_words(this->batch_blocks), 3);
+
+    //Footer: version, schema, dictionaries, recordBatches
+    fb.start_table();
+    fb.add_offset(1, schema);
+    fb.add_offset(2, dictionaries);
+    fb.add_offset(3, batches);
+    fb.add_scalar<int16_t>(0, METADATA_V5);
+    std::string footer = fb.finish(fb.end_table());
+
+    int32_t footer_length = (int32_t) footer.size();
+    this->write_raw(footer.data(), footer.size());
+    this->write_raw(&footer_length, sizeof(footer_length));
+    this->write_raw(ARROW_MAGIC, strlen(ARROW_MAGIC));
+
+    this->file.close();
+    return !this->file.fail();
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _ARROW_IPC_H
+#define _ARROW_IPC_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+namespace output {
+
+  /*
+   * Column types supported by the arrow writer
+   */
+  enum arrow_type_t {
+    ARROW_INT32      = 0,
+    ARROW_FLOAT64    = 1,
+    //utf8 values, int32 indices into a dictionary
+    ARROW_DICTIONARY = 2
+  };
+
+  /*
+   * A column of the arrow schema (not nullable)
+   */
+  struct arrow_field_t {
+    std::string name;
+    arrow_type_t type;
+  };
+
+  /*
+   * A message in the arrow file (footer entry)
+   */
+  struct arrow_block_t {
+    uint64_t offset;
+    uint32_t metadata_length;
+    uint64_t body_length;
+  };
+
+  /*
+   * Arrow IPC file (Feather v2) writer without the arrow libraries: the schema,
+   * one dictionary batch per dictionary column, record batches and the footer,
+   * with the flatbuffer metadata built by hand. Buffers are little endian and
+   * 8 byte aligned so readers can memory map the file
+   */
+  struct arrow_file_t {
+  private:
+    std::string path;
+    std::ofstream file;
+    std::vector<arrow_field_t> fields;
+    //file offset
+    uint64_t offset;
+    std::vector<arrow_block_t> dictionary_blocks;
+    std::vector<arrow_block_t> batch_blocks;
+
+    /**
+     * Write bytes to the file
+     * @param data the data
+     * @param len  the length
+     */
+    void write_raw(const void *data, size_t len);
+
+    /**
+     * Write an encapsulated message (metadata and body buffers)
+     * @param  metadata the flatbuffer message
+     * @param  buffers  the body buffers (each padded to 8 bytes)
+     * @return          the block of the message
+     */
+    arrow_block_t write_message(const std::string& metadata,
+                                const std::vector<std::string_view>& buffers);
+
+  public:
+    /**
+     * Constructor: open the file and write the schema
+     * @param path   the path to write to
+     * @param fields the columns
+     */
+    arrow_file_t(const std::string& path, const std::vector<arrow_field_t>& fields);
+
+    //no copy
+    arrow_file_t(const arrow_file_t&) = delete;
+    arrow_file_t& operator=(const arrow_file_t&) = delete;
+
+    /**
+     * Write the dictionary of a dictionary column (before any record batch)
+     * @param field  the column index
+     * @param values the dictionary values (indexed by the column)
+     */
+    void write_dictionary(size_t field, const std::vector<std::string_view>& values);
+
+    /**
+     * Write a record batch
+     * @param rows    the number of rows
+     * @param columns the column values (int32_t, double or int32_t indices by field type)
+     */
+    void write_batch(size_t rows, const std::vector<const void*>& columns);
+
+    /**
+     * Write the footer and close the file
+     * @return success or failure
+     */
+    [[nodiscard]] bool close();
+
+    /**
+     * Get the path written to
+     * @return the path
+     */
+    const std::string& get_path() const { return this->path; }
+  };
+}
+
+#endif /*_ARROW_IPC_H*/
@@ -0,0 +1,195 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "arrow_output.h"
+#include "arrow_ipc.h"
+#include "render_output.h"
+#include <unordered_map>
+#include <string_view>
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+
+namespace output {
+
+  //rows in each record batch
+  #define ARROW_BATCH_ROWS (1 << 20)
+
+  /**
+   * Write the tower recognitions as an arrow table (tower, ts, vehicle, dist)
+   * @see docs/output.md
+   * @param  out_dir_path       the directory to write output to
+   * @param  tower_recognitions tower recognitions map
+   * @param  vehicles           a set of unique vehicle ids
+   * @return the status
+   */
+  int write_recognitions_arrow(const std::string& out_dir_path,
+                               const types::tower_recognitions_map_t& tower_recognitions,
+                               const types::id_set_t& vehicles) {
+    arrow_file_t out_file(join(out_dir_path, RECOGNITIONS_ARROW_FILENAME), {
+      {"tower", ARROW_DICTIONARY},
+      {"ts", ARROW_INT32},
+      {"vehicle", ARROW_DICTIONARY},
+      {"dist", ARROW_FLOAT64}
+    });
+
+    //dictionaries (vehicles indexed as in the tower output)
+    std::vector<std::string_view> tower_ids;
+    for (const auto& tower : tower_recognitions) {
+      tower_ids.push_back(tower.first);
+    }
+
+    std::vector<std::string_view> vehicle_ids;
+    std::unordered_map<std::string_view,int32_t> vehicle_index;
+    for (const std::pmr::string& vehicle_id : vehicles) {
+      vehicle_index.emplace(vehicle_id, (int32_t) vehicle_ids.size());
+      vehicle_ids.push_back(vehicle_id);
+    }
+
+    out_file.write_dictionary(0, tower_ids);
+    out_file.write_dictionary(2, vehicle_ids);
+
+    std::vector<int32_t> tower_col, ts_col, vehicle_col;
+    std::vector<double> dist_col;
+
+    auto flush = [&]() {
+      if (!tower_col.empty()) {
+        out_file.write_batch(tower_col.size(), {tower_col.data(), ts_col.data(), vehicle_col.data(), dist_col.data()});
+        tower_col.clear();
+        ts_col.clear();
+        vehicle_col.clear();
+        dist_col.clear();
+      }
+    };
+
+    int32_t tower_idx = 0;
+    for (const auto& tower : tower_recognitions) {
+      tower.second.expand([&](int ts, const std::pmr::string& vehicle_id, double dist) {
+        std::unordered_map<std::string_view,int32_t>::const_iterator it = vehicle_index.find(vehicle_id);
+        if (it == vehicle_index.end()) {
+          return;
+        }
+
+        tower_col.push_back(tower_idx);
+        ts_col.push_back(ts);
+        vehicle_col.push_back(it->second);
+        dist_col.push_back(dist);
+
+        if (tower_col.size() >= ARROW_BATCH_ROWS) {
+          flush();
+        }
+      });
+      tower_idx++;
+    }
+    flush();
+
+    if (!out_file.close()) {
+      std::cerr << "ERR: failed to write recognitions arrow output to file: " << out_file.get_path() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cerr << "INFO: wrote recognitions arrow output to: " << out_file.get_path() << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  /**
+   * Write the vehicle segment history as an arrow table (vehicle, ts, segment, first_seen)
+   * @see docs/output.md
+   * @param  out_dir_path      the directory to write output to
+   * @param  vehicle_lane_hist lanes seen by each vehicle
+   * @param  edges             all edges in the simulation
+   * @param  timesteps         all timesteps in the simulation
+   * @return the status
+   */
+  int write_vehicle_history_arrow(const std::string& out_dir_path,
+                                  const types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                                  const types::id_set_t& edges,
+                                  const types::id_set_t& timesteps) {
+    arrow_file_t out_file(join(out_dir_path, VEHICLE_HIST_ARROW_FILENAME), {
+      {"vehicle", ARROW_DICTIONARY},
+      {"ts", ARROW_INT32},
+      {"segment", ARROW_DICTIONARY},
+      {"first_seen", ARROW_INT32}
+    });
+
+    //dictionaries (segments indexed as in the vehicle output)
+    std::vector<std::string_view> vehicle_ids;
+    for (const auto& vehicle : vehicle_lane_hist) {
+      vehicle_ids.push_back(vehicle.first);
+    }
+
+    std::vector<std::string_view> segment_ids;
+    std::unordered_map<std::string_view,int32_t> segment_index;
+    for (const std::pmr::string& edge_id : edges) {
+      segment_index.emplace(edge_id, (int32_t) segment_ids.size());
+      segment_ids.push_back(edge_id);
+    }
+
+    out_file.write_dictionary(0, vehicle_ids);
+    out_file.write_dictionary(2, segment_ids);
+
+    //timesteps in numeric order
+    std::vector<int> ts;
+    for (const std::pmr::string& ts_s : timesteps) {
+      ts.push_back(atoi(ts_s.c_str()));
+    }
+    std::sort(ts.begin(), ts.end());
+
+    std::vector<int32_t> vehicle_col, ts_col, segment_col, first_seen_col;
+
+    auto flush = [&]() {
+      if (!vehicle_col.empty()) {
+        out_file.write_batch(vehicle_col.size(), {vehicle_col.data(), ts_col.data(), segment_col.data(), first_seen_col.data()});
+        vehicle_col.clear();
+        ts_col.clear();
+        segment_col.clear();
+        first_seen_col.clear();
+      }
+    };
+
+    int32_t vehicle_idx = 0;
+    std::vector<std::pair<int,int32_t>> seen;
+
+    for (const auto& vehicle : vehicle_lane_hist) {
+      //(first timestep, segment) in the order the vehicle reached them
+      seen.clear();
+      for (const auto& segment : vehicle.second.first_seen()) {
+        std::unordered_map<std::string_view,int32_t>::const_iterator it = segment_index.find(segment.first);
+        if (it != segment_index.end()) {
+          seen.emplace_back(segment.second, it->second);
+        }
+      }
+      std::sort(seen.begin(), seen.end());
+
+      //every segment reached by each timestep (as in the vehicle output)
+      size_t reached = 0;
+      for (int timestep : ts) {
+        while ((reached < seen.size()) && (seen[reached].first <= timestep)) {
+          reached++;
+        }
+
+        for (size_t i=0; i<reached; i++) {
+          vehicle_col.push_back(vehicle_idx);
+          ts_col.push_back(timestep);
+          segment_col.push_back(seen[i].second);
+          first_seen_col.push_back(seen[i].first);
+
+          if (vehicle_col.size() >= ARROW_BATCH_ROWS) {
+            flush();
+          }
+        }
+      }
+      vehicle_idx++;
+    }
+    flush();
+
+    if (!out_file.close()) {
+      std::cerr << "ERR: failed to write vehicle history arrow output to file: " << out_file.get_path() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cerr << "INFO: wrote vehicle history arrow output to: " << out_file.get_path() << std::endl;
+    return EXIT_SUCCESS;
+  }
+}
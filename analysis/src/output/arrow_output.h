@@ -0,0 +1,45 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _ARROW_OUTPUT_H
+#define _ARROW_OUTPUT_H
+
+#include <string>
+#include "../types/tower_recognitions.h"
+#include "../types/vehicle_lane_hist.h"
+#include "../types/arena.h"
+
+namespace output {
+
+  #define RECOGNITIONS_ARROW_FILENAME "tower_recognitions.arrow"
+  #define VEHICLE_HIST_ARROW_FILENAME "vehicle_history.arrow"
+
+  /**
+   * Write the tower recognitions as an arrow table (tower, ts, vehicle, dist)
+   * @see docs/output.md
+   * @param  out_dir_path       the directory to write output to
+   * @param  tower_recognitions tower recognitions map
+   * @param  vehicles           a set of unique vehicle ids
+   * @return the status
+   */
+  int write_recognitions_arrow(const std::string& out_dir_path,
+                               const types::tower_recognitions_map_t& tower_recognitions,
+                               const types::id_set_t& vehicles);
+
+  /**
+   * Write the vehicle segment history as an arrow table (vehicle, ts, segment, first_seen)
+   * @see docs/output.md
+   * @param  out_dir_path      the directory to write output to
+   * @param  vehicle_lane_hist lanes seen by each vehicle
+   * @param  edges             all edges in the simulation
+   * @param  timesteps         all timesteps in the simulation
+   * @return the status
+   */
+  int write_vehicle_history_arrow(const std::string& out_dir_path,
+                                  const types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                                  const types::id_set_t& edges,
+                                  const types::id_set_t& timesteps);
+}
+
+#endif /*_ARROW_OUTPUT_H*/
@@ -0,0 +1,83 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "handoff_output.h"
+#include "render_output.h"
+#include "output_file.h"
+#include <json.hpp>
+#include <iostream>
+#include <exception>
+#include <algorithm>
+
+namespace output {
+
+  typedef nlohmann::json json_t;
+
+  /**
+   * Write the tower handoff graph (adjacency lists, most likely next tower first)
+   * @see docs/output.md
+   * @param  out_dir_path the directory to write output to
+   * @param  graph        the handoff graph
+   * @return the status
+   */
+  int write_handoff_output(const std::string& out_dir_path,
+                           const handoff::handoff_graph_t& graph) {
+    json_t out_obj = json_t::object();
+    out_obj["towers"] = graph.tower_ids;
+
+    //lower bound of each histogram bucket
+    json_t bounds = json_t::array({0});
+    for (size_t k=1; k<HANDOFF_BUCKETS; k++) {
+      bounds.push_back(1 << (k - 1));
+    }
+    out_obj["histogram_bounds"] = bounds;
+    out_obj["handoffs"] = json_t::array();
+
+    for (const handoff::tower_handoffs_t& tower : graph.towers) {
+      //most likely next tower first
+      std::vector<std::pair<uint32_t,const handoff::handoff_edge_t*>> next;
+      for (const std::pair<const uint32_t,handoff::handoff_edge_t>& edge : tower.next) {
+        next.emplace_back(edge.first, &edge.second);
+      }
+      std::sort(next.begin(), next.end(), [] (const auto& a, const auto& b) {
+        return (a.second->count != b.second->count) ? (a.second->count > b.second->count) : (a.first < b.first);
+      });
+
+      json_t elem = json_t::object();
+      elem["departures"] = tower.departures;
+      elem["exits"] = tower.exits;
+      elem["next"] = json_t::array();
+
+      for (const std::pair<uint32_t,const handoff::handoff_edge_t*>& edge : next) {
+        elem["next"].push_back({
+          edge.first,
+          edge.second->count,
+          (double) edge.second->count / tower.departures,
+          (double) edge.second->gap_sum / edge.second->count,
+          std::vector<uint64_t>(edge.second->histogram, edge.second->histogram + HANDOFF_BUCKETS)
+        });
+      }
+      out_obj["handoffs"].push_back(elem);
+    }
+
+    //write to the file
+    try {
+      output_file_t out_file(out_dir_path, HANDOFF_FILENAME);
+      out_file.write(out_obj);
+
+      if (!out_file.close()) {
+        std::cerr << "ERR: failed to write tower handoff output to file: " << out_file.get_path() << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      std::cerr << "INFO: wrote tower handoff output to: " << out_file.get_path() << std::endl;
+
+    } catch (const std::exception& e) {
+      std::cerr << "ERR: failed to write tower handoff output to file: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  }
+}
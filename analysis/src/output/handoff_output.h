@@ -0,0 +1,26 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _HANDOFF_OUTPUT_H
+#define _HANDOFF_OUTPUT_H
+
+#include <string>
+#include "../handoff/handoff_graph.h"
+
+namespace output {
+
+  #define HANDOFF_FILENAME "tower_handoff_output.json"
+
+  /**
+   * Write the tower handoff graph (adjacency lists, most likely next tower first)
+   * @see docs/output.md
+   * @param  out_dir_path the directory to write output to
+   * @param  graph        the handoff graph
+   * @return the status
+   */
+  int write_handoff_output(const std::string& out_dir_path,
+                           const handoff::handoff_graph_t& graph);
+}
+
+#endif /*_HANDOFF_OUTPUT_H*/
@@ -0,0 +1,99 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "interval_output.h"
+#include "render_output.h"
+#include "output_file.h"
+#include <json.hpp>
+#include <iostream>
+#include <exception>
+#include <unordered_map>
+
+namespace output {
+
+  typedef nlohmann::json json_t;
+
+  /**
+   * Write the tower contact interval output format
+   * @see docs/output.md
+   * @param  out_dir_path       path to the output directory
+   * @param  tower_recognitions tower recognitions map (stored as intervals)
+   * @param  vehicles           a set of unique vehicle ids
+   * @return the status
+   */
+  int write_tower_interval_output(const std::string& out_dir_path,
+                                  const types::tower_recognitions_map_t& tower_recognitions,
+                                  const types::id_set_t& vehicles) {
+    json_t out_obj = json_t::object();
+    out_obj["vehicles"] = json_t::array();
+    out_obj["towers"] = json_t::array();
+
+    //index in the vehicle list
+    std::unordered_map<std::string_view,size_t> vehicle_index;
+    for (const std::pmr::string& vehicle_id : vehicles) {
+      vehicle_index.emplace(vehicle_id, vehicle_index.size());
+      out_obj["vehicles"].push_back(std::string(vehicle_id));
+    }
+
+    int curve_step = 0;
+
+    for (const std::pair<const std::pmr::string,types::tower_recognitions_t>& tower : tower_recognitions) {
+      json_t elem = json_t::object();
+      elem["tower_id"] = std::string(tower.first);
+      elem["intervals"] = json_t::array();
+      curve_step = tower.second.get_curve_step();
+
+      if (curve_step > 0) {
+        elem["curves"] = json_t::array();
+      }
+
+      for (const auto& vehicle : tower.second.contact_intervals()) {
+        size_t vidx = vehicle_index.at(vehicle.first);
+
+        for (const types::contact_interval_t& interval : vehicle.second) {
+          elem["intervals"].push_back({
+            vidx,
+            interval.start,
+            interval.end,
+            interval.min_dist,
+            interval.mean_dist(),
+            interval.max_dist
+          });
+
+          if (curve_step > 0) {
+            json_t curve(interval.curve);
+            //the end of the interval (interpolation target)
+            if ((interval.end - interval.start) % curve_step != 0) {
+              curve.push_back(interval.last_dist);
+            }
+            elem["curves"].push_back(curve);
+          }
+        }
+      }
+
+      out_obj["towers"].push_back(elem);
+    }
+
+    out_obj["curve_step"] = curve_step;
+
+    //write to the file
+    try {
+      output_file_t out_file(out_dir_path, TOWER_INTERVAL_FILENAME);
+      out_file.write(out_obj);
+
+      if (!out_file.close()) {
+        std::cerr << "ERR: failed to write tower interval output to file: " << out_file.get_path() << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      std::cerr << "INFO: wrote tower interval output to: " << out_file.get_path() << std::endl;
+
+    } catch (const std::exception& e) {
+      std::cerr << "ERR: failed to write tower interval output to file: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  }
+}
@@ -0,0 +1,29 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _INTERVAL_OUTPUT_H
+#define _INTERVAL_OUTPUT_H
+
+#include <string>
+#include "../types/tower_recognitions.h"
+#include "../types/arena.h"
+
+namespace output {
+
+  #define TOWER_INTERVAL_FILENAME "tower_interval_output.json"
+
+  /**
+   * Write the tower contact interval output format
+   * @see docs/output.md
+   * @param  out_dir_path       path to the output directory
+   * @param  tower_recognitions tower recognitions map (stored as intervals)
+   * @param  vehicles           a set of unique vehicle ids
+   * @return the status
+   */
+  int write_tower_interval_output(const std::string& out_dir_path,
+                                  const types::tower_recognitions_map_t& tower_recognitions,
+                                  const types::id_set_t& vehicles);
+}
+
+#endif /*_INTERVAL_OUTPUT_H*/
@@ -0,0 +1,130 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "load_output.h"
+#include "render_output.h"
+#include <json.hpp>
+#include <fstream>
+#include <iostream>
+#include <exception>
+#include <algorithm>
+#include <numeric>
+#include <stdint.h>
+
+namespace output {
+
+  typedef nlohmann::json json_t;
+
+  #define TOWER_LOAD_MAGIC            "SMLOAD01"
+  //towers listed as hotspots
+  #define HOTSPOT_COUNT               10
+
+  /**
+   * Write the load matrices
+   * @param  full_path  the file path
+   * @param  tower_load the load matrices
+   * @return            success or failure
+   */
+  bool write_load_matrices(const std::string& full_path, const load::tower_load_t& tower_load) {
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "tower load output is little endian");
+
+    std::ofstream out_file(full_path, std::ios::binary);
+    if (!out_file) {
+      return false;
+    }
+
+    uint32_t towers = tower_load.tower_ids.size();
+    uint32_t timesteps = tower_load.timesteps;
+    int32_t first_ts = tower_load.first_ts;
+
+    //header
+    out_file.write(TOWER_LOAD_MAGIC, 8);
+    out_file.write(reinterpret_cast<const char*>(&towers), sizeof(towers));
+    out_file.write(reinterpret_cast<const char*>(&timesteps), sizeof(timesteps));
+    out_file.write(reinterpret_cast<const char*>(&first_ts), sizeof(first_ts));
+
+    for (const std::string& tower_id : tower_load.tower_ids) {
+      uint16_t len = tower_id.size();
+      out_file.write(reinterpret_cast<const char*>(&len), sizeof(len));
+      out_file.write(tower_id.data(), len);
+    }
+
+    //matrices
+    out_file.write(reinterpret_cast<const char*>(tower_load.in_range.data()), tower_load.in_range.size() * sizeof(uint32_t));
+    out_file.write(reinterpret_cast<const char*>(tower_load.arrivals.data()), tower_load.arrivals.size() * sizeof(uint32_t));
+
+    out_file.close();
+    return (bool) out_file;
+  }
+
+  /**
+   * Write the binary tower load matrices and the load summary (percentiles, hotspots)
+   * @see docs/output.md
+   * @param  out_dir_path the directory to write output to
+   * @param  tower_load   the load matrices
+   * @return the status
+   */
+  int write_tower_load_output(const std::string& out_dir_path,
+                              const load::tower_load_t& tower_load) {
+    std::string matrix_path = join(out_dir_path, TOWER_LOAD_FILENAME);
+    if (!write_load_matrices(matrix_path, tower_load)) {
+      std::cerr << "ERR: failed to write tower load output to file: " << matrix_path << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cerr << "INFO: wrote tower load output to: " << matrix_path << std::endl;
+
+    std::vector<load::tower_load_summary_t> summaries;
+    load::summarize_tower_load(tower_load, summaries);
+
+    json_t out_obj = json_t::object();
+    out_obj["first_ts"] = tower_load.first_ts;
+    out_obj["timesteps"] = tower_load.timesteps;
+    out_obj["towers"] = json_t::array();
+
+    for (size_t t=0; t<summaries.size(); t++) {
+      const load::tower_load_summary_t& summary = summaries[t];
+      out_obj["towers"].push_back({
+        {"tower_id", tower_load.tower_ids[t]},
+        {"mean", summary.mean},
+        {"p50", summary.p50},
+        {"p90", summary.p90},
+        {"p95", summary.p95},
+        {"p99", summary.p99},
+        {"max", summary.max},
+        {"peak_ts", summary.peak_ts},
+        {"arrivals", summary.arrivals},
+        {"straggler_timesteps", summary.straggler_timesteps}
+      });
+    }
+
+    //busiest towers: most often the most loaded tower, then by p95
+    std::vector<size_t> order(summaries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&summaries] (size_t a, size_t b) {
+      if (summaries[a].straggler_timesteps != summaries[b].straggler_timesteps) {
+        return summaries[a].straggler_timesteps > summaries[b].straggler_timesteps;
+      }
+      return (summaries[a].p95 != summaries[b].p95) ? (summaries[a].p95 > summaries[b].p95) : (a < b);
+    });
+    order.resize(std::min(order.size(), (size_t) HOTSPOT_COUNT));
+    out_obj["hotspots"] = order;
+
+    //write to the file
+    try {
+      std::string full_path = join(out_dir_path, TOWER_LOAD_SUMMARY_FILENAME);
+
+      std::ofstream out_file(full_path);
+      out_file << out_obj.dump(2) << std::endl;
+      out_file.close();
+
+      std::cerr << "INFO: wrote tower load summary to: " << full_path << std::endl;
+
+    } catch (const std::exception& e) {
+      std::cerr << "ERR: failed to write tower load summary to file: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  }
+}
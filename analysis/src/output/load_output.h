@@ -0,0 +1,27 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _LOAD_OUTPUT_H
+#define _LOAD_OUTPUT_H
+
+#include <string>
+#include "../load/tower_load.h"
+
+namespace output {
+
+  #define TOWER_LOAD_FILENAME         "tower_load_output.bin"
+  #define TOWER_LOAD_SUMMARY_FILENAME "tower_load_summary.json"
+
+  /**
+   * Write the binary tower load matrices and the load summary (percentiles, hotspots)
+   * @see docs/output.md
+   * @param  out_dir_path the directory to write output to
+   * @param  tower_load   the load matrices
+   * @return the status
+   */
+  int write_tower_load_output(const std::string& out_dir_path,
+                              const load::tower_load_t& tower_load);
+}
+
+#endif /*_LOAD_OUTPUT_H*/
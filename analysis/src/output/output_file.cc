@@ -0,0 +1,519 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "output_file.h"
+#include "render_output.h"
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <streambuf>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <cstring>
+#include <stdint.h>
+
+namespace output {
+
+  #define BLOCK_INDEX_MAGIC "SMBIDX01"
+
+  //uncompressed block sizes (bgzf blocks must compress to at most 64KB)
+  #define GZIP_BLOCK_SIZE   0xff00
+  #define ZSTD_BLOCK_SIZE   (1 << 20)
+  #define GZIP_LEVEL        1
+  #define ZSTD_LEVEL        3
+  //blocks buffered (compressing or waiting to be written) per compression thread
+  #define BLOCKS_PER_THREAD 4
+
+  #define GZIP_HEADER_SIZE  18
+  #define GZIP_TRAILER_SIZE 8
+
+  //empty bgzf block marking the end of the file
+  static const unsigned char BGZF_EOF[] = {
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43,
+    0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+  };
+
+  //set once before outputs are written
+  static compression_t output_compression = COMPRESSION_NONE;
+  static format_t output_format = FORMAT_JSON;
+
+  /**
+   * Parse a format name (json, cbor or msgpack)
+   * @param  name   the name
+   * @param  format the parsed format
+   * @return        whether the name is a supported format
+   */
+  bool parse_format(const std::string& name, format_t& format) {
+    if (name == "json") {
+      format = FORMAT_JSON;
+    } else if (name == "cbor") {
+      format = FORMAT_CBOR;
+    } else if (name == "msgpack") {
+      format = FORMAT_MSGPACK;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Set the encoding of all json output files (before any are written)
+   * @param format the format
+   */
+  void set_format(format_t format) {
+    output_format = format;
+  }
+
+  /**
+   * Get the encoding of the json output files
+   * @return the format
+   */
+  format_t get_format() {
+    return output_format;
+  }
+
+  /**
+   * Parse a compression name (none, gzip or zstd if compiled in)
+   * @param  name        the name
+   * @param  compression the parsed compression
+   * @return             whether the name is a supported compression
+   */
+  bool parse_compression(const std::string& name, compression_t& compression) {
+    if (name == "none") {
+      compression = COMPRESSION_NONE;
+    } else if (name == "gzip") {
+      compression = COMPRESSION_GZIP;
+#ifdef HAVE_ZSTD
+    } else if (name == "zstd") {
+      compression = COMPRESSION_ZSTD;
+#endif
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Set the compression of all json output files (before any are written)
+   * @param compression the compression
+   */
+  void set_compression(compression_t compression) {
+    output_compression = compression;
+  }
+
+  /**
+   * Get the compression of the json output files
+   * @return the compression
+   */
+  compression_t get_compression() {
+    return output_compression;
+  }
+
+  /**
+   * Get the name an output is written as (with the format extension and compression suffix)
+   * @param  filename the output filename
+   * @return          the written filename
+   */
+  std::string output_filename(const std::string& filename) {
+    std::string name = filename;
+
+    //swap the .json extension for binary encodings
+    const size_t ext_len = strlen(JSON_EXTENSION);
+    if ((output_format != FORMAT_JSON) &&
+        (name.size() > ext_len) &&
+        (name.compare(name.size() - ext_len, ext_len, JSON_EXTENSION) == 0)) {
+      name.resize(name.size() - ext_len);
+      name += (output_format == FORMAT_CBOR) ? CBOR_EXTENSION : MSGPACK_EXTENSION;
+    }
+
+    switch (output_compression) {
+      case COMPRESSION_GZIP: return name + GZIP_SUFFIX;
+      case COMPRESSION_ZSTD: return name + ZSTD_SUFFIX;
+      default:               return name;
+    }
+  }
+
+  /**
+   * Write a little endian integer
+   * @param out   the destination
+   * @param value the value
+   * @param size  the size in bytes
+   */
+  inline void put_le(unsigned char *out, uint64_t value, size_t size) {
+    for (size_t i=0; i<size; i++) {
+      out[i] = (unsigned char) (value >> (8 * i));
+    }
+  }
+
+  /*
+   * A block of output (compressed by a worker)
+   */
+  struct block_job_t {
+    std::vector<char> raw;
+    std::vector<char> compressed;
+    bool done = false;
+    bool failed = false;
+  };
+
+  /*
+   * Stream buffer that cuts the output into blocks, compresses them on a thread
+   * pool and writes them to the file in order
+   */
+  struct block_writer_t : public std::streambuf {
+  private:
+    std::ofstream& file;
+    compression_t compression;
+    size_t block_size;
+    size_t max_blocks;
+    //the block being filled (the put area)
+    std::vector<char> block;
+
+    std::mutex lock;
+    std::condition_variable work_ready;
+    std::condition_variable block_done;
+    //blocks in output order, blocks waiting for a worker
+    std::deque<std::unique_ptr<block_job_t>> pending;
+    std::deque<block_job_t*> todo;
+    bool stopping;
+    bool failed;
+    std::vector<std::thread> workers;
+
+    //(compressed offset, uncompressed offset) of each block
+    std::vector<std::pair<uint64_t,uint64_t>> index;
+    uint64_t compressed_size;
+    uint64_t raw_size;
+
+    /**
+     * Compress blocks until stopped (worker thread)
+     */
+    void run() {
+      z_stream zs;
+      memset(&zs, 0, sizeof(zs));
+      bool ready = (this->compression != COMPRESSION_GZIP) ||
+                   (deflateInit2(&zs, GZIP_LEVEL, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+#ifdef HAVE_ZSTD
+      ZSTD_CCtx *cctx = (this->compression == COMPRESSION_ZSTD) ? ZSTD_createCCtx() : NULL;
+      ready = ready && ((this->compression != COMPRESSION_ZSTD) || cctx);
+#endif
+
+      while (true) {
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->work_ready.wait(guard, [this] { return this->stopping || !this->todo.empty(); });
+        if (this->todo.empty()) {
+          break;
+        }
+        block_job_t *job = this->todo.front();
+        this->todo.pop_front();
+        guard.unlock();
+
+        if (!ready) {
+          job->failed = true;
+        } else if (this->compression == COMPRESSION_GZIP) {
+          job->failed = !compress_gzip(zs, *job);
+#ifdef HAVE_ZSTD
+        } else {
+          job->failed = !compress_zstd(cctx, *job);
+#endif
+        }
+
+        guard.lock();
+        job->done = true;
+        this->block_done.notify_all();
+      }
+
+      if (this->compression == COMPRESSION_GZIP) {
+        deflateEnd(&zs);
+      }
+#ifdef HAVE_ZSTD
+      ZSTD_freeCCtx(cctx);
+#endif
+    }
+
+    /**
+     * Compress a block as a bgzf gzip member
+     * @param  zs  the worker's deflate stream
+     * @param  job the block
+     * @return     success or failure
+     */
+    static bool compress_gzip(z_stream& zs, block_job_t& job) {
+      deflateReset(&zs);
+      job.compressed.resize(GZIP_HEADER_SIZE + deflateBound(&zs, job.raw.size()) + GZIP_TRAILER_SIZE);
+      unsigned char *out = reinterpret_cast<unsigned char*>(job.compressed.data());
+
+      zs.next_in = reinterpret_cast<Bytef*>(job.raw.data());
+      zs.avail_in = job.raw.size();
+      zs.next_out = out + GZIP_HEADER_SIZE;
+      zs.avail_out = job.compressed.size() - GZIP_HEADER_SIZE - GZIP_TRAILER_SIZE;
+      if (deflate(&zs, Z_FINISH) != Z_STREAM_END) {
+        return false;
+      }
+
+      size_t size = GZIP_HEADER_SIZE + zs.total_out + GZIP_TRAILER_SIZE;
+      //gzip header with the bgzf extra field (block size - 1)
+      static const unsigned char header[] = {
+        0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00
+      };
+      memcpy(out, header, sizeof(header));
+      put_le(out + sizeof(header), size - 1, 2);
+
+      unsigned char *trailer = out + size - GZIP_TRAILER_SIZE;
+      put_le(trailer, crc32(crc32(0, Z_NULL, 0), reinterpret_cast<Bytef*>(job.raw.data()), job.raw.size()), 4);
+      put_le(trailer + 4, job.raw.size(), 4);
+
+      job.compressed.resize(size);
+      return true;
+    }
+
+#ifdef HAVE_ZSTD
+    /**
+     * Compress a block as a zstd frame
+     * @param  cctx the worker's compression context
+     * @param  job  the block
+     * @return      success or failure
+     */
+    static bool compress_zstd(ZSTD_CCtx *cctx, block_job_t& job) {
+      job.compressed.resize(ZSTD_compressBound(job.raw.size()));
+      size_t size = ZSTD_compressCCtx(cctx, job.compressed.data(), job.compressed.size(),
+                                      job.raw.data(), job.raw.size(), ZSTD_LEVEL);
+      if (ZSTD_isError(size)) {
+        return false;
+      }
+      job.compressed.resize(size);
+      return true;
+    }
+#endif
+
+    /**
+     * Write a compressed block to the file
+     * @param job the block
+     */
+    void write_block(const block_job_t& job) {
+      if (job.failed) {
+        this->failed = true;
+        return;
+      }
+
+      this->index.emplace_back(this->compressed_size, this->raw_size);
+      this->file.write(job.compressed.data(), job.compressed.size());
+      this->compressed_size += job.compressed.size();
+      this->raw_size += job.raw.size();
+    }
+
+    /**
+     * Write compressed blocks in order
+     * @param all whether to wait for every block (otherwise only while too many are buffered)
+     */
+    void write_blocks(bool all) {
+      std::unique_lock<std::mutex> guard(this->lock);
+      while (!this->pending.empty()) {
+        if (this->pending.front()->done) {
+          std::unique_ptr<block_job_t> job = std::move(this->pending.front());
+          this->pending.pop_front();
+
+          guard.unlock();
+          write_block(*job);
+          guard.lock();
+
+        } else if (all || (this->pending.size() > this->max_blocks)) {
+          this->block_done.wait(guard);
+        } else {
+          break;
+        }
+      }
+    }
+
+    /**
+     * Queue the filled part of the put area for compression
+     */
+    void submit() {
+      size_t size = pptr() - pbase();
+      if (size == 0) {
+        return;
+      }
+
+      std::unique_ptr<block_job_t> job = std::make_unique<block_job_t>();
+      this->block.resize(size);
+      job->raw.swap(this->block);
+
+      {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->todo.push_back(job.get());
+        this->pending.push_back(std::move(job));
+      }
+      this->work_ready.notify_one();
+
+      this->block.resize(this->block_size);
+      setp(this->block.data(), this->block.data() + this->block.size());
+
+      write_blocks(false);
+    }
+
+  protected:
+    /**
+     * Called when the put area is full
+     * @param  c the character that did not fit
+     * @return   c (or eof on failure)
+     */
+    int_type overflow(int_type c) override {
+      submit();
+      if (traits_type::eq_int_type(c, traits_type::eof())) {
+        return traits_type::not_eof(c);
+      }
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+      return c;
+    }
+
+    /**
+     * Flushes keep filling the current block (blocks are only cut when full)
+     * @return 0
+     */
+    int sync() override {
+      return 0;
+    }
+
+  public:
+    /**
+     * Constructor: start the compression threads
+     * @param file        the destination
+     * @param compression the compression
+     */
+    block_writer_t(std::ofstream& file, compression_t compression)
+      : file(file),
+        compression(compression),
+        block_size((compression == COMPRESSION_ZSTD) ? ZSTD_BLOCK_SIZE : GZIP_BLOCK_SIZE),
+        stopping(false),
+        failed(false),
+        compressed_size(0),
+        raw_size(0) {
+      unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+      this->max_blocks = threads * BLOCKS_PER_THREAD;
+
+      this->block.resize(this->block_size);
+      setp(this->block.data(), this->block.data() + this->block.size());
+
+      for (unsigned t=0; t<threads; t++) {
+        this->workers.emplace_back(&block_writer_t::run, this);
+      }
+    }
+
+    /**
+     * Destructor: stop the compression threads
+     */
+    ~block_writer_t() {
+      {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->stopping = true;
+      }
+      this->work_ready.notify_all();
+      for (std::thread& worker : this->workers) {
+        worker.join();
+      }
+    }
+
+    /**
+     * Write the remaining blocks and the block index
+     * @param  index_path the block index path
+     * @return            success or failure
+     */
+    bool finish(const std::string& index_path) {
+      submit();
+      write_blocks(true);
+
+      if (this->compression == COMPRESSION_GZIP) {
+        //readers check for the end of file block
+        this->file.write(reinterpret_cast<const char*>(BGZF_EOF), sizeof(BGZF_EOF));
+        this->compressed_size += sizeof(BGZF_EOF);
+      }
+
+      if (this->failed) {
+        std::cerr << "ERR: failed to compress output block" << std::endl;
+        return false;
+      }
+
+      std::ofstream index_file(index_path, std::ios::binary);
+      std::vector<unsigned char> header(32);
+      memcpy(header.data(), BLOCK_INDEX_MAGIC, 8);
+      put_le(header.data() + 8, this->compression, 4);
+      put_le(header.data() + 12, this->index.size(), 4);
+      put_le(header.data() + 16, this->compressed_size, 8);
+      put_le(header.data() + 24, this->raw_size, 8);
+      index_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+      unsigned char entry[16];
+      for (const std::pair<uint64_t,uint64_t>& offsets : this->index) {
+        put_le(entry, offsets.first, 8);
+        put_le(entry + 8, offsets.second, 8);
+        index_file.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+      }
+      index_file.close();
+
+      if (!index_file) {
+        std::cerr << "ERR: failed to write block index: " << index_path << std::endl;
+        return false;
+      }
+      return true;
+    }
+  };
+
+  /**
+   * Constructor: open the output (with the configured compression)
+   * @param dir      the output directory
+   * @param filename the output filename (without the compression suffix)
+   */
+  output_file_t::output_file_t(const std::string& dir, const std::string& filename)
+    : path(join(dir, output_filename(filename))),
+      file(path, std::ios::binary),
+      out(nullptr) {
+    if (output_compression == COMPRESSION_NONE) {
+      this->out.rdbuf(this->file.rdbuf());
+    } else {
+      this->blocks = std::make_unique<block_writer_t>(this->file, output_compression);
+      this->out.rdbuf(this->blocks.get());
+    }
+  }
+
+  /**
+   * Destructor: stop compressing (close() writes the remaining data)
+   */
+  output_file_t::~output_file_t() {}
+
+  /**
+   * Write a document in the configured format
+   * @param doc the document
+   */
+  void output_file_t::write(const nlohmann::json& doc) {
+    switch (output_format) {
+      case FORMAT_CBOR:
+        nlohmann::json::to_cbor(doc, this->out);
+        break;
+      case FORMAT_MSGPACK:
+        nlohmann::json::to_msgpack(doc, this->out);
+        break;
+      default:
+        this->out << doc << std::endl;
+        break;
+    }
+  }
+
+  /**
+   * Write the remaining blocks (and the block index) and close the file
+   * @return success or failure
+   */
+  bool output_file_t::close() {
+    bool success = this->out.good();
+
+    if (this->blocks) {
+      success = this->blocks->finish(this->path + BLOCK_INDEX_SUFFIX) && success;
+    }
+
+    this->file.close();
+    return success && !this->file.fail();
+  }
+}
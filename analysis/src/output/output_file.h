@@ -0,0 +1,140 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _OUTPUT_FILE_H
+#define _OUTPUT_FILE_H
+
+#include <json.hpp>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <ostream>
+
+namespace output {
+
+  #define GZIP_SUFFIX        ".gz"
+  #define ZSTD_SUFFIX        ".zst"
+  #define BLOCK_INDEX_SUFFIX ".idx"
+  #define JSON_EXTENSION     ".json"
+  #define CBOR_EXTENSION     ".cbor"
+  #define MSGPACK_EXTENSION  ".msgpack"
+
+  /*
+   * Compression of the json output files
+   */
+  enum compression_t {
+    COMPRESSION_NONE = 0,
+    COMPRESSION_GZIP = 1,
+    COMPRESSION_ZSTD = 2
+  };
+
+  /*
+   * Encoding of the json output files (same logical schema)
+   */
+  enum format_t {
+    FORMAT_JSON    = 0,
+    FORMAT_CBOR    = 1,
+    FORMAT_MSGPACK = 2
+  };
+
+  /**
+   * Parse a format name (json, cbor or msgpack)
+   * @param  name   the name
+   * @param  format the parsed format
+   * @return        whether the name is a supported format
+   */
+  [[nodiscard]] bool parse_format(const std::string& name, format_t& format);
+
+  /**
+   * Set the encoding of all json output files (before any are written)
+   * @param format the format
+   */
+  void set_format(format_t format);
+
+  /**
+   * Get the encoding of the json output files
+   * @return the format
+   */
+  format_t get_format();
+
+  /**
+   * Parse a compression name (none, gzip or zstd if compiled in)
+   * @param  name        the name
+   * @param  compression the parsed compression
+   * @return             whether the name is a supported compression
+   */
+  [[nodiscard]] bool parse_compression(const std::string& name, compression_t& compression);
+
+  /**
+   * Set the compression of all json output files (before any are written)
+   * @param compression the compression
+   */
+  void set_compression(compression_t compression);
+
+  /**
+   * Get the compression of the json output files
+   * @return the compression
+   */
+  compression_t get_compression();
+
+  /**
+   * Get the name an output is written as (with the format extension and compression suffix)
+   * @param  filename the output filename
+   * @return          the written filename
+   */
+  std::string output_filename(const std::string& filename);
+
+  struct block_writer_t;
+
+  /*
+   * An output file, written plain or as independently compressed blocks: gzip
+   * members with the bgzf block size field (any gzip reader), or zstd frames.
+   * Blocks are compressed on a thread pool and written in order, and their
+   * offsets are written to <file>.idx so ranges can be decompressed in parallel
+   */
+  struct output_file_t {
+  private:
+    std::string path;
+    std::ofstream file;
+    std::unique_ptr<block_writer_t> blocks;
+    std::ostream out;
+
+  public:
+    /**
+     * Constructor: open the output (with the configured compression)
+     * @param dir      the output directory
+     * @param filename the output filename (without the compression suffix)
+     */
+    output_file_t(const std::string& dir, const std::string& filename);
+
+    /**
+     * Destructor: stop compressing (close() writes the remaining data)
+     */
+    ~output_file_t();
+
+    //no copy
+    output_file_t(const output_file_t&) = delete;
+    output_file_t& operator=(const output_file_t&) = delete;
+
+    /**
+     * Get the path written to
+     * @return the path
+     */
+    const std::string& get_path() const { return this->path; }
+
+    /**
+     * Write a document in the configured format
+     * @param doc the document
+     */
+    void write(const nlohmann::json& doc);
+
+    /**
+     * Write the remaining blocks (and the block index) and close the file
+     * @return success or failure
+     */
+    [[nodiscard]] bool close();
+  };
+}
+
+#endif /*_OUTPUT_FILE_H*/
@@ -0,0 +1,229 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "packed_output.h"
+#include "render_output.h"
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <string_view>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <stdint.h>
+
+namespace output {
+
+  #define PACKED_RECOGNITION_MAGIC "SMPKREC1"
+  #define PACKED_HISTORY_MAGIC     "SMPKHIS1"
+
+  /**
+   * Write a little endian value
+   * @param out   the stream
+   * @param value the value
+   */
+  template<typename T>
+  static void put_value(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  /**
+   * Write a dictionary of ids (uint16 length, bytes)
+   * @param out the stream
+   * @param ids the ids
+   */
+  static void put_dictionary(std::ofstream& out, const std::vector<std::string_view>& ids) {
+    for (const std::string_view& id : ids) {
+      put_value<uint16_t>(out, (uint16_t) id.size());
+      out.write(id.data(), id.size());
+    }
+  }
+
+  /**
+   * Write an encoded column (uint32 byte length, bytes)
+   * @param out    the stream
+   * @param column the column
+   */
+  static void put_column(std::ofstream& out, const codec::int_column_t& column) {
+    put_value<uint32_t>(out, (uint32_t) column.bytes().size());
+    out.write(reinterpret_cast<const char*>(column.bytes().data()), column.bytes().size());
+  }
+
+  /**
+   * Write the recognitions of each (tower, vehicle) as an encoded timestep column
+   * and fixed point distances
+   * @see docs/output.md
+   * @param  out_dir_path       the directory to write output to
+   * @param  tower_recognitions tower recognitions map
+   * @param  vehicles           a set of unique vehicle ids
+   * @param  dist_scale         fixed point distance units per meter
+   * @param  codec              the integer codec
+   * @return the status
+   */
+  int write_packed_recognition_output(const std::string& out_dir_path,
+                                      const types::tower_recognitions_map_t& tower_recognitions,
+                                      const types::id_set_t& vehicles,
+                                      double dist_scale,
+                                      codec::codec_t codec) {
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "packed output is little endian");
+
+    std::string full_path = join(out_dir_path, PACKED_RECOGNITION_FILENAME);
+    std::ofstream out_file(full_path, std::ios::binary);
+
+    if (!out_file) {
+      std::cerr << "ERR: failed to open packed recognition output: " << full_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::vector<std::string_view> tower_ids;
+    for (const auto& tower : tower_recognitions) {
+      tower_ids.push_back(tower.first);
+    }
+
+    std::vector<std::string_view> vehicle_ids;
+    std::unordered_map<std::string_view,uint32_t> vehicle_index;
+    for (const std::pmr::string& vehicle_id : vehicles) {
+      vehicle_index.emplace(vehicle_id, (uint32_t) vehicle_ids.size());
+      vehicle_ids.push_back(vehicle_id);
+    }
+
+    //header
+    out_file.write(PACKED_RECOGNITION_MAGIC, 8);
+    put_value<uint32_t>(out_file, (uint32_t) codec);
+    put_value<uint32_t>(out_file, (uint32_t) tower_ids.size());
+    put_value<uint32_t>(out_file, (uint32_t) vehicle_ids.size());
+    put_value<double>(out_file, dist_scale);
+
+    put_dictionary(out_file, tower_ids);
+    put_dictionary(out_file, vehicle_ids);
+
+    //(vehicle index, timestep, distance)
+    std::vector<std::tuple<uint32_t,int32_t,double>> recognitions;
+    std::vector<uint16_t> distances;
+
+    for (const auto& tower : tower_recognitions) {
+      recognitions.clear();
+      tower.second.expand([&](int ts, const std::pmr::string& vehicle_id, double dist) {
+        std::unordered_map<std::string_view,uint32_t>::const_iterator it = vehicle_index.find(vehicle_id);
+        if (it != vehicle_index.end()) {
+          recognitions.emplace_back(it->second, ts, dist);
+        }
+      });
+
+      //timesteps in order for each vehicle (sorted deltas are small)
+      std::sort(recognitions.begin(), recognitions.end());
+
+      size_t series = 0;
+      for (size_t i=0; i<recognitions.size(); i++) {
+        series += (i == 0) || (std::get<0>(recognitions[i]) != std::get<0>(recognitions[i - 1]));
+      }
+      put_value<uint32_t>(out_file, (uint32_t) series);
+
+      //vehicle index, count, timesteps, distances
+      size_t i = 0;
+      while (i < recognitions.size()) {
+        uint32_t vehicle = std::get<0>(recognitions[i]);
+        codec::int_column_t timesteps(codec);
+        distances.clear();
+
+        for (; (i < recognitions.size()) && (std::get<0>(recognitions[i]) == vehicle); i++) {
+          timesteps.append(std::get<1>(recognitions[i]));
+          distances.push_back(codec::quantize(std::get<2>(recognitions[i]), dist_scale));
+        }
+
+        put_value<uint32_t>(out_file, vehicle);
+        put_value<uint32_t>(out_file, (uint32_t) distances.size());
+        put_column(out_file, timesteps);
+        out_file.write(reinterpret_cast<const char*>(distances.data()), distances.size() * sizeof(uint16_t));
+      }
+    }
+
+    out_file.close();
+    if (!out_file) {
+      std::cerr << "ERR: failed to write packed recognition output to file: " << full_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cerr << "INFO: wrote packed recognition output to: " << full_path << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  /**
+   * Write the segments reached by each vehicle as encoded (first timestep, segment) columns
+   * @see docs/output.md
+   * @param  out_dir_path      the directory to write output to
+   * @param  vehicle_lane_hist lanes seen by each vehicle
+   * @param  edges             all edges in the simulation
+   * @param  codec             the integer codec
+   * @return the status
+   */
+  int write_packed_history_output(const std::string& out_dir_path,
+                                  const types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                                  const types::id_set_t& edges,
+                                  codec::codec_t codec) {
+    std::string full_path = join(out_dir_path, PACKED_HISTORY_FILENAME);
+    std::ofstream out_file(full_path, std::ios::binary);
+
+    if (!out_file) {
+      std::cerr << "ERR: failed to open packed history output: " << full_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::vector<std::string_view> vehicle_ids;
+    for (const auto& vehicle : vehicle_lane_hist) {
+      vehicle_ids.push_back(vehicle.first);
+    }
+
+    std::vector<std::string_view> segment_ids;
+    std::unordered_map<std::string_view,int32_t> segment_index;
+    for (const std::pmr::string& edge_id : edges) {
+      segment_index.emplace(edge_id, (int32_t) segment_ids.size());
+      segment_ids.push_back(edge_id);
+    }
+
+    //header
+    out_file.write(PACKED_HISTORY_MAGIC, 8);
+    put_value<uint32_t>(out_file, (uint32_t) codec);
+    put_value<uint32_t>(out_file, (uint32_t) vehicle_ids.size());
+    put_value<uint32_t>(out_file, (uint32_t) segment_ids.size());
+
+    put_dictionary(out_file, vehicle_ids);
+    put_dictionary(out_file, segment_ids);
+
+    //(first timestep, segment index)
+    std::vector<std::pair<int32_t,int32_t>> seen;
+
+    for (const auto& vehicle : vehicle_lane_hist) {
+      seen.clear();
+      for (const auto& segment : vehicle.second.first_seen()) {
+        std::unordered_map<std::string_view,int32_t>::const_iterator it = segment_index.find(segment.first);
+        if (it != segment_index.end()) {
+          seen.emplace_back(segment.second, it->second);
+        }
+      }
+      std::sort(seen.begin(), seen.end());
+
+      codec::int_column_t first_seen(codec);
+      codec::int_column_t segments(codec);
+      for (const std::pair<int32_t,int32_t>& entry : seen) {
+        first_seen.append(entry.first);
+        segments.append(entry.second);
+      }
+
+      //count, first timesteps, segment indices
+      put_value<uint32_t>(out_file, (uint32_t) seen.size());
+      put_column(out_file, first_seen);
+      put_column(out_file, segments);
+    }
+
+    out_file.close();
+    if (!out_file) {
+      std::cerr << "ERR: failed to write packed history output to file: " << full_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cerr << "INFO: wrote packed history output to: " << full_path << std::endl;
+    return EXIT_SUCCESS;
+  }
+}
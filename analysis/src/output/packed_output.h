@@ -0,0 +1,51 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _PACKED_OUTPUT_H
+#define _PACKED_OUTPUT_H
+
+#include <string>
+#include "../types/tower_recognitions.h"
+#include "../types/vehicle_lane_hist.h"
+#include "../types/arena.h"
+#include "../codec/int_codec.h"
+
+namespace output {
+
+  #define PACKED_RECOGNITION_FILENAME "packed_recognition_output.bin"
+  #define PACKED_HISTORY_FILENAME     "packed_history_output.bin"
+
+  /**
+   * Write the recognitions of each (tower, vehicle) as an encoded timestep column
+   * and fixed point distances
+   * @see docs/output.md
+   * @param  out_dir_path       the directory to write output to
+   * @param  tower_recognitions tower recognitions map
+   * @param  vehicles           a set of unique vehicle ids
+   * @param  dist_scale         fixed point distance units per meter
+   * @param  codec              the integer codec
+   * @return the status
+   */
+  int write_packed_recognition_output(const std::string& out_dir_path,
+                                      const types::tower_recognitions_map_t& tower_recognitions,
+                                      const types::id_set_t& vehicles,
+                                      double dist_scale,
+                                      codec::codec_t codec);
+
+  /**
+   * Write the segments reached by each vehicle as encoded (first timestep, segment) columns
+   * @see docs/output.md
+   * @param  out_dir_path      the directory to write output to
+   * @param  vehicle_lane_hist lanes seen by each vehicle
+   * @param  edges             all edges in the simulation
+   * @param  codec             the integer codec
+   * @return the status
+   */
+  int write_packed_history_output(const std::string& out_dir_path,
+                                  const types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                                  const types::id_set_t& edges,
+                                  codec::codec_t codec);
+}
+
+#endif /*_PACKED_OUTPUT_H*/
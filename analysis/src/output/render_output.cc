@@ -3,8 +3,13 @@
  */
 
 #include "render_output.h"
+#include "output_file.h"
 #include <json.hpp>
-#include <fstream>
+#include <unordered_map>
+#include <string_view>
+#include <vector>
+#include <tuple>
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <unistd.h>
@@ -22,10 +27,6 @@ namespace output {
   #define V_KEY          "v"
   #define S_KEY          "s"
 
-  #define TOWER_OUTPUT_FILENAME   "tower_output.json"
-  #define VEHICLE_HIST_FILENAME   "vehicle_history_output.json"
-  #define TOWER_COVERAGE_FILENAME "tower_coverage_output.json"
-
   /**
    * Join a filename to a path that may or may not have a trailing slash
    * @param  dir  the directory
@@ -52,53 +53,81 @@ namespace output {
    * @return the status
    */
   int write_tower_output(const std::string& out_dir_path,
-                          const std::unordered_map<std::string, std::unique_ptr<types::tower_recognitions_t>>& tower_recognitions,
-                          const std::set<std::string>& vehicles,
-                          const std::set<std::string>& timesteps) {
+                          const types::tower_recognitions_map_t& tower_recognitions,
+                          const types::id_set_t& vehicles,
+                          const types::id_set_t& timesteps) {
 
     json_t out_obj = json_t::object();
     out_obj[VEHICLES_KEY] = json_t::array();
     out_obj[TOWERS_KEY] = json_t::array();
 
     //add the vehicle ids
-    for (const std::string& vehicle_id : vehicles) {
-      out_obj[VEHICLES_KEY].push_back(vehicle_id);
+    for (const std::pmr::string& vehicle_id : vehicles) {
+      out_obj[VEHICLES_KEY].push_back(std::string(vehicle_id));
+    }
+
+    //position of each vehicle and timestep in the output order
+    std::unordered_map<std::string_view,int> vehicle_index;
+    for (const std::pmr::string& vehicle_id : vehicles) {
+      vehicle_index.emplace(vehicle_id, (int) vehicle_index.size());
+    }
+
+    std::unordered_map<int,int> ts_index;
+    std::vector<int> ts_values;
+    for (const std::pmr::string& ts : timesteps) {
+      int ts_value = atoi(ts.c_str());
+      if (ts_index.emplace(ts_value, (int) ts_values.size()).second) {
+        ts_values.push_back(ts_value);
+      }
     }
 
-    std::unordered_map<std::string, std::unique_ptr<types::tower_recognitions_t>>::const_iterator it
+    //(timestep index, vehicle index, distance)
+    std::vector<std::tuple<int,int,double>> recognitions;
+
+    types::tower_recognitions_map_t::const_iterator it
       = tower_recognitions.begin();
 
     //read through all tower recognitions
     while (it != tower_recognitions.end()) {
       json_t elem = json_t::object();
-      elem[TOWER_ID_KEY] = it->first;
+      elem[TOWER_ID_KEY] = std::string(it->first);
       elem[VEHICLES_KEY] = json_t::array();
 
-      //create array for each timestep
-      for (const std::string& ts : timesteps) {
+      recognitions.clear();
+      it->second.expand([&](int ts, const std::pmr::string& vehicle_id, double dist) {
+        std::unordered_map<std::string_view,int>::const_iterator vehicle_it = vehicle_index.find(vehicle_id);
+        std::unordered_map<int,int>::const_iterator ts_it = ts_index.find(ts);
+        if ((vehicle_it != vehicle_index.end()) && (ts_it != ts_index.end())) {
+          recognitions.emplace_back(ts_it->second, vehicle_it->second, dist);
+        }
+      });
+
+      //group by timestep in output order (the last recognition of a repeated timestep and vehicle is kept)
+      std::stable_sort(recognitions.begin(), recognitions.end(), [](const auto& a, const auto& b) {
+        return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b));
+      });
+
+      size_t i = 0;
+      while (i < recognitions.size()) {
+        int ts_idx = std::get<0>(recognitions[i]);
         json_t positions = json_t::object();
-        positions[TS_KEY] = std::stoi(ts);
+        positions[TS_KEY] = ts_values[ts_idx];
         positions[V_KEY] = json_t::array();
 
-        int vidx = 0;
-        for (const std::string& vehicle_id : vehicles) {
-          //get the distance
-          double dist = it->second->distance(ts, vehicle_id);
-          //add if in range
-          if (dist > -1) {
-            json_t pair = json_t::array();
-            pair.push_back(vidx);
-            pair.push_back(dist);
-            positions[V_KEY].push_back(pair);
+        for (; (i < recognitions.size()) && (std::get<0>(recognitions[i]) == ts_idx); i++) {
+          if ((i + 1 < recognitions.size()) &&
+              (std::get<0>(recognitions[i + 1]) == ts_idx) &&
+              (std::get<1>(recognitions[i + 1]) == std::get<1>(recognitions[i]))) {
+            continue;
           }
 
-          vidx++;
+          json_t pair = json_t::array();
+          pair.push_back(std::get<1>(recognitions[i]));
+          pair.push_back(std::get<2>(recognitions[i]));
+          positions[V_KEY].push_back(pair);
         }
 
-        //ignore empty timesteps
-        if (!positions[V_KEY].empty()) {
-          elem[VEHICLES_KEY].push_back(positions);
-        }
+        elem[VEHICLES_KEY].push_back(positions);
       }
 
       //add the tower element
@@ -109,13 +138,15 @@ namespace output {
 
     //write to the file
     try {
-      std::string full_path = join(out_dir_path, TOWER_OUTPUT_FILENAME);
+      output_file_t out_file(out_dir_path, TOWER_OUTPUT_FILENAME);
+      out_file.write(out_obj);
 
-      std::ofstream out_file(full_path);
-      out_file << out_obj << std::endl;
-      out_file.close();
+      if (!out_file.close()) {
+        std::cerr << "ERR: failed to write tower output to file: " << out_file.get_path() << std::endl;
+        return EXIT_FAILURE;
+      }
 
-      std::cerr << "INFO: wrote tower output to: " << full_path << std::endl;
+      std::cerr << "INFO: wrote tower output to: " << out_file.get_path() << std::endl;
 
     } catch (const std::exception& e) {
       std::cerr << "ERR: failed to write tower output to file: " << e.what() << std::endl;
@@ -134,30 +165,30 @@ namespace output {
    * @return the status
    */
   int write_vehicle_output(const std::string& out_dir_path,
-                           const std::unordered_map<std::string,std::unique_ptr<types::vehicle_lane_hist_t>>& vehicle_lane_hist,
-                           const std::set<std::string>& edges,
-                           const std::set<std::string>& timesteps) {
+                           const types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                           const types::id_set_t& edges,
+                           const types::id_set_t& timesteps) {
     json_t out_obj = json_t::object();
     out_obj[SEGMENTS_KEY] = json_t::array();
     out_obj[VEHICLES_KEY] = json_t::array();
 
-    for (const std::string& edge_id : edges) {
-      out_obj[SEGMENTS_KEY].push_back(edge_id);
+    for (const std::pmr::string& edge_id : edges) {
+      out_obj[SEGMENTS_KEY].push_back(std::string(edge_id));
     }
 
     std::vector<int> ts;
     //convert timesteps to numeric values
-    for (const std::string& ts_s : timesteps) {
-      ts.push_back(std::stoi(ts_s));
+    for (const std::pmr::string& ts_s : timesteps) {
+      ts.push_back(atoi(ts_s.c_str()));
     }
 
-    std::unordered_map<std::string, std::unique_ptr<types::vehicle_lane_hist_t>>::const_iterator it
+    types::vehicle_lane_hist_map_t::const_iterator it
       = vehicle_lane_hist.begin();
 
     //read through all vehicles
     while (it != vehicle_lane_hist.end()) {
       json_t vehicle = json_t::object();
-      vehicle[VEHICLE_ID_KEY] = it->first;
+      vehicle[VEHICLE_ID_KEY] = std::string(it->first);
       vehicle[SEGMENTS_KEY] = json_t::array();
 
       for (size_t i=0; i<ts.size(); i++) {
@@ -169,8 +200,8 @@ namespace output {
 
         //check all segments
         size_t j=0;
-        for (const std::string& edge_id : edges) {
-          int ts_since_seen = it->second->timesteps_since_seen(edge_id, ts.at(i));
+        for (const std::pmr::string& edge_id : edges) {
+          int ts_since_seen = it->second.timesteps_since_seen(edge_id, ts.at(i));
           if (ts_since_seen >= 0) {
             json_t pair = json_t::array();
             pair.push_back(j);
@@ -192,13 +223,15 @@ namespace output {
 
     //write to the file
     try {
-      std::string full_path = join(out_dir_path, VEHICLE_HIST_FILENAME);
+      output_file_t out_file(out_dir_path, VEHICLE_HIST_FILENAME);
+      out_file.write(out_obj);
 
-      std::ofstream out_file(full_path);
-      out_file << out_obj << std::endl;
-      out_file.close();
+      if (!out_file.close()) {
+        std::cerr << "ERR: failed to write vehicle history output to file: " << out_file.get_path() << std::endl;
+        return EXIT_FAILURE;
+      }
 
-      std::cerr << "INFO: wrote vehicle history output to: " << full_path << std::endl;
+      std::cerr << "INFO: wrote vehicle history output to: " << out_file.get_path() << std::endl;
 
     } catch (const std::exception& e) {
       std::cerr << "ERR: failed to write vehicle history output to file: " << e.what() << std::endl;
@@ -218,37 +251,37 @@ namespace output {
    * @return the status
    */
   int write_tower_coverage_output(const std::string& out_dir_path,
-                                  const std::unordered_map<std::string,std::unique_ptr<types::tower_recognitions_t>>& tower_recognitions,
-                                  const std::unordered_map<std::string,std::unique_ptr<types::road_edge_t>>& edge_shapes,
-                                  const std::set<std::string>& edges,
-                                  const std::set<std::string>& towers) {
+                                  const types::tower_recognitions_map_t& tower_recognitions,
+                                  const types::road_edge_map_t& edge_shapes,
+                                  const types::id_set_t& edges,
+                                  const types::id_set_t& towers) {
     json_t out_obj = json_t::object();
     out_obj[SEGMENTS_KEY] = json_t::array();
     out_obj[TOWERS_KEY] = json_t::array();
 
-    for (const std::string& edge_id : edges) {
-      out_obj[SEGMENTS_KEY].push_back(edge_id);
+    for (const std::pmr::string& edge_id : edges) {
+      out_obj[SEGMENTS_KEY].push_back(std::string(edge_id));
     }
 
-    for (const std::string& tower_id : towers) {
+    for (const std::pmr::string& tower_id : towers) {
       json_t tower = json_t::object();
-      tower[TOWER_ID_KEY] = tower_id;
+      tower[TOWER_ID_KEY] = std::string(tower_id);
       tower[SEGMENTS_KEY] = json_t::array();
 
-      std::unordered_map<std::string,std::unique_ptr<types::tower_recognitions_t>>::const_iterator tower_it
+      types::tower_recognitions_map_t::const_iterator tower_it
         = tower_recognitions.find(tower_id);
 
       if (tower_it != tower_recognitions.end()) {
 
-        for (const std::string& edge_id : edges) {
-          std::unordered_map<std::string,std::unique_ptr<types::road_edge_t>>::const_iterator edge_it
+        for (const std::pmr::string& edge_id : edges) {
+          types::road_edge_map_t::const_iterator edge_it
             = edge_shapes.find(edge_id);
 
           if (edge_it != edge_shapes.end()) {
 
             //add the distance
             tower[SEGMENTS_KEY].push_back(
-              tower_it->second->edge_distance(*edge_it->second)
+              tower_it->second.edge_distance(edge_it->second)
             );
           }
         }
@@ -261,13 +294,15 @@ namespace output {
 
     //write to the file
     try {
-      std::string full_path = join(out_dir_path, TOWER_COVERAGE_FILENAME);
+      output_file_t out_file(out_dir_path, TOWER_COVERAGE_FILENAME);
+      out_file.write(out_obj);
 
-      std::ofstream out_file(full_path);
-      out_file << out_obj << std::endl;
-      out_file.close();
+      if (!out_file.close()) {
+        std::cerr << "ERR: failed to write tower coverage output to file: " << out_file.get_path() << std::endl;
+        return EXIT_FAILURE;
+      }
 
-      std::cerr << "INFO: wrote tower coverage output to: " << full_path << std::endl;
+      std::cerr << "INFO: wrote tower coverage output to: " << out_file.get_path() << std::endl;
 
     } catch (const std::exception& e) {
       std::cerr << "ERR: failed to write tower coverage output to file: " << e.what() << std::endl;
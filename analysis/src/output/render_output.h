@@ -10,11 +10,24 @@
 #include "../types/tower_recognitions.h"
 #include "../types/road_edge.h"
 #include "../types/vehicle_lane_hist.h"
+#include "../types/arena.h"
 #include <memory>
 #include <set>
 
 namespace output {
 
+  #define TOWER_OUTPUT_FILENAME   "tower_output.json"
+  #define VEHICLE_HIST_FILENAME   "vehicle_history_output.json"
+  #define TOWER_COVERAGE_FILENAME "tower_coverage_output.json"
+
+  /**
+   * Join a filename to a path that may or may not have a trailing slash
+   * @param  dir  the directory
+   * @param  file the file
+   * @return      the full path
+   */
+  std::string join(const std::string& dir, const std::string& file);
+
   /**
    * Write the tower output format
    * @see docs/output.md
@@ -25,9 +38,9 @@ namespace output {
    * @return the status
    */
   int write_tower_output(const std::string& out_dir_path,
-                          const std::unordered_map<std::string,std::unique_ptr<types::tower_recognitions_t>>& tower_recognitions,
-                          const std::set<std::string>& vehicles,
-                          const std::set<std::string>& timesteps);
+                          const types::tower_recognitions_map_t& tower_recognitions,
+                          const types::id_set_t& vehicles,
+                          const types::id_set_t& timesteps);
 
   /**
    * Write the vehicle segment history to an output file
@@ -38,9 +51,9 @@ namespace output {
    * @return the status
    */
   int write_vehicle_output(const std::string& out_dir_path,
-                           const std::unordered_map<std::string,std::unique_ptr<types::vehicle_lane_hist_t>>& vehicle_lane_hist,
-                           const std::set<std::string>& edges,
-                           const std::set<std::string>& timesteps);
+                           const types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                           const types::id_set_t& edges,
+                           const types::id_set_t& timesteps);
 
   /**
    * Determine which segments in the network each tower covers
@@ -53,10 +66,10 @@ namespace output {
    * @return the status
    */
   int write_tower_coverage_output(const std::string& out_dir_path,
-                                  const std::unordered_map<std::string,std::unique_ptr<types::tower_recognitions_t>>& tower_recognitions,
-                                  const std::unordered_map<std::string,std::unique_ptr<types::road_edge_t>>& edge_shapes,
-                                  const std::set<std::string>& edges,
-                                  const std::set<std::string>& towers);
+                                  const types::tower_recognitions_map_t& tower_recognitions,
+                                  const types::road_edge_map_t& edge_shapes,
+                                  const types::id_set_t& edges,
+                                  const types::id_set_t& towers);
 }
 
 #endif /*_RENDER_OUTPUT_H*/
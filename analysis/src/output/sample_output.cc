@@ -0,0 +1,68 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "sample_output.h"
+#include "render_output.h"
+#include <json.hpp>
+#include <fstream>
+#include <iostream>
+#include <exception>
+
+namespace output {
+
+  typedef nlohmann::json json_t;
+
+  /**
+   * Write the sample rate, what was kept and dropped, and the factors to scale
+   * sampled counts (e.g. tower load) by
+   * @see docs/output.md
+   * @param  out_dir_path  the directory to write output to
+   * @param  sample        the vehicle sample
+   * @param  vehicles_kept the number of vehicles in the outputs
+   * @return the status
+   */
+  int write_sampling_stats(const std::string& out_dir_path,
+                           const sample::vehicle_sample_t& sample,
+                           size_t vehicles_kept) {
+    json_t out_obj = {
+      {"sample_rate", sample.get_rate()},
+      {"seed", sample.get_seed()},
+      {"vehicles_kept", vehicles_kept},
+      {"entries_kept", sample.entries_kept},
+      {"entries_dropped", sample.entries_dropped},
+      //realized scale factors (the nominal factor is 1 / sample_rate)
+      {"scale", {
+        {"nominal", 1.0 / sample.get_rate()},
+        {"entries", sample::scale_factor(sample.entries_kept, sample.entries_dropped)}
+      }}
+    };
+
+    //bt output contacts (what-if and traci recognitions are computed from the sampled vehicles)
+    if (sample.contacts_kept || sample.contacts_dropped) {
+      out_obj["contacts_kept"] = sample.contacts_kept;
+      out_obj["contacts_dropped"] = sample.contacts_dropped;
+      out_obj["recognitions_kept"] = sample.points_kept;
+      out_obj["recognitions_dropped"] = sample.points_dropped;
+      out_obj["scale"]["contacts"] = sample::scale_factor(sample.contacts_kept, sample.contacts_dropped);
+      out_obj["scale"]["recognitions"] = sample::scale_factor(sample.points_kept, sample.points_dropped);
+    }
+
+    //write to the file
+    try {
+      std::string full_path = join(out_dir_path, SAMPLING_STATS_FILENAME);
+
+      std::ofstream out_file(full_path);
+      out_file << out_obj.dump(2) << std::endl;
+      out_file.close();
+
+      std::cerr << "INFO: wrote sampling stats to: " << full_path << std::endl;
+
+    } catch (const std::exception& e) {
+      std::cerr << "ERR: failed to write sampling stats to file: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  }
+}
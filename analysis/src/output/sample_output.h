@@ -0,0 +1,29 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _SAMPLE_OUTPUT_H
+#define _SAMPLE_OUTPUT_H
+
+#include <string>
+#include "../sample/vehicle_sample.h"
+
+namespace output {
+
+  #define SAMPLING_STATS_FILENAME "sampling_stats.json"
+
+  /**
+   * Write the sample rate, what was kept and dropped, and the factors to scale
+   * sampled counts (e.g. tower load) by
+   * @see docs/output.md
+   * @param  out_dir_path  the directory to write output to
+   * @param  sample        the vehicle sample
+   * @param  vehicles_kept the number of vehicles in the outputs
+   * @return the status
+   */
+  int write_sampling_stats(const std::string& out_dir_path,
+                           const sample::vehicle_sample_t& sample,
+                           size_t vehicles_kept);
+}
+
+#endif /*_SAMPLE_OUTPUT_H*/
@@ -0,0 +1,63 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "sweep_output.h"
+#include "render_output.h"
+#include <json.hpp>
+#include <fstream>
+#include <iostream>
+#include <exception>
+
+namespace output {
+
+  typedef nlohmann::json json_t;
+
+  /**
+   * Write the range sweep summary
+   * @see docs/output.md
+   * @param  out_dir_path    the directory to write output to
+   * @param  summaries       statistics for each range (ascending)
+   * @param  towers          the number of towers
+   * @param  vehicle_samples all (timestep, vehicle) samples in the netstate
+   * @return the status
+   */
+  int write_range_sweep_output(const std::string& out_dir_path,
+                               const std::vector<range_summary_t>& summaries,
+                               size_t towers,
+                               uint64_t vehicle_samples) {
+    json_t out_obj = json_t::object();
+    out_obj["towers"] = towers;
+    out_obj["vehicle_samples"] = vehicle_samples;
+    out_obj["ranges"] = json_t::array();
+
+    for (const range_summary_t& summary : summaries) {
+      json_t range = json_t::object();
+      range["range"] = summary.range;
+      range["recognitions"] = summary.recognitions;
+      range["vehicles"] = summary.vehicles;
+      range["timesteps"] = summary.timesteps;
+      range["active_towers"] = summary.active_towers;
+      range["covered_samples"] = summary.covered_samples;
+      range["coverage"] = vehicle_samples ? ((double) summary.covered_samples / vehicle_samples) : 0.0;
+      out_obj["ranges"].push_back(range);
+    }
+
+    //write to the file
+    try {
+      std::string full_path = join(out_dir_path, RANGE_SWEEP_FILENAME);
+
+      std::ofstream out_file(full_path);
+      out_file << out_obj.dump(2) << std::endl;
+      out_file.close();
+
+      std::cerr << "INFO: wrote range sweep output to: " << full_path << std::endl;
+
+    } catch (const std::exception& e) {
+      std::cerr << "ERR: failed to write range sweep output to file: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  }
+}
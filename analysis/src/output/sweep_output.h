@@ -0,0 +1,49 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _SWEEP_OUTPUT_H
+#define _SWEEP_OUTPUT_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace output {
+
+  #define RANGE_SWEEP_FILENAME "range_sweep_output.json"
+
+  /*
+   * Coverage statistics for one range of a range sweep
+   */
+  struct range_summary_t {
+    //the recognition range
+    double range;
+    //(tower, timestep, vehicle) recognitions
+    uint64_t recognitions;
+    //unique vehicles recognized by any tower
+    size_t vehicles;
+    //timesteps with any recognition
+    size_t timesteps;
+    //towers with any recognition
+    size_t active_towers;
+    //(timestep, vehicle) samples in range of any tower
+    uint64_t covered_samples;
+  };
+
+  /**
+   * Write the range sweep summary
+   * @see docs/output.md
+   * @param  out_dir_path    the directory to write output to
+   * @param  summaries       statistics for each range (ascending)
+   * @param  towers          the number of towers
+   * @param  vehicle_samples all (timestep, vehicle) samples in the netstate
+   * @return the status
+   */
+  int write_range_sweep_output(const std::string& out_dir_path,
+                               const std::vector<range_summary_t>& summaries,
+                               size_t towers,
+                               uint64_t vehicle_samples);
+}
+
+#endif /*_SWEEP_OUTPUT_H*/
@@ -0,0 +1,93 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "trajectory_output.h"
+#include "render_output.h"
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+
+namespace output {
+
+  #define TRAJECTORY_MAGIC    "SMTRAJ01"
+
+  /**
+   * Write a little endian value
+   * @param out   the stream
+   * @param value the value
+   */
+  template<typename T>
+  void write_value(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  /**
+   * Write a column as a contiguous array
+   * @param out the stream
+   * @param col the column
+   */
+  template<typename T>
+  void write_column(std::ofstream& out, const std::pmr::vector<T>& col) {
+    out.write(reinterpret_cast<const char*>(col.data()), col.size() * sizeof(T));
+  }
+
+  /**
+   * Write a dictionary of ids (uint16 length, bytes)
+   * @param out the stream
+   * @param ids the ids
+   */
+  void write_dictionary(std::ofstream& out, const std::pmr::vector<std::pmr::string>& ids) {
+    for (const std::pmr::string& id : ids) {
+      write_value<uint16_t>(out, (uint16_t) id.size());
+      out.write(id.data(), id.size());
+    }
+  }
+
+  /**
+   * Write the binary vehicle trajectory output
+   * @see docs/output.md
+   * @param  out_dir_path the directory to write output to
+   * @param  trajectories the trajectory table (finished and projected)
+   * @return the status
+   */
+  int write_trajectory_output(const std::string& out_dir_path,
+                              const types::trajectory_table_t& trajectories) {
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "trajectory output is little endian");
+
+    std::string full_path = join(out_dir_path, TRAJECTORY_FILENAME);
+    std::ofstream out_file(full_path, std::ios::binary);
+
+    if (!out_file) {
+      std::cerr << "ERR: failed to open trajectory output: " << full_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    //header
+    out_file.write(TRAJECTORY_MAGIC, 8);
+    write_value<uint32_t>(out_file, (uint32_t) trajectories.lanes().size());
+    write_value<uint32_t>(out_file, (uint32_t) trajectories.vehicles().size());
+    write_value<uint64_t>(out_file, (uint64_t) trajectories.size());
+
+    write_dictionary(out_file, trajectories.lanes());
+    write_dictionary(out_file, trajectories.vehicles());
+
+    //columns
+    write_column(out_file, trajectories.vehicle_offsets());
+    write_column(out_file, trajectories.timesteps());
+    write_column(out_file, trajectories.lane_indices());
+    write_column(out_file, trajectories.positions());
+    write_column(out_file, trajectories.speeds());
+    write_column(out_file, trajectories.xs());
+    write_column(out_file, trajectories.ys());
+
+    out_file.close();
+    if (!out_file) {
+      std::cerr << "ERR: failed to write trajectory output to file: " << full_path << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cerr << "INFO: wrote vehicle trajectory output to: " << full_path << std::endl;
+    return EXIT_SUCCESS;
+  }
+}
@@ -0,0 +1,26 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _TRAJECTORY_OUTPUT_H
+#define _TRAJECTORY_OUTPUT_H
+
+#include <string>
+#include "../types/vehicle_trajectory.h"
+
+namespace output {
+
+  #define TRAJECTORY_FILENAME "vehicle_trajectory_output.bin"
+
+  /**
+   * Write the binary vehicle trajectory output
+   * @see docs/output.md
+   * @param  out_dir_path the directory to write output to
+   * @param  trajectories the trajectory table (finished and projected)
+   * @return the status
+   */
+  int write_trajectory_output(const std::string& out_dir_path,
+                              const types::trajectory_table_t& trajectories);
+}
+
+#endif /*_TRAJECTORY_OUTPUT_H*/
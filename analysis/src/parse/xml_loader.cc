@@ -0,0 +1,220 @@
+/*
+ * Jack Hay, Sept 2021
+ */
+
+#include "xml_loader.h"
+#include "../stream/byte_source.h"
+#include "../stream/gzip_source.h"
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+#define COMMA ','
+#define SPACE ' '
+//initial inflated buffer size for streamed gzip input (x the compressed size)
+#define INFLATE_ESTIMATE 8
+
+namespace parse {
+
+  /**
+   * Get the size of the file
+   * @param  path the path to the input file
+   * @return      the file size
+   */
+  uint64_t get_size(const std::string& path) {
+    FILE *file_p = NULL;
+    file_p = fopen(path.c_str(),"rb");
+    fseek(file_p,0,SEEK_END);
+    uint64_t size = ftell(file_p);
+    fclose(file_p);
+    return size;
+  }
+
+  /**
+   * Parse a signed pair of doubles from a string
+   * @param  pos the position as a string
+   * @param  x   parsed position x
+   * @param  y   parsed position y
+   * @return     whether the pair was parsed successfully
+   */
+  [[nodiscard]] bool parse_position(const std::string& pos, double& x, double& y) {
+    std::stringstream sstream(pos);
+    bool got_x = false;
+    std::string substr;
+
+    try {
+      while(sstream.good()) {
+        getline(sstream, substr, COMMA);
+        if (got_x) {
+          y = atof(substr.c_str());
+        } else {
+          x = atof(substr.c_str());
+          got_x = true;
+        }
+      }
+    } catch (...) {
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Parse a list of space separated, comma separated pairs of doubles
+   * @param  shape    the string encoding
+   * @param  vertices the parsed pairs
+   * @return          whether the pairs were parsed successfully
+   */
+  [[nodiscard]] bool parse_shape(const std::string& shape, std::vector<std::pair<double,double>>& vertices) {
+    std::stringstream sstream(shape);
+    std::string pair;
+    while (std::getline(sstream, pair, SPACE)) {
+      //split the pair
+      std::pair<double,double> p;
+      int dim = 0;
+      std::string v;
+
+      std::stringstream pair_sstream(pair);
+      while (std::getline(pair_sstream, v, COMMA)) {
+        //parse as double
+        if (dim == 0) {
+          p.first = atof(v.c_str());
+        } else {
+          p.second = atof(v.c_str());
+        }
+        dim++;
+      }
+
+      if (dim == 2) {
+        vertices.push_back(p);
+      } else {
+        return false;
+      }
+    }
+
+    //shape assumes greater than a single vertex
+    return vertices.size() > 1;
+  }
+
+  /**
+   * Inflate a gzip compressed file into a null terminated buffer
+   * @param  path     the path to the file
+   * @param  filesize the compressed size
+   * @param  buff     the inflated contents (malloc'd, freed by the caller)
+   * @return          success or failure
+   */
+  bool inflate_file(const std::string& path, uint64_t filesize, char *&buff) {
+    //independent blocks are inflated in parallel
+    uint64_t size = 0;
+    int blocks = stream::inflate_blocks(path, buff, size);
+    if (blocks != 0) {
+      return blocks > 0;
+    }
+
+    //otherwise inflated on the source's thread while copying out
+    stream::byte_source_t source(false, 0);
+    if (!source.open(path)) {
+      return false;
+    }
+
+    //the inflated size is unknown: grow from an estimate
+    uint64_t capacity = filesize * INFLATE_ESTIMATE + 1;
+    buff = (char*) malloc(capacity);
+
+    ssize_t n;
+    while (buff && (n = source.read(buff + size, capacity - 1 - size)) > 0) {
+      size += n;
+      if (size == capacity - 1) {
+        capacity *= 2;
+        char *grown = (char*) realloc(buff, capacity);
+        if (grown == NULL) {
+          free(buff);
+        }
+        buff = grown;
+      }
+    }
+
+    if (buff == NULL) {
+      std::cerr << "ERR: failed to allocate inflated " << path << std::endl;
+      return false;
+    }
+
+    if (n < 0) {
+      std::cerr << "ERR: failed to inflate " << path << std::endl;
+      free(buff);
+      buff = NULL;
+      return false;
+    }
+
+    buff[size] = 0;
+    return true;
+  }
+
+  /**
+   * Load the xml document from a path, execute handler, free memory
+   * @param path    the path to the file
+   * @param handler the lifetime of the xml in memory
+   * @return success or failure
+   */
+  [[nodiscard]] bool load_from_path(const std::string& path, std::function<void(const rapidxml::xml_document<>&)> handler) {
+    //get the filesize and allocate space
+    uint64_t filesize = get_size(path);
+    char *buff = NULL;
+
+    FILE *xml_file = fopen(path.c_str(), "rb");
+    char magic[2];
+    size_t magic_size = fread(magic, 1, sizeof(magic), xml_file);
+
+    if (stream::is_gzip(magic, magic_size)) {
+      //compressed sumo output (*.xml.gz)
+      fclose(xml_file);
+      if (!inflate_file(path, filesize, buff)) {
+        return false;
+      }
+
+    } else {
+      buff = (char*) malloc(sizeof(char) * (filesize + 1));
+
+      rewind(xml_file);
+      if (fread(buff, filesize, 1, xml_file) == 0) {
+        std::cout << "ERR: failed to read from " << path << std::endl;
+        free(buff);
+        fclose(xml_file);
+        return false;
+      }
+      fclose(xml_file);
+
+      buff[filesize] = 0;
+    }
+
+    rapidxml::xml_document<> doc;
+
+    bool success = true;
+
+    try {
+      //parse from the buffer
+      doc.parse<0>(buff);
+    } catch (rapidxml::parse_error& e) {
+      std::cerr << "ERR: parse error: " << e.what() << std::endl;
+      success = false;
+    } catch (...) {
+      std::cerr << "ERR: parse error" << std::endl;
+      success = false;
+    }
+
+    if (success) {
+      try {
+        //call the handler
+        handler(doc);
+      } catch (...) {
+        std::cerr << "ERR handler for " << path << " threw exception" << std::endl;
+        success = false;
+      }
+    }
+
+    //free the buffer (always)
+    free(buff);
+
+    return success;
+  }
+}
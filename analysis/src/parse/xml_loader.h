@@ -0,0 +1,50 @@
+/*
+ * Jack Hay, Sept 2021
+ */
+
+#ifndef _XML_LOADER_H
+#define _XML_LOADER_H
+
+#include <rapidxml.hpp>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <stdint.h>
+
+namespace parse {
+
+  /**
+   * Get the size of the file
+   * @param  path the path to the input file
+   * @return      the file size
+   */
+  uint64_t get_size(const std::string& path);
+
+  /**
+   * Parse a signed pair of doubles from a string
+   * @param  pos the position as a string
+   * @param  x   parsed position x
+   * @param  y   parsed position y
+   * @return     whether the pair was parsed successfully
+   */
+  [[nodiscard]] bool parse_position(const std::string& pos, double& x, double& y);
+
+  /**
+   * Parse a list of space separated, comma separated pairs of doubles
+   * @param  shape    the string encoding
+   * @param  vertices the parsed pairs
+   * @return          whether the pairs were parsed successfully
+   */
+  [[nodiscard]] bool parse_shape(const std::string& shape, std::vector<std::pair<double,double>>& vertices);
+
+  /**
+   * Load the xml document from a path, execute handler, free memory
+   * @param path    the path to the file
+   * @param handler the lifetime of the xml in memory
+   * @return success or failure
+   */
+  [[nodiscard]] bool load_from_path(const std::string& path, std::function<void(const rapidxml::xml_document<>&)> handler);
+}
+
+#endif /*_XML_LOADER_H*/
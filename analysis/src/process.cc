@@ -10,8 +10,35 @@
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <optional>
+#include <thread>
 #include "types/tower_recognitions.h"
+#include "types/arena.h"
+#include "types/vehicle_trajectory.h"
 #include "output/render_output.h"
+#include "output/trajectory_output.h"
+#include "output/sweep_output.h"
+#include "output/interval_output.h"
+#include "output/handoff_output.h"
+#include "handoff/handoff_graph.h"
+#include "output/load_output.h"
+#include "output/output_file.h"
+#include "output/arrow_output.h"
+#include "output/packed_output.h"
+#include "output/sample_output.h"
+#include "load/tower_load.h"
+#include "parse/xml_loader.h"
+#include "stats/phase_stats.h"
+#include "stats/perf_counters.h"
+#include "what_if/vehicle_grid.h"
+#include "what_if/tower_positions.h"
+#include "stream/element_reader.h"
+#include "cache/content_hash.h"
+#include "cache/net_cache.h"
+#include "cache/artifact_manifest.h"
+#include "traci/traci_client.h"
+#include "sample/vehicle_sample.h"
+#include "filter/input_filter.h"
 #include <iostream>
 #include <functional>
 #include <exception>
@@ -20,6 +47,9 @@
 #include <set>
 #include <cmath>
 #include <utility>
+#include <algorithm>
+#include <cerrno>
+#include <sys/stat.h>
 
 #define BT_OUTPUT_NODE          "bt-output"
 #define BT_NODE                 "bt"
@@ -40,175 +70,118 @@
 #define FUNCTION_ATTR           "function"
 #define INTERNAL_VAL            "internal"
 #define SHAPE_ATTR              "shape"
+#define LENGTH_ATTR             "length"
+#define POS_ATTR                "pos"
+#define SPEED_ATTR              "speed"
 
 //tower vehicle prefix
 #define TOWER_PREFIX "tower"
 
-#define COMMA ','
-#define SPACE ' '
+//incremental stages and inputs (artifact manifest)
+#define TOWER_STAGE     "towers"
+#define COVERAGE_STAGE  "coverage"
+#define VEHICLE_STAGE   "vehicles"
+#define BT_INPUT        "bt_output"
+#define NETWORK_INPUT   "network"
+#define NETSTATE_INPUT  "netstate"
+#define TIMESTEPS_INPUT "timesteps"
+
+//how long to wait for the simulation to accept a traci connection
+#define TRACI_CONNECT_TIMEOUT_MS 30000
 
 /**
- * Get the size of the file
- * @param  path the path to the input file
- * @return      the file size
+ * Calculate the distance between two points
+ * @param  x0,y0 first point
+ * @param  x1,y1 second point
+ * @return cartesian distance
  */
-uint64_t get_size(const std::string& path) {
-  FILE *file_p = NULL;
-  file_p = fopen(path.c_str(),"rb");
-  fseek(file_p,0,SEEK_END);
-  uint64_t size = ftell(file_p);
-  fclose(file_p);
-  return size;
+inline double distance(double x0, double y0,
+                       double x1, double y1) {
+  return sqrt(pow(x1 - x0, 2) + pow(y1 - y0, 2));
 }
 
 /**
- * Parse a signed pair of doubles from a string
- * @param  pos the position as a string
- * @param  x   parsed position x
- * @param  y   parsed position y
- * @return     whether the pair was parsed successfully
+ * Add a tower recognition collector if not already set for this id
+ * @param  tower_id           the id of the tower
+ * @param  tower_recognitions all tower recognitions
+ * @param  options            run options (contact intervals, compact storage)
+ * @return                    the tower recognition collector
  */
-[[nodiscard]] bool parse_position(const std::string& pos, double& x, double& y) {
-  std::stringstream sstream(pos);
-  bool got_x = false;
-  std::string substr;
-
-  try {
-    while(sstream.good()) {
-      getline(sstream, substr, COMMA);
-      if (got_x) {
-        y = atof(substr.c_str());
-      } else {
-        x = atof(substr.c_str());
-        got_x = true;
-      }
-    }
-  } catch (...) {
-    return false;
+types::tower_recognitions_t& add_tower(const std::pmr::string& tower_id,
+                                       types::tower_recognitions_map_t& tower_recognitions,
+                                       const process_options_t& options) {
+  //constructed in the map's arena if not already present
+  std::pair<types::tower_recognitions_map_t::iterator,bool> inserted = tower_recognitions.try_emplace(tower_id, tower_id);
+  if (inserted.second && options.intervals) {
+    inserted.first->second.set_intervals(options.curve_step);
+  } else if (inserted.second && (options.dist_quantum > 0)) {
+    inserted.first->second.set_compact(1.0 / options.dist_quantum, options.codec);
   }
-  return true;
+  return inserted.first->second;
 }
 
 /**
- * Parse a list of space separated, comma separated pairs of doubles
- * @param  shape    the string encoding
- * @param  vertices the parsed pairs
- * @return          whether the pairs were parsed successfully
+ * Write the tower output (or the contact interval output), the handoff graph, tower load,
+ * the arrow and packed recognitions
+ * @param  output_path        the path to a folder to write output files to
+ * @param  tower_recognitions tower recognitions map
+ * @param  vehicles           a set of unique vehicle ids
+ * @param  timesteps          all timesteps with recognitions
+ * @param  options            run options (contact intervals, handoffs, tower load, arrow, packed)
+ * @return                    the status
  */
-[[nodiscard]] bool parse_shape(const std::string& shape, std::vector<std::pair<double,double>>& vertices) {
-  std::stringstream sstream(shape);
-  std::string pair;
-  while (std::getline(sstream, pair, SPACE)) {
-    //split the pair
-    std::pair<double,double> p;
-    int dim = 0;
-    std::string v;
-
-    std::stringstream pair_sstream(pair);
-    while (std::getline(pair_sstream, v, COMMA)) {
-      //parse as double
-      if (dim == 0) {
-        p.first = atof(v.c_str());
-      } else {
-        p.second = atof(v.c_str());
-      }
-      dim++;
-    }
-
-    if (dim == 2) {
-      vertices.push_back(p);
-    } else {
-      return false;
+int write_recognitions(const std::string& output_path,
+                       const types::tower_recognitions_map_t& tower_recognitions,
+                       const types::id_set_t& vehicles,
+                       const types::id_set_t& timesteps,
+                       const process_options_t& options) {
+  if (options.handoffs) {
+    handoff::handoff_graph_t graph;
+    handoff::build_handoff_graph(tower_recognitions, graph);
+
+    int handoff_output_stat = output::write_handoff_output(output_path, graph);
+    if (handoff_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write handoff output" << std::endl;
+      return handoff_output_stat;
     }
   }
 
-  //shape assumes greater than a single vertex
-  return vertices.size() > 1;
-}
+  if (options.tower_load) {
+    load::tower_load_t tower_load;
+    load::compute_tower_load(tower_recognitions, tower_load);
 
-/**
- * Load the xml document from a path, execute handler, free memory
- * @param path    the path to the file
- * @param handler the lifetime of the xml in memory
- * @return success or failure
- */
-[[nodiscard]] bool load_from_path(const std::string& path, std::function<void(const rapidxml::xml_document<>&)> handler) {
-  //get the filesize and allocate space
-  uint64_t filesize = get_size(path);
-  char *buff = (char*) malloc(sizeof(char) * (filesize + 1));
-
-  FILE *xml_file = fopen(path.c_str(), "rb");
-  if (fread(buff, filesize, 1, xml_file) == 0) {
-    std::cout << "ERR: failed to read from " << path << std::endl;
-    free(buff);
-    fclose(xml_file);
-    return false;
+    int load_output_stat = output::write_tower_load_output(output_path, tower_load);
+    if (load_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write tower load output" << std::endl;
+      return load_output_stat;
+    }
   }
-  fclose(xml_file);
 
-  buff[filesize] = 0;
-
-  rapidxml::xml_document<> doc;
-
-  bool success = true;
-
-  try {
-    //parse from the buffer
-    doc.parse<0>(buff);
-  } catch (rapidxml::parse_error& e) {
-    std::cerr << "ERR: parse error: " << e.what() << std::endl;
-    success = false;
-  } catch (...) {
-    std::cerr << "ERR: parse error" << std::endl;
-    success = false;
+  if (options.arrow) {
+    int arrow_output_stat = output::write_recognitions_arrow(output_path, tower_recognitions, vehicles);
+    if (arrow_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write recognitions arrow output" << std::endl;
+      return arrow_output_stat;
+    }
   }
 
-  if (success) {
-    try {
-      //call the handler
-      handler(doc);
-    } catch (...) {
-      std::cerr << "ERR handler for " << path << " threw exception" << std::endl;
-      success = false;
+  if (options.packed) {
+    //decimetres unless distances are already quantized
+    int packed_output_stat = output::write_packed_recognition_output(output_path,
+                                                                     tower_recognitions,
+                                                                     vehicles,
+                                                                     (options.dist_quantum > 0) ? 1.0 / options.dist_quantum : 10.0,
+                                                                     options.codec);
+    if (packed_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write packed recognition output" << std::endl;
+      return packed_output_stat;
     }
   }
 
-  //free the buffer (always)
-  free(buff);
-
-  return success;
-}
-
-/**
- * Calculate the distance between two points
- * @param  x0,y0 first point
- * @param  x1,y1 second point
- * @return cartesian distance
- */
-inline double distance(double x0, double y0,
-                       double x1, double y1) {
-  return sqrt(pow(x1 - x0, 2) + pow(y1 - y0, 2));
-}
-
-/**
- * Add a tower recognition collector if not already set for this id
- * @param  tower_id           the id of the tower
- * @param  tower_recognitions all tower recognitions
- * @return                    the tower recognition collector
- */
-types::tower_recognitions_t& add_tower(std::string&& tower_id,
-                                       std::unordered_map<std::string, std::unique_ptr<types::tower_recognitions_t>>& tower_recognitions) {
-  std::unordered_map<std::string, std::unique_ptr<types::tower_recognitions_t>>::iterator it = tower_recognitions.find(tower_id);
-  if (it != tower_recognitions.end()) {
-    return *it->second;
-  }
-
-  //add new
-  tower_recognitions.insert(std::make_pair(
-    tower_id,
-    std::make_unique<types::tower_recognitions_t>(tower_id)
-  ));
-  return add_tower(std::move(tower_id), tower_recognitions);
+  if (options.intervals) {
+    return output::write_tower_interval_output(output_path, tower_recognitions, vehicles);
+  }
+  return output::write_tower_output(output_path, tower_recognitions, vehicles, timesteps);
 }
 
 /**
@@ -216,13 +189,32 @@ types::tower_recognitions_t& add_tower(std::string&& tower_id,
  * @param tower             the tower
  * @param seen_node         the list of recognition points
  * @param vehicles          set of unique vehicle ids
+ * @param timesteps         set of timesteps with recognitions
+ * @param filter            vehicles outside the filter sample and recognitions outside its time window are dropped
+ * @return                  the number of recognition points added
  */
-void add_recognition_points(types::tower_recognitions_t& tower,
+size_t add_recognition_points(types::tower_recognitions_t& tower,
                             rapidxml::xml_node<> *seen_node,
-                            std::set<std::string>& vehicles,
-                            std::set<std::string>& timesteps) {
-  //extract the attributes
-  std::string vehicle_id = "-";
+                            types::id_set_t& vehicles,
+                            types::id_set_t& timesteps,
+                            const filter::input_filter_t& filter) {
+  sample::vehicle_sample_t *sample = filter.sample;
+  if (sample) {
+    //drop vehicles outside the sample before parsing anything else
+    rapidxml::xml_attribute<> *id_attr = seen_node->first_attribute(ID_ATTR);
+    if (id_attr && !sample->keep(std::string_view(id_attr->value(), id_attr->value_size()))) {
+      sample->contacts_dropped++;
+      for (rapidxml::xml_node<> *rp_node = seen_node->first_node(RECOGNITION_POINT_NODE);
+           rp_node;
+           rp_node = rp_node->next_sibling()) {
+        sample->points_dropped++;
+      }
+      return 0;
+    }
+  }
+
+  //extract the attributes (lookup keys: short ids stay in the small string buffer)
+  std::pmr::string vehicle_id = "-";
   double tower_x = 0.0;
   double tower_y = 0.0;
 
@@ -233,15 +225,15 @@ void add_recognition_points(types::tower_recognitions_t& tower,
        sn_attr = sn_attr->next_attribute()) {
 
     if (strcmp(sn_attr->name(), ID_ATTR) == 0) {
-      vehicle_id = std::string(sn_attr->value());
+      vehicle_id.assign(sn_attr->value(), sn_attr->value_size());
       not_found--;
 
     } else if (strcmp(sn_attr->name(), OBSERVER_POS_END_ATTR) == 0) {
       std::string tower_pos = std::string(sn_attr->value());
       //parse the tower position
-      if (!parse_position(tower_pos, tower_x, tower_y)) {
+      if (!parse::parse_position(tower_pos, tower_x, tower_y)) {
         std::cerr << "ERR unable to parse tower position " << tower_pos << std::endl;
-        return;
+        return 0;
       }
       not_found--;
     }
@@ -249,20 +241,32 @@ void add_recognition_points(types::tower_recognitions_t& tower,
 
   if (not_found) {
     std::cerr << "ERR unable to find " << not_found << " (seen) recognition point attributes" << std::endl;
-    return;
+    return 0;
   }
 
-  //track this vehicle by id
-  vehicles.insert(vehicle_id);
+  //track this vehicle by id (with a time window, once it has a recognition in the window)
+  if (!filter.windowed) {
+    vehicles.insert(vehicle_id);
+  }
 
   //track the tower position
   tower.set_position(tower_x, tower_y);
 
+  size_t added = 0;
+
   //add recognition points
   for (rapidxml::xml_node<> *rp_node = seen_node->first_node(RECOGNITION_POINT_NODE);
        rp_node;
        rp_node = rp_node->next_sibling()) {
-    std::string ts;
+    if (filter.windowed) {
+      //skip recognitions outside the time window before anything else is parsed
+      rapidxml::xml_attribute<> *t_attr = rp_node->first_attribute(T_ATTR);
+      if (t_attr && !filter.keep_time((int) atof(t_attr->value()))) {
+        continue;
+      }
+    }
+
+    std::pmr::string ts;
     double v_x = 0.0;
     double v_y = 0.0;
 
@@ -275,14 +279,15 @@ void add_recognition_points(types::tower_recognitions_t& tower,
       if (strcmp(rp_attr->name(), T_ATTR) == 0) {
         //because we simulate at the granularity of seconds, truncate
         double ts_d = atof(rp_attr->value());
-        ts = std::to_string((int) ts_d);
+        char ts_buff[16];
+        ts.assign(ts_buff, snprintf(ts_buff, sizeof(ts_buff), "%d", (int) ts_d));
         not_found--;
 
       } else if (strcmp(rp_attr->name(), SEEN_POS_ATTR) == 0) {
         std::string seen_pos = std::string(rp_attr->value());
-        if (!parse_position(seen_pos, v_x, v_y)) {
+        if (!parse::parse_position(seen_pos, v_x, v_y)) {
           std::cerr << "ERR unable to parse vehicle position " << seen_pos << std::endl;
-          return;
+          return added;
         }
 
         not_found--;
@@ -291,30 +296,46 @@ void add_recognition_points(types::tower_recognitions_t& tower,
 
     if (not_found) {
       std::cerr << "ERR unable to find " << not_found << " recognition point attributes" << std::endl;
-      return;
+      return added;
     }
 
     //record the timestep
     timesteps.insert(ts);
+    if (filter.windowed && (added == 0)) {
+      vehicles.insert(vehicle_id);
+    }
 
     //add the recognition point
     tower.add_recognition(
-      std::move(ts),
-      std::move(vehicle_id),
+      ts,
+      vehicle_id,
       distance(tower_x, tower_y, v_x, v_y)
     );
+    added++;
+  }
+
+  if (sample) {
+    sample->contacts_kept++;
+    sample->points_kept += added;
   }
+  return added;
 }
 
 /**
  * Add an edge to the lookup
  * @param edge_node   the xml node in the net file
- * @param edges       all edge ids in the network
- * @param edge_shapes the shapes of all edges
+ * @param edges           all edge ids in the network
+ * @param edge_shapes     the shapes of all edges
+ * @param internal_shapes if set, the shapes of internal (junction) lanes are recorded here
+ * @param region          if set, lanes entirely outside the region are skipped
+ * @return                the number of lanes skipped
  */
-void add_edge(rapidxml::xml_node<> *edge_node,
-              std::set<std::string>& edges,
-              std::unordered_map<std::string, std::unique_ptr<types::road_edge_t>>& edge_shapes) {
+size_t add_edge(rapidxml::xml_node<> *edge_node,
+                types::id_set_t& edges,
+                types::road_edge_map_t& edge_shapes,
+                types::road_edge_map_t *internal_shapes = nullptr,
+                const filter::region_t *region = nullptr) {
+  bool internal = false;
 
   //get the edge attributes
   for (rapidxml::xml_attribute<> *edge_attr = edge_node->first_attribute();
@@ -323,18 +344,26 @@ void add_edge(rapidxml::xml_node<> *edge_node,
     //check the attribute name
     if ((strcmp(edge_attr->name(),  FUNCTION_ATTR) == 0) &&
         (strcmp(edge_attr->value(), INTERNAL_VAL) == 0)) {
-      //ignore edges with internal function
-      return;
+      internal = true;
     }
   }
 
+  if (internal && (internal_shapes == nullptr)) {
+    //ignore edges with internal function
+    return 0;
+  }
+
+  size_t skipped = 0;
+
   //get lanes
   for (rapidxml::xml_node<> *lane_node = edge_node->first_node(LANE_NODE);
        lane_node;
        lane_node = lane_node->next_sibling()) {
 
-    std::string lane_id;
+    //copied once the lane is known to be kept
+    std::string_view lane_id;
     std::vector<std::pair<double, double>> vertices;
+    double length = -1;
     int not_found = 2;
 
     //look at attributes for lane
@@ -343,41 +372,88 @@ void add_edge(rapidxml::xml_node<> *edge_node,
          lane_attr = lane_attr->next_attribute()) {
 
       if (strcmp(lane_attr->name(), ID_ATTR) == 0) {
-        lane_id = std::string(lane_attr->value());
+        lane_id = std::string_view(lane_attr->value(), lane_attr->value_size());
         not_found--;
 
+      } else if (strcmp(lane_attr->name(), LENGTH_ATTR) == 0) {
+        length = atof(lane_attr->value());
+
       } else if (strcmp(lane_attr->name(), SHAPE_ATTR) == 0) {
         std::string shape = std::string(lane_attr->value());
         not_found--;
 
         //parse vertex pairs
-        if (!parse_shape(shape, vertices)) {
+        if (!parse::parse_shape(shape, vertices)) {
           std::cerr << "ERR: failed to parse shape: " << shape << std::endl;
-          return;
+          return skipped;
         }
       }
     }
 
     if (not_found > 0) {
       std::cerr << "ERR: lane missing id or shape" << std::endl;
-      return;
+      return skipped;
+    }
+
+    if (region && !region->intersects(vertices)) {
+      skipped++;
+      continue;
+    }
+
+    //add to lookups (internal lanes are not segments)
+    if (!internal) {
+      edges.insert(std::pmr::string(lane_id));
     }
 
-    //add to lookups
-    edges.insert(lane_id);
+    //constructed in the map's arena (keeps the first shape for duplicate ids)
+    std::pair<types::road_edge_map_t::iterator,bool> inserted
+      = (internal ? *internal_shapes : edge_shapes).try_emplace(std::pmr::string(lane_id));
 
-    std::unique_ptr<types::road_edge_t> edge = std::make_unique<types::road_edge_t>();
+    if (inserted.second) {
+      inserted.first->second.set_length(length);
 
-    //add the parsed vertices
-    for (size_t i=0; i<vertices.size(); i++) {
-      edge->add_vertex(
-        vertices.at(i).first,
-        vertices.at(i).second
-      );
+      //add the parsed vertices
+      for (size_t i=0; i<vertices.size(); i++) {
+        inserted.first->second.add_vertex(
+          vertices.at(i).first,
+          vertices.at(i).second
+        );
+      }
     }
+  }
+  return skipped;
+}
 
-    //add to lookup
-    edge_shapes.insert(std::make_pair(lane_id, std::move(edge)));
+/**
+ * Record the segment of a vehicle (and its trajectory sample) for a given timestep
+ * @param  vehicle_id        the vehicle id
+ * @param  lane_id           the lane the vehicle is on
+ * @param  segment_id        the segment the vehicle is on (the lane, or its edge for edge segments)
+ * @param  timestep          the current simulation timestep
+ * @param  pos               the position along the lane
+ * @param  speed             the vehicle speed
+ * @param  vehicle_lane_hist the history lookup
+ * @param  trajectories      if set, lane positions and speeds are recorded here
+ */
+void record_vehicle(const std::pmr::string& vehicle_id,
+                    const std::pmr::string& lane_id,
+                    const std::pmr::string& segment_id,
+                    int timestep,
+                    double pos,
+                    double speed,
+                    types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                    types::trajectory_table_t *trajectories) {
+  //add the mapping
+  types::vehicle_lane_hist_map_t::iterator it = vehicle_lane_hist.find(vehicle_id);
+  if (it != vehicle_lane_hist.end()) {
+    it->second.at_segment(segment_id, timestep);
+  } else {
+    //add new (constructed in the map's arena w/ initial values)
+    vehicle_lane_hist.try_emplace(vehicle_id, segment_id, timestep);
+  }
+
+  if (trajectories) {
+    trajectories->add(vehicle_id, lane_id, timestep, (float) pos, (float) speed);
   }
 }
 
@@ -386,16 +462,35 @@ void add_edge(rapidxml::xml_node<> *edge_node,
  * @param  edge_node         the edge node
  * @param  timestep          the current simulation timestep
  * @param  vehicle_lane_hist the history lookup
+ * @param  trajectories      if set, lane positions and speeds are recorded here
+ * @param  filter            vehicles outside the filter (sample, region of interest) are dropped
+ * @return                   the number of vehicle entries read
  */
-void add_vehicle_hist(rapidxml::xml_node<> *edge_node,
+size_t add_vehicle_hist(rapidxml::xml_node<> *edge_node,
                       int timestep,
-                      std::unordered_map<std::string,std::unique_ptr<types::vehicle_lane_hist_t>>& vehicle_lane_hist) {
+                      types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                      types::trajectory_table_t *trajectories,
+                      const filter::input_filter_t& filter) {
+  sample::vehicle_sample_t *sample = filter.sample;
+  size_t entries = 0;
+
+  //the segment of the vehicles on every lane of the edge (edge segments)
+  std::pmr::string edge_id;
+  if (filter.edge_segments) {
+    rapidxml::xml_attribute<> *edge_attr = edge_node->first_attribute(ID_ATTR);
+    if (edge_attr == NULL) {
+      std::cerr << "ERR edge id not found" << std::endl;
+      throw std::exception();
+    }
+    edge_id.assign(edge_attr->value(), edge_attr->value_size());
+  }
+
   //get each lane
   for (rapidxml::xml_node<> *lane_node = edge_node->first_node(LANE_NODE);
        lane_node;
        lane_node = lane_node->next_sibling()) {
-    //parse the lane id
-    std::string lane_id;
+    //parse the lane id (lookup key: short ids stay in the small string buffer)
+    std::pmr::string lane_id;
     bool lane_id_found = false;
 
     for (rapidxml::xml_attribute<> *lane_attr = lane_node->first_attribute();
@@ -403,7 +498,7 @@ void add_vehicle_hist(rapidxml::xml_node<> *edge_node,
          lane_attr = lane_attr->next_attribute()) {
       //check the attribute name
       if (strcmp(lane_attr->name(), ID_ATTR) == 0) {
-        lane_id = std::string(lane_attr->value());
+        lane_id.assign(lane_attr->value(), lane_attr->value_size());
         lane_id_found = true;
       }
     }
@@ -413,21 +508,32 @@ void add_vehicle_hist(rapidxml::xml_node<> *edge_node,
       throw std::exception();
     }
 
+    if (!filter.keep_lane(lane_id)) {
+      //outside the region of interest
+      continue;
+    }
+
     //get vehicles in the lane
     for (rapidxml::xml_node<> *vehicle_node = lane_node->first_node(VEHICLE_NODE);
          vehicle_node;
          vehicle_node = vehicle_node->next_sibling()) {
-      //parse the id
-      std::string vehicle_id;
+      //parse the id (copied once the vehicle is known to be recorded)
+      std::string_view vehicle_id;
       bool vehicle_id_found = false;
+      double pos = 0.0;
+      double speed = 0.0;
 
       for (rapidxml::xml_attribute<> *vehicle_attr = vehicle_node->first_attribute();
            vehicle_attr;
            vehicle_attr = vehicle_attr->next_attribute()) {
         //check the attribute name
         if (strcmp(vehicle_attr->name(), ID_ATTR) == 0) {
-          vehicle_id = std::string(vehicle_attr->value());
+          vehicle_id = std::string_view(vehicle_attr->value(), vehicle_attr->value_size());
           vehicle_id_found = true;
+        } else if (trajectories && (strcmp(vehicle_attr->name(), POS_ATTR) == 0)) {
+          pos = atof(vehicle_attr->value());
+        } else if (trajectories && (strcmp(vehicle_attr->name(), SPEED_ATTR) == 0)) {
+          speed = atof(vehicle_attr->value());
         }
       }
 
@@ -436,106 +542,125 @@ void add_vehicle_hist(rapidxml::xml_node<> *edge_node,
         throw std::exception();
       }
 
+      entries++;
+
       //check that this is not a tower
-      if (vehicle_id.rfind(TOWER_PREFIX, 0) == std::string::npos) {
-        //add the mapping
-        std::unordered_map<std::string,std::unique_ptr<types::vehicle_lane_hist_t>>::iterator it = vehicle_lane_hist.find(vehicle_id);
-        if (it != vehicle_lane_hist.end()) {
-          it->second->at_segment(lane_id, timestep);
-        } else {
-          //add new
-          vehicle_lane_hist.insert(std::make_pair(
-            vehicle_id,
-            std::make_unique<types::vehicle_lane_hist_t>(lane_id, timestep) //constructor w/ initial values
-          ));
-        }
+      if (vehicle_id.rfind(TOWER_PREFIX, 0) != std::string_view::npos) {
+        continue;
+      }
+
+      if (sample && !sample->keep(vehicle_id)) {
+        sample->entries_dropped++;
+        continue;
+      } else if (sample) {
+        sample->entries_kept++;
       }
+
+      record_vehicle(std::pmr::string(vehicle_id), lane_id, filter.edge_segments ? edge_id : lane_id,
+                     timestep, pos, speed, vehicle_lane_hist, trajectories);
     }
   }
+  return entries;
 }
 
 /**
- * Read the output files and generate an aggregated report
- * @param  bt_output_path       the path to the bluetooth output file
- * @param  net_input_path       the path to the sumo network input file (input to simulation)
- * @param  raw_output_path      the raw simulation output to follow vehicle progress
- * @param  output_path          the path to a folder to write output files to
- * @return                      success or failure
+ * Reconstruct the positions of the vehicles on an edge for a given timestep
+ * @param  edge_node       the edge node (netstate)
+ * @param  edge_shapes     the shapes of all lanes
+ * @param  internal_shapes the shapes of internal (junction) lanes
+ * @param  grid            the grid to add vehicle positions to
+ * @param  filter          vehicles outside the filter (sample, region of interest) are not positioned
+ * @return                 the number of vehicle entries read
  */
-int process_output_data(const std::string& bt_output_path,
-                        const std::string& net_input_path,
-                        const std::string& raw_output_path,
-                        const std::string& output_path) {
-  //construct a mapping from tower id to all recognition points
-  std::unordered_map<std::string, std::unique_ptr<types::tower_recognitions_t>> tower_recognitions;
-  //sets of tower, vehicle ids, timesteps
-  std::set<std::string> towers;
-  std::set<std::string> vehicles;
-  std::set<std::string> timesteps;
+size_t add_vehicle_positions(rapidxml::xml_node<> *edge_node,
+                             const types::road_edge_map_t& edge_shapes,
+                             const types::road_edge_map_t& internal_shapes,
+                             what_if::vehicle_grid_t& grid,
+                             const filter::input_filter_t& filter) {
+  const sample::vehicle_sample_t *sample = filter.sample;
+  size_t entries = 0;
+  std::pmr::string lane_id;
 
-  //load the bt xml file, add recognitions to map
-  if (!load_from_path(bt_output_path, [&tower_recognitions, &towers, &vehicles, &timesteps] (const rapidxml::xml_document<>& doc) {
-
-    //verify the name of the root node
-    if (strcmp(doc.first_node()->name(), BT_OUTPUT_NODE) != 0) {
-      std::cerr << "ERR doc root node not: " << BT_OUTPUT_NODE << std::endl;
+  //get each lane
+  for (rapidxml::xml_node<> *lane_node = edge_node->first_node(LANE_NODE);
+       lane_node;
+       lane_node = lane_node->next_sibling()) {
+    rapidxml::xml_attribute<> *lane_attr = lane_node->first_attribute(ID_ATTR);
+    if (lane_attr == NULL) {
+      std::cerr << "ERR lane id not found" << std::endl;
       throw std::exception();
     }
+    lane_id.assign(lane_attr->value(), lane_attr->value_size());
+
+    //find the lane shape
+    types::road_edge_map_t::const_iterator shape = edge_shapes.find(lane_id);
+    if (shape == edge_shapes.end()) {
+      shape = internal_shapes.find(lane_id);
+      if ((shape == internal_shapes.end()) && filter.region) {
+        //lanes outside the region of interest are not in the network
+        continue;
+      } else if (shape == internal_shapes.end()) {
+        std::cerr << "ERR lane not in network: " << lane_id << std::endl;
+        throw std::exception();
+      }
+    }
 
-    //get each tower
-    for (rapidxml::xml_node<> *tower_node = doc.first_node(BT_OUTPUT_NODE)->first_node(BT_NODE);
-         tower_node;
-         tower_node = tower_node->next_sibling()) {
-
-      //get the timestep
-      for (rapidxml::xml_attribute<> *tower_attr = tower_node->first_attribute();
-           tower_attr;
-           tower_attr = tower_attr->next_attribute()) {
-        //check the attribute name
-        if (strcmp(tower_attr->name(), ID_ATTR) == 0) {
-          std::string tower_id = std::string(tower_attr->value());
+    //get vehicles in the lane
+    for (rapidxml::xml_node<> *vehicle_node = lane_node->first_node(VEHICLE_NODE);
+         vehicle_node;
+         vehicle_node = vehicle_node->next_sibling()) {
+      std::string_view vehicle_id;
+      double pos = 0.0;
+      int not_found = 2;
 
-          towers.insert(tower_id);
+      for (rapidxml::xml_attribute<> *vehicle_attr = vehicle_node->first_attribute();
+           vehicle_attr;
+           vehicle_attr = vehicle_attr->next_attribute()) {
+        if (strcmp(vehicle_attr->name(), ID_ATTR) == 0) {
+          vehicle_id = std::string_view(vehicle_attr->value(), vehicle_attr->value_size());
+          not_found--;
+        } else if (strcmp(vehicle_attr->name(), POS_ATTR) == 0) {
+          pos = atof(vehicle_attr->value());
+          not_found--;
+        }
+      }
 
-          //create a tower
-          types::tower_recognitions_t& tower = add_tower(std::move(tower_id), tower_recognitions);
+      if (not_found) {
+        std::cerr << "ERR vehicle missing id or pos" << std::endl;
+        throw std::exception();
+      }
 
-          //add vehicle recognitions
-          for (rapidxml::xml_node<> *seen_node = tower_node->first_node(SEEN_NODE);
-               seen_node;
-               seen_node = seen_node->next_sibling()) {
+      entries++;
 
-            //add recognition points for this tower
-            add_recognition_points(tower, seen_node, vehicles, timesteps);
-          }
-        }
+      //towers placed in the simulation are not vehicles
+      double x = 0.0;
+      double y = 0.0;
+      if ((vehicle_id.rfind(TOWER_PREFIX, 0) == std::string_view::npos) &&
+          (!sample || sample->keep(vehicle_id)) &&
+          shape->second.position_at(pos, x, y)) {
+        grid.add(vehicle_id, x, y);
       }
     }
-
-  })) {
-    return EXIT_FAILURE;
   }
+  return entries;
+}
 
-  //write the tower output
-  int tower_output_stat = output::write_tower_output(output_path,
-                                                     tower_recognitions,
-                                                     vehicles,
-                                                     timesteps);
-  if (tower_output_stat != EXIT_SUCCESS) {
-    std::cerr << "ERR: failed to write tower output" << std::endl;
-    return tower_output_stat;
-  }
-
-  //clear storage that won't be used later
-  vehicles.clear();
-
-  //load network edges
-  std::set<std::string> edges;
-  //record the shapes of edges in the network
-  std::unordered_map<std::string, std::unique_ptr<types::road_edge_t>> edge_shapes;
+/**
+ * Parse the network lanes and shapes from the xml
+ * @param  net_input_path the path to the sumo network input file
+ * @param  network        the network to load into
+ * @param  internal_lanes whether to keep internal (junction) lane shapes
+ * @param  region         if set, lanes entirely outside the region are skipped
+ * @return                success or failure
+ */
+bool parse_network(const std::string& net_input_path,
+                   types::network_t& network,
+                   bool internal_lanes,
+                   const filter::region_t *region = nullptr) {
+  size_t skipped = 0;
 
   //load the network xml file
-  if (!load_from_path(net_input_path, [&edges, &edge_shapes] (const rapidxml::xml_document<>& doc) {
+  bool parsed = parse::load_from_path(net_input_path, [&network, internal_lanes, region, &skipped] (const rapidxml::xml_document<>& doc) {
     //verify the name of the root node
     if (strcmp(doc.first_node()->name(), NET_NODE) != 0) {
       std::cerr << "ERR doc root node not: " << NET_NODE << std::endl;
@@ -547,85 +672,1424 @@ int process_output_data(const std::string& bt_output_path,
          edge_node;
          edge_node = edge_node->next_sibling()) {
       //add the edge
-      add_edge(edge_node, edges, edge_shapes);
+      skipped += add_edge(edge_node, network.edges, network.edge_shapes, internal_lanes ? &network.internal_shapes : nullptr, region);
     }
+  });
 
-  })) {
-    return EXIT_FAILURE;
+  if (parsed && region) {
+    std::cerr << "INFO: " << (network.edge_shapes.size() + network.internal_shapes.size())
+              << " lanes in the region of interest (" << skipped << " skipped)" << std::endl;
   }
+  return parsed;
+}
 
-  //write the tower coverage output
-  int tower_coverage_output_stat = output::write_tower_coverage_output(output_path,
-                                                                       tower_recognitions,
-                                                                       edge_shapes,
-                                                                       edges,
-                                                                       towers);
-  if (tower_coverage_output_stat != EXIT_SUCCESS) {
-    std::cerr << "ERR: failed to write tower overage output" << std::endl;
-    return tower_coverage_output_stat;
+/**
+ * Load the network lanes and shapes (from the parsed network cache if enabled)
+ * @param  net_input_path the path to the sumo network input file
+ * @param  network        the network to load into
+ * @param  internal_lanes whether to keep internal (junction) lane shapes
+ * @param  options        run options (network cache, region of interest)
+ * @return                success or failure
+ */
+bool load_lanes(const std::string& net_input_path,
+                types::network_t& network,
+                bool internal_lanes,
+                const process_options_t& options) {
+  if (options.roi) {
+    //the cache holds the whole network: lanes outside the region are skipped while parsing instead
+    if (options.net_cache) {
+      std::cerr << "INFO: network cache not used with a region of interest" << std::endl;
+    }
+    return parse_network(net_input_path, network, internal_lanes, &*options.roi);
   }
 
-  //clear unused storage
-  edge_shapes.clear();
-  towers.clear();
+  uint64_t content_hash;
+  if (!options.net_cache || !cache::hash_file(net_input_path, content_hash)) {
+    return parse_network(net_input_path, network, internal_lanes);
+  }
 
-  //record the lanes seen by a given vehicle
-  std::unordered_map<std::string,std::unique_ptr<types::vehicle_lane_hist_t>> vehicle_lane_hist;
+  //keyed by content: an edited network gets a new cache file
+  std::string cache_path = cache::net_cache_path(net_input_path, options.cache_dir, content_hash);
+  if (cache::load_net_cache(cache_path, content_hash, network, internal_lanes)) {
+    std::cerr << "INFO: loaded network from cache: " << cache_path << std::endl;
+    return true;
+  }
 
-  //load the raw output
-  if (!load_from_path(raw_output_path, [&vehicle_lane_hist] (const rapidxml::xml_document<>& doc) {
-    //verify the name of the root node
-    if (strcmp(doc.first_node()->name(), NETSTATE_NODE) != 0) {
-      std::cerr << "ERR doc root node not: " << NETSTATE_NODE << std::endl;
-      throw std::exception();
+  //parse everything (internal lanes included) and cache it
+  {
+    types::arena_t parse_arena;
+    types::network_t& parsed = parse_arena.make<types::network_t>();
+    if (!parse_network(net_input_path, parsed, true)) {
+      return false;
     }
 
-    //get each timestep
-    for (rapidxml::xml_node<> *ts_node = doc.first_node(NETSTATE_NODE)->first_node(TIMESTEP_NODE);
-         ts_node;
-         ts_node = ts_node->next_sibling()) {
-      int ts = 0;
-      bool ts_found = false;
+    if (cache::write_net_cache(cache_path, content_hash, parsed)) {
+      std::cerr << "INFO: wrote network cache: " << cache_path << std::endl;
+    }
+  }
 
-      //parse the timestep value
-      for (rapidxml::xml_attribute<> *ts_attr = ts_node->first_attribute();
-           ts_attr;
-           ts_attr = ts_attr->next_attribute()) {
-        //check the attribute name
-        if (strcmp(ts_attr->name(), TIME_ATTR) == 0) {
-          double ts_d = atof(ts_attr->value());
-          ts = (int) ts_d;
-          ts_found = true;
-        }
-      }
+  //loaded from the cache so both paths build the same network
+  return cache::load_net_cache(cache_path, content_hash, network, internal_lanes) ||
+         parse_network(net_input_path, network, internal_lanes);
+}
 
-      if (!ts_found) {
-        std::cerr << "ERR no timestep attribute" << std::endl;
-        throw std::exception();
+/**
+ * Group the lanes of each edge into one segment (lane segments are replaced)
+ * @param network the network (lanes loaded)
+ */
+void group_edge_segments(types::network_t& network) {
+  //the lanes of each edge and their indices (ids are views of the lane ids)
+  std::unordered_map<std::string_view,std::vector<std::pair<int,const types::road_edge_t*>>> edge_lanes;
+  types::id_set_t edge_ids(network.edges.get_allocator());
+
+  for (const std::pmr::string& lane_id : network.edges) {
+    types::road_edge_map_t::const_iterator lane = network.edge_shapes.find(lane_id);
+    if (lane != network.edge_shapes.end()) {
+      std::string_view edge_id = types::lane_edge_id(lane_id);
+      edge_lanes[edge_id].emplace_back(types::lane_index(lane_id), &lane->second);
+      edge_ids.insert(std::pmr::string(edge_id));
+    }
+  }
+
+  for (std::pair<const std::string_view,std::vector<std::pair<int,const types::road_edge_t*>>>& edge : edge_lanes) {
+    //lane ids are in string order (_10 before _2): order by lane index
+    std::sort(edge.second.begin(), edge.second.end(),
+      [] (const std::pair<int,const types::road_edge_t*>& a, const std::pair<int,const types::road_edge_t*>& b) {
+        return a.first < b.first;
+      });
+
+    std::vector<const types::road_edge_t*> lanes;
+    for (const std::pair<int,const types::road_edge_t*>& lane : edge.second) {
+      lanes.push_back(lane.second);
+    }
+    types::road_edge_t& shape = network.edge_segment_shapes.try_emplace(std::pmr::string(edge.first)).first->second;
+
+    //lanes of an edge are usually offset copies of each other: average them into the center line
+    bool aligned = true;
+    for (const types::road_edge_t *lane : lanes) {
+      aligned &= (lane->get_vertices().size() == lanes[0]->get_vertices().size());
+    }
+
+    if (aligned) {
+      double length = 0.0;
+      for (const types::road_edge_t *lane : lanes) {
+        length += lane->get_length();
+      }
+      shape.set_length(length / lanes.size());
+
+      for (size_t i=0; i<lanes[0]->get_vertices().size(); i++) {
+        double x = 0.0;
+        double y = 0.0;
+        for (const types::road_edge_t *lane : lanes) {
+          x += lane->get_vertices()[i].first;
+          y += lane->get_vertices()[i].second;
+        }
+        shape.add_vertex(x / lanes.size(), y / lanes.size());
       }
 
-      //get each edge
-      for (rapidxml::xml_node<> *edge_node = ts_node->first_node(EDGE_NODE);
-           edge_node;
-           edge_node = edge_node->next_sibling()) {
-        add_vehicle_hist(edge_node, ts, vehicle_lane_hist);
+    } else {
+      //the middle lane is representative
+      const types::road_edge_t *middle = lanes[lanes.size() / 2];
+      shape.set_length(middle->get_length());
+      for (const std::pair<double,double>& vertex : middle->get_vertices()) {
+        shape.add_vertex(vertex.first, vertex.second);
       }
     }
+  }
 
-  })) {
-    return EXIT_FAILURE;
+  std::cerr << "INFO: " << network.edges.size() << " lanes grouped into " << edge_ids.size() << " edge segments" << std::endl;
+
+  //segments are edges from here on (the lane shapes still position vehicles)
+  network.edges.swap(edge_ids);
+  network.edge_segments = true;
+}
+
+/**
+ * Load the network lanes and shapes (from the parsed network cache if enabled)
+ * @param  net_input_path the path to the sumo network input file
+ * @param  network        the network to load into
+ * @param  internal_lanes whether to keep internal (junction) lane shapes
+ * @param  options        run options (network cache, region of interest, edge segments)
+ * @return                success or failure
+ */
+bool load_network(const std::string& net_input_path,
+                  types::network_t& network,
+                  bool internal_lanes,
+                  const process_options_t& options) {
+  if (!load_lanes(net_input_path, network, internal_lanes, options)) {
+    return false;
   }
 
-  //write the vehicle history output
-  int vehicle_hist_output_stat = output::write_vehicle_output(output_path,
-                                                              vehicle_lane_hist,
-                                                              edges,
-                                                              timesteps);
-  if (vehicle_hist_output_stat != EXIT_SUCCESS) {
-    std::cerr << "ERR: failed to write tower overage output, skipping remaining output artifacts" << std::endl;
-    return vehicle_hist_output_stat;
+  if (options.edge_segments) {
+    group_edge_segments(network);
   }
+  return true;
+}
 
-  return EXIT_SUCCESS;
-  //TODO remaining
+/**
+ * Get the outputs of the tower stage (recognitions)
+ * @param  options run options
+ * @return         the output filenames
+ */
+std::vector<std::string> tower_stage_outputs(const process_options_t& options) {
+  //json outputs carry the compression suffix
+  std::vector<std::string> outputs = {output::output_filename(options.intervals ? TOWER_INTERVAL_FILENAME : TOWER_OUTPUT_FILENAME)};
+  if (options.handoffs) {
+    outputs.push_back(output::output_filename(HANDOFF_FILENAME));
+  }
+  if (options.tower_load) {
+    outputs.push_back(TOWER_LOAD_FILENAME);
+    outputs.push_back(TOWER_LOAD_SUMMARY_FILENAME);
+  }
+  if (options.arrow) {
+    outputs.push_back(RECOGNITIONS_ARROW_FILENAME);
+  }
+  if (options.packed) {
+    outputs.push_back(PACKED_RECOGNITION_FILENAME);
+  }
+  return outputs;
+}
+
+/**
+ * Get the outputs of the vehicle stage (netstate)
+ * @param  options run options
+ * @return         the output filenames
+ */
+std::vector<std::string> vehicle_stage_outputs(const process_options_t& options) {
+  std::vector<std::string> outputs = {output::output_filename(VEHICLE_HIST_FILENAME)};
+  if (options.trajectories) {
+    outputs.push_back(TRAJECTORY_FILENAME);
+  }
+  if (options.arrow) {
+    outputs.push_back(VEHICLE_HIST_ARROW_FILENAME);
+  }
+  if (options.packed) {
+    outputs.push_back(PACKED_HISTORY_FILENAME);
+  }
+  return outputs;
+}
+
+/**
+ * Get the region of interest as a stage input
+ * @param  options run options
+ * @return         the region polygon (null for none)
+ */
+nlohmann::json roi_input(const process_options_t& options) {
+  if (!options.roi) {
+    return nullptr;
+  }
+  nlohmann::json polygon = nlohmann::json::array();
+  for (const std::pair<double,double>& vertex : options.roi->polygon) {
+    polygon.push_back({vertex.first, vertex.second});
+  }
+  return polygon;
+}
+
+/**
+ * Get the time window as a stage input
+ * @param  options run options
+ * @return         the window start, end and stride (null for none)
+ */
+nlohmann::json window_input(const process_options_t& options) {
+  if (!options.windowed) {
+    return nullptr;
+  }
+  return {options.t_start, options.t_end, options.stride};
+}
+
+/**
+ * Get the inputs of the vehicle stage: the vehicle history depends on the bt output
+ * only through the set of timesteps with recognitions
+ * @param  raw_hash       the netstate content hash
+ * @param  net_hash       the network content hash
+ * @param  timesteps_hash the hash of the timesteps with recognitions
+ * @param  options        run options
+ * @return                the stage inputs
+ */
+nlohmann::json vehicle_stage_inputs(uint64_t raw_hash,
+                                    uint64_t net_hash,
+                                    uint64_t timesteps_hash,
+                                    const process_options_t& options) {
+  return {
+    {NETSTATE_INPUT, cache::hash_hex(raw_hash)},
+    {NETWORK_INPUT, cache::hash_hex(net_hash)},
+    {TIMESTEPS_INPUT, cache::hash_hex(timesteps_hash)},
+    {"trajectories", options.trajectories},
+    {"arrow", options.arrow},
+    {"packed", options.packed},
+    {"codec", options.codec},
+    {"roi", roi_input(options)},
+    {"window", window_input(options)},
+    {"edge_segments", options.edge_segments},
+    {"compression", output::get_compression()},
+    {"format", output::get_format()}
+  };
+}
+
+/**
+ * Hash a set of ids (in order)
+ * @param  ids the ids
+ * @return     the hash
+ */
+uint64_t hash_ids(const types::id_set_t& ids) {
+  uint64_t hash = FNV_OFFSET;
+  for (const std::pmr::string& id : ids) {
+    //include the terminator so ids can't run together
+    hash = cache::fnv1a(id.c_str(), id.size() + 1, hash);
+  }
+  return hash;
+}
+
+/**
+ * Get what is kept from the inputs
+ * @param  options run options (region of interest, time window, edge segments)
+ * @param  sample  the vehicles kept (null for all)
+ * @return         the input filter (lanes are only filtered once the network is set)
+ */
+filter::input_filter_t input_filter(const process_options_t& options, sample::vehicle_sample_t *sample) {
+  filter::input_filter_t filter;
+  filter.sample = sample;
+  filter.region = options.roi ? &*options.roi : nullptr;
+  filter.windowed = options.windowed;
+  filter.t_start = options.t_start;
+  filter.t_end = options.t_end;
+  filter.stride = options.stride;
+  filter.edge_segments = options.edge_segments;
+  return filter;
+}
+
+/**
+ * Check if a netstate timestep is kept from its text (before it is parsed)
+ * @param  elem   the timestep element text
+ * @param  size   the element size
+ * @param  filter the input filter (time window)
+ * @return        whether the timestep is kept
+ */
+bool keep_timestep_text(const char *elem, size_t size, const filter::input_filter_t& filter) {
+  //the time attribute of the opening tag
+  std::string_view text(elem, size);
+  std::string_view open_tag = text.substr(0, text.find('>'));
+  size_t at = open_tag.find(" " TIME_ATTR "=\"");
+  if (at == std::string_view::npos) {
+    //reported when parsed
+    return true;
+  }
+  //because we simulate at the granularity of seconds, truncate
+  return filter.keep_time((int) atof(elem + at + sizeof(" " TIME_ATTR "=\"") - 1));
+}
+
+/**
+ * Add the vehicle lanes (and positions) of a netstate timestep
+ * @param ts_node           the timestep node
+ * @param vehicle_lane_hist lanes seen by each vehicle
+ * @param trajectories      if set, vehicle lane positions are recorded here
+ * @param filter            vehicles (and timesteps) outside the filter are dropped
+ */
+void add_timestep(rapidxml::xml_node<> *ts_node,
+                  types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                  types::trajectory_table_t *trajectories,
+                  const filter::input_filter_t& filter) {
+  int ts = 0;
+  bool ts_found = false;
+
+  //parse the timestep value
+  for (rapidxml::xml_attribute<> *ts_attr = ts_node->first_attribute();
+       ts_attr;
+       ts_attr = ts_attr->next_attribute()) {
+    //check the attribute name
+    if (strcmp(ts_attr->name(), TIME_ATTR) == 0) {
+      double ts_d = atof(ts_attr->value());
+      ts = (int) ts_d;
+      ts_found = true;
+    }
+  }
+
+  if (!ts_found) {
+    std::cerr << "ERR no timestep attribute" << std::endl;
+    throw std::exception();
+  }
+
+  if (!filter.keep_time(ts)) {
+    //outside the time window
+    return;
+  }
+
+  //get each edge
+  for (rapidxml::xml_node<> *edge_node = ts_node->first_node(EDGE_NODE);
+       edge_node;
+       edge_node = edge_node->next_sibling()) {
+    stats::phase_elements(add_vehicle_hist(edge_node, ts, vehicle_lane_hist, trajectories, filter));
+  }
+}
+
+/**
+ * Parse the raw simulation output (as it is written in follow mode)
+ * @param  raw_output_path   the raw simulation output to follow vehicle progress
+ * @param  vehicle_lane_hist lanes seen by each vehicle
+ * @param  trajectories      if set, vehicle lane positions are recorded here
+ * @param  filter            vehicles (and timesteps) outside the filter are dropped
+ * @param  options           run options
+ * @return                   success or failure
+ */
+bool parse_netstate(const std::string& raw_output_path,
+                    types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                    types::trajectory_table_t *trajectories,
+                    const filter::input_filter_t& filter,
+                    const process_options_t& options) {
+  if (options.follow || filter.windowed) {
+    //each timestep is processed once its closing tag is written (or read, timesteps outside
+    //the time window are not parsed)
+    return stream::follow_elements(raw_output_path, NETSTATE_NODE, options.follow, options.follow_timeout * 1000,
+      [&vehicle_lane_hist, trajectories, &filter] (rapidxml::xml_node<> *ts_node) {
+        if (strcmp(ts_node->name(), TIMESTEP_NODE) == 0) {
+          add_timestep(ts_node, vehicle_lane_hist, trajectories, filter);
+        }
+      },
+      [&filter] (const char *elem, size_t size) {
+        return keep_timestep_text(elem, size, filter);
+      });
+  }
+
+  //load the raw output
+  return parse::load_from_path(raw_output_path, [&vehicle_lane_hist, trajectories, &filter] (const rapidxml::xml_document<>& doc) {
+    //verify the name of the root node
+    if (strcmp(doc.first_node()->name(), NETSTATE_NODE) != 0) {
+      std::cerr << "ERR doc root node not: " << NETSTATE_NODE << std::endl;
+      throw std::exception();
+    }
+
+    //get each timestep
+    for (rapidxml::xml_node<> *ts_node = doc.first_node(NETSTATE_NODE)->first_node(TIMESTEP_NODE);
+         ts_node;
+         ts_node = ts_node->next_sibling()) {
+      add_timestep(ts_node, vehicle_lane_hist, trajectories, filter);
+    }
+  });
+}
+
+/**
+ * Write the vehicle history (and trajectory, arrow, packed) outputs
+ * @param  output_path       the path to a folder to write output files to
+ * @param  network           the network
+ * @param  timesteps         timesteps with recognitions
+ * @param  vehicle_lane_hist lanes seen by each vehicle
+ * @param  trajectories      if set, vehicle lane positions
+ * @param  options           run options (arrow, packed)
+ * @return                   success or failure
+ */
+int write_vehicle_outputs(const std::string& output_path,
+                          const types::network_t& network,
+                          const types::id_set_t& timesteps,
+                          const types::vehicle_lane_hist_map_t& vehicle_lane_hist,
+                          types::trajectory_table_t *trajectories,
+                          const process_options_t& options) {
+  const types::id_set_t& edges = network.edges;
+
+  if (trajectories) {
+    stats::phase_begin("write trajectory output");
+    stats::phase_elements(trajectories->size());
+
+    //group by vehicle, project to x/y
+    trajectories->finish();
+    trajectories->project(network.edge_shapes, network.internal_shapes);
+
+    int trajectory_output_stat = output::write_trajectory_output(output_path, *trajectories);
+    if (trajectory_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write trajectory output" << std::endl;
+      return trajectory_output_stat;
+    }
+  }
+
+  stats::phase_begin("write vehicle output");
+  //history lookups
+  stats::phase_elements(vehicle_lane_hist.size() * timesteps.size() * edges.size());
+
+  //write the vehicle history output
+  int vehicle_hist_output_stat = output::write_vehicle_output(output_path,
+                                                              vehicle_lane_hist,
+                                                              edges,
+                                                              timesteps);
+  if (vehicle_hist_output_stat != EXIT_SUCCESS) {
+    std::cerr << "ERR: failed to write tower overage output, skipping remaining output artifacts" << std::endl;
+    return vehicle_hist_output_stat;
+  }
+
+  if (options.arrow) {
+    stats::phase_begin("write vehicle arrow output");
+
+    int arrow_output_stat = output::write_vehicle_history_arrow(output_path, vehicle_lane_hist, edges, timesteps);
+    if (arrow_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write vehicle history arrow output" << std::endl;
+      return arrow_output_stat;
+    }
+  }
+
+  if (options.packed) {
+    stats::phase_begin("write vehicle packed output");
+
+    int packed_output_stat = output::write_packed_history_output(output_path, vehicle_lane_hist, edges, options.codec);
+    if (packed_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write packed history output" << std::endl;
+      return packed_output_stat;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Add the recognitions of a tower in the bt output
+ * @param  tower_node         the bt node
+ * @param  tower_recognitions tower recognitions map
+ * @param  towers             set of unique tower ids
+ * @param  vehicles           set of unique vehicle ids
+ * @param  timesteps          set of timesteps with recognitions
+ * @param  filter             vehicles outside the filter sample and towers outside its region are dropped
+ * @param  options            run options
+ */
+void add_bt_tower(rapidxml::xml_node<> *tower_node,
+                  types::tower_recognitions_map_t& tower_recognitions,
+                  types::id_set_t& towers,
+                  types::id_set_t& vehicles,
+                  types::id_set_t& timesteps,
+                  const filter::input_filter_t& filter,
+                  const process_options_t& options) {
+  if (filter.region) {
+    //the tower position (observer end position of the first contact)
+    rapidxml::xml_node<> *seen_node = tower_node->first_node(SEEN_NODE);
+    rapidxml::xml_attribute<> *pos_attr = seen_node ? seen_node->first_attribute(OBSERVER_POS_END_ATTR) : NULL;
+    double tower_x = 0.0;
+    double tower_y = 0.0;
+    if (pos_attr &&
+        parse::parse_position(std::string(pos_attr->value(), pos_attr->value_size()), tower_x, tower_y) &&
+        !filter.region->contains(tower_x, tower_y)) {
+      //outside the region of interest
+      return;
+    }
+  }
+
+  //get the timestep
+  for (rapidxml::xml_attribute<> *tower_attr = tower_node->first_attribute();
+       tower_attr;
+       tower_attr = tower_attr->next_attribute()) {
+    //check the attribute name
+    if (strcmp(tower_attr->name(), ID_ATTR) == 0) {
+      std::pmr::string tower_id(tower_attr->value(), tower_attr->value_size());
+
+      towers.insert(tower_id);
+
+      //create a tower
+      types::tower_recognitions_t& tower = add_tower(tower_id, tower_recognitions, options);
+
+      //add vehicle recognitions
+      for (rapidxml::xml_node<> *seen_node = tower_node->first_node(SEEN_NODE);
+           seen_node;
+           seen_node = seen_node->next_sibling()) {
+
+        //add recognition points for this tower
+        stats::phase_elements(add_recognition_points(tower, seen_node, vehicles, timesteps, filter));
+      }
+    }
+  }
+}
+
+/*
+ * Joins a thread when leaving scope (so error returns wait for a follower)
+ */
+struct join_guard_t {
+  std::thread& thread;
+  ~join_guard_t() {
+    if (this->thread.joinable()) {
+      this->thread.join();
+    }
+  }
+};
+
+/**
+ * Read the output files and generate an aggregated report
+ * @param  bt_output_path       the path to the bluetooth output file
+ * @param  net_input_path       the path to the sumo network input file (input to simulation)
+ * @param  raw_output_path      the raw simulation output to follow vehicle progress
+ * @param  output_path          the path to a folder to write output files to
+ * @param  options              run options
+ * @param  shared_network       the parsed network if shared between runs (otherwise parsed from net_input_path)
+ * @return                      success or failure
+ */
+int process_output_data(const std::string& bt_output_path,
+                        const std::string& net_input_path,
+                        const std::string& raw_output_path,
+                        const std::string& output_path,
+                        const process_options_t& options,
+                        const types::network_t *shared_network) {
+  if (options.perf_counters) {
+    //continues without counters if unavailable
+    stats::perf_counters_open();
+  }
+
+  //arenas grouped by how long their data is needed (each is freed in one release)
+  //tower recognitions, timesteps: whole run
+  types::arena_t recognition_arena;
+  //vehicle ids: until the tower output is written
+  types::arena_t vehicle_id_arena;
+  //tower ids: until the coverage output is written
+  types::arena_t coverage_arena;
+  //segment ids, shapes: whole run (unless shared)
+  types::arena_t network_arena;
+  //vehicle histories: whole run
+  types::arena_t history_arena;
+
+  //incremental runs skip stages whose inputs match the last run (all stale otherwise)
+  std::optional<cache::artifact_manifest_t> manifest;
+  nlohmann::json tower_inputs;
+  nlohmann::json coverage_inputs;
+  nlohmann::json vehicle_inputs;
+  bool towers_fresh = false;
+  bool coverage_fresh = false;
+  bool vehicles_fresh = false;
+  uint64_t bt_hash = 0;
+  uint64_t net_hash = 0;
+  uint64_t raw_hash = 0;
+
+  if (options.incremental) {
+    stats::phase_begin("hash inputs");
+
+    if (!cache::hash_file(bt_output_path, bt_hash) ||
+        !cache::hash_file(net_input_path, net_hash) ||
+        !cache::hash_file(raw_output_path, raw_hash)) {
+      return EXIT_FAILURE;
+    }
+
+    manifest.emplace(output_path);
+    manifest->set_input(BT_INPUT, bt_output_path, bt_hash);
+    manifest->set_input(NETWORK_INPUT, net_input_path, net_hash);
+    manifest->set_input(NETSTATE_INPUT, raw_output_path, raw_hash);
+
+    tower_inputs = {
+      {BT_INPUT, cache::hash_hex(bt_hash)},
+      {"intervals", options.intervals},
+      {"curve_step", options.curve_step},
+      {"handoffs", options.handoffs},
+      {"tower_load", options.tower_load},
+      {"arrow", options.arrow},
+      {"quantize", options.dist_quantum},
+      {"packed", options.packed},
+      {"codec", options.codec},
+      {"roi", roi_input(options)},
+      {"window", window_input(options)},
+      {"compression", output::get_compression()},
+      {"format", output::get_format()}
+    };
+    //coverage distances are interpolated in interval mode
+    coverage_inputs = {
+      {BT_INPUT, cache::hash_hex(bt_hash)},
+      {NETWORK_INPUT, cache::hash_hex(net_hash)},
+      {"intervals", options.intervals},
+      {"curve_step", options.curve_step},
+      {"roi", roi_input(options)},
+      {"window", window_input(options)},
+      {"edge_segments", options.edge_segments},
+      {"compression", output::get_compression()},
+      {"format", output::get_format()}
+    };
+    towers_fresh = manifest->is_fresh(TOWER_STAGE, tower_inputs);
+    coverage_fresh = manifest->is_fresh(COVERAGE_STAGE, coverage_inputs);
+
+    //the timesteps are known without parsing if the bt output is unchanged
+    uint64_t last_bt_hash;
+    uint64_t last_timesteps_hash;
+    if (manifest->previous_input(BT_INPUT, last_bt_hash) && (last_bt_hash == bt_hash) &&
+        manifest->previous_input(TIMESTEPS_INPUT, last_timesteps_hash)) {
+      vehicles_fresh = manifest->is_fresh(VEHICLE_STAGE, vehicle_stage_inputs(raw_hash, net_hash, last_timesteps_hash, options));
+    }
+
+    if (towers_fresh && coverage_fresh && vehicles_fresh) {
+      std::cerr << "INFO: all outputs up to date: " << output_path << std::endl;
+      stats::phase_end();
+      return EXIT_SUCCESS;
+    }
+
+    //outputs are about to change
+    manifest->invalidate();
+
+  } else {
+    //the outputs are rewritten without a manifest
+    cache::artifact_manifest_t::remove(output_path);
+  }
+
+  //construct a mapping from tower id to all recognition points
+  types::tower_recognitions_map_t& tower_recognitions = recognition_arena.make<types::tower_recognitions_map_t>();
+  //sets of tower, vehicle ids, timesteps
+  types::id_set_t& towers = coverage_arena.make<types::id_set_t>();
+  types::id_set_t& vehicles = vehicle_id_arena.make<types::id_set_t>();
+  types::id_set_t& timesteps = recognition_arena.make<types::id_set_t>();
+
+  //record the lanes seen by a given vehicle
+  types::vehicle_lane_hist_map_t& vehicle_lane_hist = history_arena.make<types::vehicle_lane_hist_map_t>();
+  //record vehicle lane positions
+  types::trajectory_table_t *trajectories = options.trajectories ? &history_arena.make<types::trajectory_table_t>() : nullptr;
+  //the vehicles kept in every input when sampling
+  sample::vehicle_sample_t vehicle_sample(options.sample_rate, options.sample_seed);
+  sample::vehicle_sample_t *sample = (options.sample_rate < 1.0) ? &vehicle_sample : nullptr;
+  //what is kept from the inputs (the lanes in the region of interest once the network is loaded)
+  filter::input_filter_t filter = input_filter(options, sample);
+  if (filter.region && shared_network) {
+    //a shared network is loaded before any input is parsed (or followed)
+    filter.network = shared_network;
+  }
+  bool netstate_parsed = false;
+
+  //follow mode: the netstate is ingested on its own thread while both files are written
+  std::thread netstate_thread;
+  join_guard_t netstate_guard{netstate_thread};
+  if (options.follow) {
+    netstate_thread = std::thread([&] () {
+      stats::phase_begin("follow netstate");
+      netstate_parsed = parse_netstate(raw_output_path, vehicle_lane_hist, trajectories, filter, options);
+      stats::phase_end();
+    });
+  }
+
+  //the bt output is parsed by any stale stage (the vehicle stage needs the timesteps)
+  stats::phase_begin(options.follow ? "follow bt output" : "parse bt output");
+
+  bool bt_parsed;
+  if (options.follow) {
+    //each tower is processed once its closing tag is written
+    bt_parsed = stream::follow_elements(bt_output_path, BT_OUTPUT_NODE, true, options.follow_timeout * 1000,
+      [&tower_recognitions, &towers, &vehicles, &timesteps, &filter, &options] (rapidxml::xml_node<> *tower_node) {
+        if (strcmp(tower_node->name(), BT_NODE) == 0) {
+          add_bt_tower(tower_node, tower_recognitions, towers, vehicles, timesteps, filter, options);
+        }
+      });
+
+  } else {
+    //load the bt xml file, add recognitions to map
+    bt_parsed = parse::load_from_path(bt_output_path, [&tower_recognitions, &towers, &vehicles, &timesteps, &filter, &options] (const rapidxml::xml_document<>& doc) {
+
+      //verify the name of the root node
+      if (strcmp(doc.first_node()->name(), BT_OUTPUT_NODE) != 0) {
+        std::cerr << "ERR doc root node not: " << BT_OUTPUT_NODE << std::endl;
+        throw std::exception();
+      }
+
+      //get each tower
+      for (rapidxml::xml_node<> *tower_node = doc.first_node(BT_OUTPUT_NODE)->first_node(BT_NODE);
+           tower_node;
+           tower_node = tower_node->next_sibling()) {
+        add_bt_tower(tower_node, tower_recognitions, towers, vehicles, timesteps, filter, options);
+      }
+    });
+  }
+
+  if (!bt_parsed) {
+    return EXIT_FAILURE;
+  }
+
+  if (manifest) {
+    uint64_t timesteps_hash = hash_ids(timesteps);
+    manifest->set_input(TIMESTEPS_INPUT, "", timesteps_hash);
+    vehicle_inputs = vehicle_stage_inputs(raw_hash, net_hash, timesteps_hash, options);
+    vehicles_fresh = manifest->is_fresh(VEHICLE_STAGE, vehicle_inputs);
+  }
+
+  if (towers_fresh) {
+    std::cerr << "INFO: tower outputs up to date" << std::endl;
+  } else {
+    stats::phase_begin("write tower output");
+    //distance lookups
+    stats::phase_elements(tower_recognitions.size() * timesteps.size() * vehicles.size());
+
+    //write the tower output
+    int tower_output_stat = write_recognitions(output_path,
+                                               tower_recognitions,
+                                               vehicles,
+                                               timesteps,
+                                               options);
+    if (tower_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write tower output" << std::endl;
+      return tower_output_stat;
+    }
+  }
+
+  //release storage that won't be used later
+  size_t vehicles_kept = vehicles.size();
+  vehicle_id_arena.release();
+
+  stats::phase_begin("parse network");
+
+  const types::network_t *network = shared_network;
+  if ((network == nullptr) && coverage_fresh && vehicles_fresh) {
+    //not needed by any stale stage
+    network = &network_arena.make<types::network_t>();
+  } else if (network == nullptr) {
+    //load network edges and shapes (junction lanes are only needed to project trajectories
+    //and to keep the vehicles on junctions in the region of interest)
+    types::network_t& parsed = network_arena.make<types::network_t>();
+    if (!load_network(net_input_path, parsed, options.trajectories || options.roi, options)) {
+      return EXIT_FAILURE;
+    }
+    network = &parsed;
+  }
+
+  const types::id_set_t& edges = network->edges;
+  const types::road_edge_map_t& edge_shapes = network->segment_shapes();
+
+  if (filter.region && (filter.network == nullptr)) {
+    //the netstate is parsed after the network unless following (not with a region)
+    filter.network = network;
+  }
+
+  stats::phase_elements(edges.size());
+
+  if (coverage_fresh) {
+    std::cerr << "INFO: tower coverage output up to date" << std::endl;
+  } else {
+    stats::phase_begin("write coverage output");
+    //edge distance calculations
+    stats::phase_elements(towers.size() * edges.size());
+
+    //write the tower coverage output
+    int tower_coverage_output_stat = output::write_tower_coverage_output(output_path,
+                                                                         tower_recognitions,
+                                                                         edge_shapes,
+                                                                         edges,
+                                                                         towers);
+    if (tower_coverage_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write tower overage output" << std::endl;
+      return tower_coverage_output_stat;
+    }
+  }
+
+  //release unused storage (tower ids)
+  coverage_arena.release();
+
+  if (vehicles_fresh) {
+    std::cerr << "INFO: vehicle outputs up to date" << std::endl;
+  } else {
+    if (options.follow) {
+      //wait for the end of the netstate
+      netstate_thread.join();
+    } else {
+      stats::phase_begin("parse netstate");
+      netstate_parsed = parse_netstate(raw_output_path, vehicle_lane_hist, trajectories, filter, options);
+    }
+
+    if (!netstate_parsed) {
+      return EXIT_FAILURE;
+    }
+
+    int vehicle_output_stat = write_vehicle_outputs(output_path, *network, timesteps, vehicle_lane_hist, trajectories, options);
+    if (vehicle_output_stat != EXIT_SUCCESS) {
+      return vehicle_output_stat;
+    }
+  }
+
+  if (sample) {
+    int sample_stat = output::write_sampling_stats(output_path, *sample, vehicles_kept);
+    if (sample_stat != EXIT_SUCCESS) {
+      return sample_stat;
+    }
+  }
+
+  if (manifest) {
+    manifest->record(TOWER_STAGE, tower_inputs, tower_stage_outputs(options));
+    manifest->record(COVERAGE_STAGE, coverage_inputs, {output::output_filename(TOWER_COVERAGE_FILENAME)});
+    manifest->record(VEHICLE_STAGE, vehicle_inputs, vehicle_stage_outputs(options));
+
+    int manifest_stat = manifest->write();
+    if (manifest_stat != EXIT_SUCCESS) {
+      return manifest_stat;
+    }
+  }
+
+  stats::phase_begin("teardown");
+
+  //free everything explicitly so teardown is measured as a phase
+  recognition_arena.release();
+  network_arena.release();
+  history_arena.release();
+
+  stats::phase_end();
+
+  return EXIT_SUCCESS;
+  //TODO remaining
+}
+
+/*
+ * The what-if recognitions for one range
+ */
+struct range_recognitions_t {
+  double range;
+  types::tower_recognitions_map_t *tower_recognitions;
+  types::id_set_t *vehicles;
+  types::id_set_t *timesteps;
+  //the recognition collector for each tower (same order as positions)
+  std::vector<types::tower_recognitions_t*> towers;
+  //statistics
+  std::vector<bool> tower_active;
+  uint64_t recognitions = 0;
+  uint64_t covered_samples = 0;
+};
+
+/**
+ * Compute the tower recognitions for hypothetical tower positions from the vehicle
+ * trajectories in the raw output (no simulation rerun) and generate the same report
+ * @param  towers_path          tower positions (sumo additional file or "<id> <x> <y>" list)
+ * @param  net_input_path       the path to the sumo network input file (input to simulation)
+ * @param  raw_output_path      the raw simulation output to follow vehicle progress
+ * @param  output_path          the path to a folder to write output files to
+ * @param  options              run options (range or range sweep)
+ * @return                      success or failure
+ */
+int process_what_if_data(const std::string& towers_path,
+                         const std::string& net_input_path,
+                         const std::string& raw_output_path,
+                         const std::string& output_path,
+                         const process_options_t& options) {
+  if (options.perf_counters) {
+    //continues without counters if unavailable
+    stats::perf_counters_open();
+  }
+
+  //the outputs are rewritten without a manifest (not incremental)
+  cache::artifact_manifest_t::remove(output_path);
+
+  //tower recognitions, timesteps: whole run
+  types::arena_t recognition_arena;
+  //vehicle ids: until the tower output is written
+  types::arena_t vehicle_id_arena;
+  //tower ids: until the coverage output is written
+  types::arena_t coverage_arena;
+  //network, vehicle histories: whole run
+  types::arena_t network_arena;
+  types::arena_t history_arena;
+
+  //recognitions for each range (ascending, a single range unless sweeping)
+  std::vector<double> ranges = options.ranges.empty() ? std::vector<double>{options.range} : options.ranges;
+  std::sort(ranges.begin(), ranges.end());
+  ranges.erase(std::unique(ranges.begin(), ranges.end()), ranges.end());
+
+  std::vector<range_recognitions_t> results(ranges.size());
+  for (size_t k=0; k<ranges.size(); k++) {
+    results[k].range = ranges[k];
+    results[k].tower_recognitions = &recognition_arena.make<types::tower_recognitions_map_t>();
+    results[k].vehicles = &vehicle_id_arena.make<types::id_set_t>();
+    results[k].timesteps = &recognition_arena.make<types::id_set_t>();
+  }
+
+  types::id_set_t& towers = coverage_arena.make<types::id_set_t>();
+  //vehicles are also positioned on junctions
+  types::network_t& network = network_arena.make<types::network_t>();
+  const types::id_set_t& edges = network.edges;
+  const types::road_edge_map_t& edge_shapes = network.edge_shapes;
+  const types::road_edge_map_t& internal_shapes = network.internal_shapes;
+  types::vehicle_lane_hist_map_t& vehicle_lane_hist = history_arena.make<types::vehicle_lane_hist_map_t>();
+  types::trajectory_table_t *trajectories = options.trajectories ? &history_arena.make<types::trajectory_table_t>() : nullptr;
+
+  stats::phase_begin("parse network");
+
+  if (!load_network(net_input_path, network, true, options)) {
+    return EXIT_FAILURE;
+  }
+
+  stats::phase_elements(edges.size());
+  stats::phase_begin("load towers");
+
+  std::vector<what_if::tower_position_t> tower_positions;
+  if (!what_if::load_tower_positions(towers_path, edge_shapes, tower_positions, options.roi ? &*options.roi : nullptr)) {
+    return EXIT_FAILURE;
+  }
+
+  for (const what_if::tower_position_t& position : tower_positions) {
+    std::pmr::string tower_id(position.id);
+    towers.insert(tower_id);
+
+    for (range_recognitions_t& result : results) {
+      types::tower_recognitions_t& tower = add_tower(tower_id, *result.tower_recognitions, options);
+      tower.set_position(position.x, position.y);
+      result.towers.push_back(&tower);
+    }
+  }
+
+  for (range_recognitions_t& result : results) {
+    result.tower_active.assign(tower_positions.size(), false);
+  }
+
+  double max_range = ranges.back();
+  stats::phase_elements(tower_positions.size());
+  std::cerr << "INFO: " << tower_positions.size() << " towers, range " << max_range << std::endl;
+
+  stats::phase_begin("parse netstate");
+
+  //the vehicles kept when sampling
+  sample::vehicle_sample_t vehicle_sample(options.sample_rate, options.sample_seed);
+  sample::vehicle_sample_t *sample = (options.sample_rate < 1.0) ? &vehicle_sample : nullptr;
+  //and on the lanes in the region of interest, in the time window
+  filter::input_filter_t filter = input_filter(options, sample);
+  filter.network = options.roi ? &network : nullptr;
+
+  //rebuilt for each timestep (a single query at the max range, bucketed by distance)
+  what_if::vehicle_grid_t grid(max_range);
+  //all (timestep, vehicle) samples
+  uint64_t vehicle_samples = 0;
+
+  std::pmr::string ts_id;
+  std::pmr::string vehicle_id;
+  //ranges with a recognition in the current timestep
+  std::vector<bool> recognized(results.size());
+  //the distance from each vehicle to the closest tower in the current timestep
+  std::unordered_map<std::string_view,double> nearest;
+
+  //position the vehicles of a timestep and find the recognitions
+  auto add_positions = [&] (rapidxml::xml_node<> *ts_node) {
+    rapidxml::xml_attribute<> *ts_attr = ts_node->first_attribute(TIME_ATTR);
+    if (ts_attr == NULL) {
+      std::cerr << "ERR no timestep attribute" << std::endl;
+      throw std::exception();
+    }
+
+    //because we simulate at the granularity of seconds, truncate
+    int ts = (int) atof(ts_attr->value());
+    if (!filter.keep_time(ts)) {
+      //outside the time window
+      return;
+    }
+
+    char ts_buff[16];
+    ts_id.assign(ts_buff, snprintf(ts_buff, sizeof(ts_buff), "%d", ts));
+
+    //position every vehicle
+    grid.clear();
+    for (rapidxml::xml_node<> *edge_node = ts_node->first_node(EDGE_NODE);
+         edge_node;
+         edge_node = edge_node->next_sibling()) {
+      stats::phase_elements(add_vehicle_positions(edge_node, edge_shapes, internal_shapes, grid, filter));
+      add_vehicle_hist(edge_node, ts, vehicle_lane_hist, trajectories, filter);
+    }
+    grid.build();
+
+    vehicle_samples += grid.size();
+
+    //recognitions for each tower
+    recognized.assign(results.size(), false);
+    nearest.clear();
+
+    for (size_t i=0; i<tower_positions.size(); i++) {
+      grid.query(tower_positions[i].x, tower_positions[i].y, max_range,
+        [&] (std::string_view id, double dist) {
+          vehicle_id.assign(id.data(), id.size());
+
+          //recognized in every range at least this distance
+          for (size_t k=std::lower_bound(ranges.begin(), ranges.end(), dist) - ranges.begin();
+               k<results.size();
+               k++) {
+            results[k].vehicles->insert(vehicle_id);
+            results[k].towers[i]->add_recognition(ts_id, vehicle_id, dist);
+            results[k].tower_active[i] = true;
+            results[k].recognitions++;
+            recognized[k] = true;
+          }
+
+          std::pair<std::unordered_map<std::string_view,double>::iterator,bool> closest = nearest.try_emplace(id, dist);
+          if (!closest.second && (dist < closest.first->second)) {
+            closest.first->second = dist;
+          }
+        });
+    }
+
+    //only timesteps with recognitions are reported (as with bt output)
+    for (size_t k=0; k<results.size(); k++) {
+      if (recognized[k]) {
+        results[k].timesteps->insert(ts_id);
+      }
+    }
+
+    //vehicles covered by any tower
+    for (const std::pair<const std::string_view,double>& closest : nearest) {
+      for (size_t k=std::lower_bound(ranges.begin(), ranges.end(), closest.second) - ranges.begin();
+           k<results.size();
+           k++) {
+        results[k].covered_samples++;
+      }
+    }
+  };
+
+  bool netstate_parsed;
+  if (filter.windowed) {
+    //timesteps outside the time window are not parsed
+    netstate_parsed = stream::follow_elements(raw_output_path, NETSTATE_NODE, false, options.follow_timeout * 1000,
+      [&add_positions] (rapidxml::xml_node<> *ts_node) {
+        if (strcmp(ts_node->name(), TIMESTEP_NODE) == 0) {
+          add_positions(ts_node);
+        }
+      },
+      [&filter] (const char *elem, size_t size) {
+        return keep_timestep_text(elem, size, filter);
+      });
+
+  } else {
+    netstate_parsed = parse::load_from_path(raw_output_path, [&add_positions] (const rapidxml::xml_document<>& doc) {
+      //verify the name of the root node
+      if (strcmp(doc.first_node()->name(), NETSTATE_NODE) != 0) {
+        std::cerr << "ERR doc root node not: " << NETSTATE_NODE << std::endl;
+        throw std::exception();
+      }
+
+      //get each timestep
+      for (rapidxml::xml_node<> *ts_node = doc.first_node(NETSTATE_NODE)->first_node(TIMESTEP_NODE);
+           ts_node;
+           ts_node = ts_node->next_sibling()) {
+        add_positions(ts_node);
+      }
+    });
+  }
+
+  if (!netstate_parsed) {
+    return EXIT_FAILURE;
+  }
+
+  stats::phase_begin("write tower output");
+
+  std::vector<output::range_summary_t> summaries;
+
+  for (const range_recognitions_t& result : results) {
+    stats::phase_elements(result.tower_recognitions->size() * result.timesteps->size() * result.vehicles->size());
+
+    //sweep outputs go in a directory for each range
+    std::string range_path = output_path;
+    if (!options.ranges.empty()) {
+      char range_buff[32];
+      snprintf(range_buff, sizeof(range_buff), "range_%g", result.range);
+      range_path = output::join(output_path, range_buff);
+
+      if ((mkdir(range_path.c_str(), 0755) != 0) && (errno != EEXIST)) {
+        std::cerr << "ERR: failed to create range output directory: " << range_path << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    int tower_output_stat = write_recognitions(range_path,
+                                               *result.tower_recognitions,
+                                               *result.vehicles,
+                                               *result.timesteps,
+                                               options);
+    if (tower_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write tower output" << std::endl;
+      return tower_output_stat;
+    }
+
+    summaries.push_back({
+      result.range,
+      result.recognitions,
+      result.vehicles->size(),
+      result.timesteps->size(),
+      (size_t) std::count(result.tower_active.begin(), result.tower_active.end(), true),
+      result.covered_samples
+    });
+  }
+
+  if (!options.ranges.empty()) {
+    int sweep_output_stat = output::write_range_sweep_output(output_path,
+                                                             summaries,
+                                                             tower_positions.size(),
+                                                             vehicle_samples);
+    if (sweep_output_stat != EXIT_SUCCESS) {
+      std::cerr << "ERR: failed to write range sweep output" << std::endl;
+      return sweep_output_stat;
+    }
+  }
+
+  size_t vehicles_kept = results.back().vehicles->size();
+  vehicle_id_arena.release();
+
+  //the coverage and vehicle outputs use the largest range
+  const types::tower_recognitions_map_t& tower_recognitions = *results.back().tower_recognitions;
+  const types::id_set_t& timesteps = *results.back().timesteps;
+
+  stats::phase_begin("write coverage output");
+  stats::phase_elements(towers.size() * edges.size());
+
+  int tower_coverage_output_stat = output::write_tower_coverage_output(output_path,
+                                                                       tower_recognitions,
+                                                                       network.segment_shapes(),
+                                                                       edges,
+                                                                       towers);
+  if (tower_coverage_output_stat != EXIT_SUCCESS) {
+    std::cerr << "ERR: failed to write tower coverage output" << std::endl;
+    return tower_coverage_output_stat;
+  }
+
+  coverage_arena.release();
+
+  //write the vehicle history (and trajectory, arrow, packed) outputs
+  int vehicle_output_stat = write_vehicle_outputs(output_path, network, timesteps, vehicle_lane_hist, trajectories, options);
+  if (vehicle_output_stat != EXIT_SUCCESS) {
+    return vehicle_output_stat;
+  }
+
+  if (sample) {
+    int sample_stat = output::write_sampling_stats(output_path, *sample, vehicles_kept);
+    if (sample_stat != EXIT_SUCCESS) {
+      return sample_stat;
+    }
+  }
+
+  stats::phase_begin("teardown");
+
+  recognition_arena.release();
+  network_arena.release();
+  history_arena.release();
+
+  stats::phase_end();
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * A tower (vehicle) in the current traci step
+ */
+struct traci_tower_t {
+  types::tower_recognitions_t *tower;
+  double x;
+  double y;
+};
+
+/**
+ * Step a running simulation over traci and generate the same report as the bt output
+ * and netstate (recognitions are computed from the subscribed vehicle positions)
+ * @param  traci_host           the host of the traci server
+ * @param  traci_port           the port of the traci server
+ * @param  net_input_path       the path to the sumo network input file (input to simulation)
+ * @param  output_path          the path to a folder to write output files to
+ * @param  options              run options (range, end time)
+ * @return                      success or failure
+ */
+int process_traci_data(const std::string& traci_host,
+                       int traci_port,
+                       const std::string& net_input_path,
+                       const std::string& output_path,
+                       const process_options_t& options) {
+  if (options.perf_counters) {
+    //continues without counters if unavailable
+    stats::perf_counters_open();
+  }
+
+  //the outputs are rewritten without a manifest (not incremental)
+  cache::artifact_manifest_t::remove(output_path);
+
+  //tower recognitions, ids: whole run (the session can't be replayed)
+  types::arena_t recognition_arena;
+  //network, vehicle histories: whole run
+  types::arena_t network_arena;
+  types::arena_t history_arena;
+
+  types::tower_recognitions_map_t& tower_recognitions = recognition_arena.make<types::tower_recognitions_map_t>();
+  types::id_set_t& vehicles = recognition_arena.make<types::id_set_t>();
+  types::id_set_t& timesteps = recognition_arena.make<types::id_set_t>();
+  types::id_set_t& towers = recognition_arena.make<types::id_set_t>();
+  types::network_t& network = network_arena.make<types::network_t>();
+  types::vehicle_lane_hist_map_t& vehicle_lane_hist = history_arena.make<types::vehicle_lane_hist_map_t>();
+  types::trajectory_table_t *trajectories = options.trajectories ? &history_arena.make<types::trajectory_table_t>() : nullptr;
+
+  stats::phase_begin("parse network");
+
+  //internal lanes are only needed to project trajectories (and to keep the vehicles on
+  //junctions in the region of interest)
+  if (!load_network(net_input_path, network, options.trajectories || options.roi, options)) {
+    return EXIT_FAILURE;
+  }
+
+  stats::phase_elements(network.edges.size());
+  stats::phase_begin("connect");
+
+  traci::traci_client_t client;
+  int api_version = 0;
+  std::string identifier;
+
+  if (!client.connect(traci_host, traci_port, TRACI_CONNECT_TIMEOUT_MS) ||
+      !client.get_version(api_version, identifier) ||
+      !client.subscribe_simulation()) {
+    std::cerr << "ERR: failed to start traci session" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cerr << "INFO: connected to " << identifier << " (traci api " << api_version << ")" << std::endl;
+
+  stats::phase_begin("simulate");
+
+  //the vehicles kept when sampling
+  sample::vehicle_sample_t vehicle_sample(options.sample_rate, options.sample_seed);
+  sample::vehicle_sample_t *sample = (options.sample_rate < 1.0) ? &vehicle_sample : nullptr;
+  //and on the lanes in the region of interest, in the time window
+  filter::input_filter_t filter = input_filter(options, sample);
+  filter.network = options.roi ? &network : nullptr;
+
+  //rebuilt for each step
+  what_if::vehicle_grid_t grid(options.range);
+  std::vector<traci_tower_t> step_towers;
+  traci::step_t step;
+  std::pmr::string ts_id;
+  std::pmr::string vehicle_id;
+  std::pmr::string lane_id;
+  std::pmr::string segment_id;
+  bool server_closed = false;
+
+  while (true) {
+    int stepped = client.step(step);
+    if (stepped < 0) {
+      std::cerr << "ERR: traci simulation step failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (stepped == 0) {
+      //the simulation ended without reporting zero expected vehicles
+      std::cerr << "INFO: traci server closed the connection" << std::endl;
+      server_closed = true;
+      break;
+    }
+
+    //vehicles that departed in this step are reported by the subscription
+    if (!client.subscribe_vehicles(step.departed, step)) {
+      std::cerr << "ERR: failed to subscribe to departed vehicles" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    //because we simulate at the granularity of seconds, truncate
+    int ts = (int) step.time;
+    char ts_buff[16];
+    ts_id.assign(ts_buff, snprintf(ts_buff, sizeof(ts_buff), "%d", ts));
+
+    //no vehicles expected, the end time or past the time window
+    bool last_step = (step.min_expected <= 0) ||
+                     ((options.traci_end >= 0) && (step.time >= options.traci_end)) ||
+                     (filter.windowed && (ts >= filter.t_end));
+
+    if (!filter.keep_time(ts)) {
+      //outside the time window (the session still steps to it)
+      if (last_step) {
+        break;
+      }
+      continue;
+    }
+
+    grid.clear();
+    step_towers.clear();
+
+    for (const traci::vehicle_state_t& vehicle : step.vehicles) {
+      vehicle_id.assign(vehicle.id.data(), vehicle.id.size());
+
+      if (vehicle_id.rfind(TOWER_PREFIX, 0) != std::string::npos) {
+        if (filter.region && !filter.region->contains(vehicle.x, vehicle.y)) {
+          //outside the region of interest
+          continue;
+        }
+
+        //towers placed in the simulation are not vehicles
+        towers.insert(vehicle_id);
+        types::tower_recognitions_t& tower = add_tower(vehicle_id, tower_recognitions, options);
+        tower.set_position(vehicle.x, vehicle.y);
+        step_towers.push_back({&tower, vehicle.x, vehicle.y});
+        continue;
+
+      } else if (vehicle.lane.empty()) {
+        //vehicles without a lane are teleporting
+        continue;
+      }
+
+      lane_id.assign(vehicle.lane.data(), vehicle.lane.size());
+      if (!filter.keep_lane(lane_id)) {
+        //outside the region of interest
+        continue;
+
+      } else if (sample && !sample->keep(vehicle.id)) {
+        sample->entries_dropped++;
+
+      } else {
+        if (sample) {
+          sample->entries_kept++;
+        }
+        if (filter.edge_segments) {
+          segment_id = types::lane_edge_id(vehicle.lane);
+        }
+        record_vehicle(vehicle_id, lane_id, filter.edge_segments ? segment_id : lane_id,
+                       ts, vehicle.lane_pos, vehicle.speed, vehicle_lane_hist, trajectories);
+        grid.add(vehicle.id, vehicle.x, vehicle.y);
+      }
+    }
+    grid.build();
+
+    stats::phase_elements(step.vehicles.size());
+
+    //recognitions for each tower
+    bool recognized = false;
+    for (const traci_tower_t& step_tower : step_towers) {
+      grid.query(step_tower.x, step_tower.y, options.range,
+        [&] (std::string_view id, double dist) {
+          vehicle_id.assign(id.data(), id.size());
+          vehicles.insert(vehicle_id);
+          step_tower.tower->add_recognition(ts_id, vehicle_id, dist);
+          recognized = true;
+        });
+    }
+
+    //only timesteps with recognitions are reported (as with bt output)
+    if (recognized) {
+      timesteps.insert(ts_id);
+    }
+
+    if (last_step) {
+      break;
+    }
+  }
+
+  if (!server_closed) {
+    //ends the simulation
+    client.close();
+  }
+
+  std::cerr << "INFO: " << towers.size() << " towers, " << timesteps.size() << " timesteps with recognitions" << std::endl;
+
+  stats::phase_begin("write tower output");
+  stats::phase_elements(tower_recognitions.size() * timesteps.size() * vehicles.size());
+
+  int tower_output_stat = write_recognitions(output_path, tower_recognitions, vehicles, timesteps, options);
+  if (tower_output_stat != EXIT_SUCCESS) {
+    std::cerr << "ERR: failed to write tower output" << std::endl;
+    return tower_output_stat;
+  }
+
+  stats::phase_begin("write coverage output");
+  stats::phase_elements(towers.size() * network.edges.size());
+
+  int tower_coverage_output_stat = output::write_tower_coverage_output(output_path,
+                                                                       tower_recognitions,
+                                                                       network.segment_shapes(),
+                                                                       network.edges,
+                                                                       towers);
+  if (tower_coverage_output_stat != EXIT_SUCCESS) {
+    std::cerr << "ERR: failed to write tower coverage output" << std::endl;
+    return tower_coverage_output_stat;
+  }
+
+  int vehicle_output_stat = write_vehicle_outputs(output_path, network, timesteps, vehicle_lane_hist, trajectories, options);
+  if (vehicle_output_stat != EXIT_SUCCESS) {
+    return vehicle_output_stat;
+  }
+
+  if (sample) {
+    int sample_stat = output::write_sampling_stats(output_path, *sample, vehicles.size());
+    if (sample_stat != EXIT_SUCCESS) {
+      return sample_stat;
+    }
+  }
+
+  stats::phase_begin("teardown");
+
+  recognition_arena.release();
+  network_arena.release();
+  history_arena.release();
+
+  stats::phase_end();
+
+  return EXIT_SUCCESS;
 }
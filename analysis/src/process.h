@@ -6,6 +6,85 @@
 #define _PROCESS_H
 
 #include <string>
+#include <vector>
+#include <optional>
+#include <stdint.h>
+#include <climits>
+#include "types/network.h"
+#include "filter/region.h"
+#include "codec/int_codec.h"
+
+/*
+ * Options for a run of the analysis pipeline
+ */
+struct process_options_t {
+  //record hardware performance counters for each phase
+  bool perf_counters = false;
+  //recognition range for what-if towers (meters)
+  double range = 100.0;
+  //what-if range sweep (one tower output per range, overrides range when set)
+  std::vector<double> ranges;
+  //write the binary vehicle trajectory output
+  bool trajectories = false;
+  //write the recognitions and vehicle history as arrow ipc files
+  bool arrow = false;
+  //store recognitions compactly with distances in fixed point at this precision (meters, 0 for off)
+  double dist_quantum = 0;
+  //integer codec for compact recognitions and the packed outputs
+  codec::codec_t codec = codec::CODEC_VARINT;
+  //write the packed (encoded) recognition and vehicle history outputs
+  bool packed = false;
+  //fraction of vehicles kept (selected by a seeded hash of the id, 1 for all)
+  double sample_rate = 1.0;
+  uint64_t sample_seed = 0;
+  //region of interest (lanes, towers and vehicles outside are skipped, everything if not set)
+  std::optional<filter::region_t> roi;
+  //time window [t_start, t_end) and stride (seconds, every stride-th second from t_start):
+  //recognitions and netstate timesteps outside are skipped
+  bool windowed = false;
+  int t_start = 0;
+  int t_end = INT_MAX;
+  int stride = 1;
+  //segments are whole edges (lanes grouped by edge) instead of lanes
+  bool edge_segments = false;
+  //store recognitions as contact intervals (interval output instead of the tower output)
+  bool intervals = false;
+  //keep an interval distance every curve_step timesteps (0 for none)
+  int curve_step = 0;
+  //write the tower handoff graph
+  bool handoffs = false;
+  //write the tower load matrices and summary
+  bool tower_load = false;
+  //batch workers (0: one per core)
+  unsigned batch_jobs = 0;
+  //batch memory budget in bytes (0: half of physical memory)
+  uint64_t batch_memory_budget = 0;
+  //load the network from a parsed network cache (created on first use)
+  bool net_cache = false;
+  //the cache directory (empty: next to the network file)
+  std::string cache_dir;
+  //skip output stages whose inputs match the artifact manifest of the last run
+  bool incremental = false;
+  //read the bt output and netstate as the simulation writes them (files or named pipes)
+  bool follow = false;
+  //seconds without new input before a followed file is considered truncated
+  int follow_timeout = 60;
+  //stop a traci session at this simulation time (seconds, negative: when no vehicles are expected)
+  double traci_end = -1.0;
+};
+
+/**
+ * Load the network lanes and shapes (from the parsed network cache if enabled)
+ * @param  net_input_path the path to the sumo network input file
+ * @param  network        the network to load into
+ * @param  internal_lanes whether to keep internal (junction) lane shapes
+ * @param  options        run options (network cache, region of interest, edge segments)
+ * @return                success or failure
+ */
+[[nodiscard]] bool load_network(const std::string& net_input_path,
+                                types::network_t& network,
+                                bool internal_lanes,
+                                const process_options_t& options);
 
 /**
  * Read the output files and generate an aggregated report
@@ -13,11 +92,47 @@
  * @param  net_input_path       the path to the sumo network input file (input to simulation)
  * @param  raw_output_path      the raw simulation output to follow vehicle progress
  * @param  output_path          the path to a folder to write output files to
+ * @param  options              run options
+ * @param  shared_network       the parsed network if shared between runs (otherwise parsed from net_input_path)
  * @return                      success or failure
  */
 int process_output_data(const std::string& bt_output_path,
                         const std::string& net_input_path,
                         const std::string& raw_output_path,
-                        const std::string& output_path);
+                        const std::string& output_path,
+                        const process_options_t& options,
+                        const types::network_t *shared_network = nullptr);
+
+/**
+ * Compute the tower recognitions for hypothetical tower positions from the vehicle
+ * trajectories in the raw output (no simulation rerun) and generate the same report
+ * @param  towers_path          tower positions (sumo additional file or "<id> <x> <y>" list)
+ * @param  net_input_path       the path to the sumo network input file (input to simulation)
+ * @param  raw_output_path      the raw simulation output to follow vehicle progress
+ * @param  output_path          the path to a folder to write output files to
+ * @param  options              run options (range or range sweep)
+ * @return                      success or failure
+ */
+int process_what_if_data(const std::string& towers_path,
+                         const std::string& net_input_path,
+                         const std::string& raw_output_path,
+                         const std::string& output_path,
+                         const process_options_t& options);
+
+/**
+ * Step a running simulation over traci and generate the same report as the bt output
+ * and netstate (recognitions are computed from the subscribed vehicle positions)
+ * @param  traci_host           the host of the traci server
+ * @param  traci_port           the port of the traci server
+ * @param  net_input_path       the path to the sumo network input file (input to simulation)
+ * @param  output_path          the path to a folder to write output files to
+ * @param  options              run options (range, end time)
+ * @return                      success or failure
+ */
+int process_traci_data(const std::string& traci_host,
+                       int traci_port,
+                       const std::string& net_input_path,
+                       const std::string& output_path,
+                       const process_options_t& options);
 
 #endif /*_PROCESS_H*/
@@ -0,0 +1,43 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "vehicle_sample.h"
+#include "../cache/content_hash.h"
+#include <cmath>
+
+namespace sample {
+
+  /**
+   * Mix the bits of a hash (splitmix64 finalizer: fnv1a leaves short ids
+   * poorly mixed in the high bits compared against the threshold)
+   * @param  hash the hash
+   * @return      the mixed hash
+   */
+  inline uint64_t mix(uint64_t hash) {
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+  }
+
+  /**
+   * Constructor
+   * @param rate the fraction of vehicles to keep (0, 1]
+   * @param seed the hash seed
+   */
+  vehicle_sample_t::vehicle_sample_t(double rate, uint64_t seed)
+    : rate(rate),
+      seed(seed),
+      //2^64 does not fit: rate 1 keeps everything below the max
+      threshold((rate >= 1.0) ? UINT64_MAX : (uint64_t) std::ldexp(rate, 64)) {}
+
+  /**
+   * Check if a vehicle is in the sample
+   * @param  vehicle_id the vehicle id
+   * @return            whether the vehicle is kept
+   */
+  bool vehicle_sample_t::keep(std::string_view vehicle_id) const {
+    return (this->threshold == UINT64_MAX) ||
+           (mix(cache::fnv1a(vehicle_id.data(), vehicle_id.size(), FNV_OFFSET ^ mix(this->seed))) < this->threshold);
+  }
+}
@@ -0,0 +1,74 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _VEHICLE_SAMPLE_H
+#define _VEHICLE_SAMPLE_H
+
+#include <string_view>
+#include <stdint.h>
+
+namespace sample {
+  /*
+   * Deterministic vehicle sample: a vehicle is kept if the seeded hash of its id
+   * falls below the sample rate, so the same vehicles are kept in every input
+   * (and in every run with the same rate and seed)
+   */
+  struct vehicle_sample_t {
+  private:
+    double rate;
+    uint64_t seed;
+    //kept if the hash is below this (0 to 2^64 scaled by the rate)
+    uint64_t threshold;
+
+  public:
+    //bt output (tower, vehicle) contacts and recognition points
+    uint64_t contacts_kept = 0;
+    uint64_t contacts_dropped = 0;
+    uint64_t points_kept = 0;
+    uint64_t points_dropped = 0;
+    //netstate (or traci) vehicle entries (one per vehicle per timestep)
+    uint64_t entries_kept = 0;
+    uint64_t entries_dropped = 0;
+
+    /**
+     * Constructor
+     * @param rate the fraction of vehicles to keep (0, 1]
+     * @param seed the hash seed
+     */
+    vehicle_sample_t(double rate, uint64_t seed);
+
+    /**
+     * Check if a vehicle is in the sample
+     * @param  vehicle_id the vehicle id
+     * @return            whether the vehicle is kept
+     */
+    bool keep(std::string_view vehicle_id) const;
+
+    /**
+     * @return the sample rate
+     */
+    double get_rate() const {
+      return this->rate;
+    }
+
+    /**
+     * @return the hash seed
+     */
+    uint64_t get_seed() const {
+      return this->seed;
+    }
+  };
+
+  /**
+   * Get the factor to scale sampled counts by
+   * @param  kept    kept elements
+   * @param  dropped dropped elements
+   * @return         all elements per kept element (1 if nothing was kept)
+   */
+  inline double scale_factor(uint64_t kept, uint64_t dropped) {
+    return kept ? (double) (kept + dropped) / kept : 1.0;
+  }
+}
+
+#endif /*_VEHICLE_SAMPLE_H*/
@@ -0,0 +1,152 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "alloc_stats.h"
+
+#ifdef ALLOC_STATS
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <malloc.h>
+
+namespace stats {
+  //counters (relaxed: totals only need to be exact once threads are joined)
+  static std::atomic<uint64_t> allocs(0);
+  static std::atomic<uint64_t> bytes(0);
+  static std::atomic<uint64_t> frees(0);
+  static std::atomic<int64_t> live(0);
+  static std::atomic<int64_t> peak(0);
+
+  /**
+   * Record an allocation
+   * @param ptr  the allocated memory
+   * @param size the requested size
+   */
+  inline void on_alloc(void *ptr, size_t size) {
+    int64_t usable = (int64_t) malloc_usable_size(ptr);
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t now = live.fetch_add(usable, std::memory_order_relaxed) + usable;
+
+    int64_t prev = peak.load(std::memory_order_relaxed);
+    while ((now > prev) && !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+  }
+
+  /**
+   * Record a free
+   * @param ptr the memory being freed (may be null)
+   */
+  inline void on_free(void *ptr) {
+    if (ptr) {
+      frees.fetch_add(1, std::memory_order_relaxed);
+      live.fetch_sub((int64_t) malloc_usable_size(ptr), std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Allocate and count
+   * @param  size  the requested size
+   * @param  align the alignment (0 for default)
+   * @return       the memory or null
+   */
+  inline void *counted_alloc(size_t size, size_t align) {
+    void *ptr = NULL;
+    if (align > alignof(std::max_align_t)) {
+      if (posix_memalign(&ptr, align, size ? size : 1) != 0) {
+        ptr = NULL;
+      }
+    } else {
+      ptr = malloc(size ? size : 1);
+    }
+
+    if (ptr) {
+      on_alloc(ptr, size);
+    }
+    return ptr;
+  }
+
+  /**
+   * Allocate and count, throw on failure
+   */
+  inline void *counted_alloc_throw(size_t size, size_t align) {
+    void *ptr = counted_alloc(size, align);
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+    return ptr;
+  }
+
+  /**
+   * Free and count
+   */
+  inline void counted_free(void *ptr) {
+    on_free(ptr);
+    free(ptr);
+  }
+
+  /**
+   * Read the current allocator counters
+   * @return the counters
+   */
+  alloc_snapshot_t alloc_snapshot() {
+    return {
+      allocs.load(std::memory_order_relaxed),
+      bytes.load(std::memory_order_relaxed),
+      frees.load(std::memory_order_relaxed),
+      live.load(std::memory_order_relaxed),
+      peak.load(std::memory_order_relaxed)
+    };
+  }
+
+  /**
+   * Reset the peak to the current live byte count
+   */
+  void alloc_reset_peak() {
+    peak.store(live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+}
+
+//global replacements
+void *operator new(size_t size) { return stats::counted_alloc_throw(size, 0); }
+void *operator new[](size_t size) { return stats::counted_alloc_throw(size, 0); }
+void *operator new(size_t size, const std::nothrow_t&) noexcept { return stats::counted_alloc(size, 0); }
+void *operator new[](size_t size, const std::nothrow_t&) noexcept { return stats::counted_alloc(size, 0); }
+void *operator new(size_t size, std::align_val_t al) { return stats::counted_alloc_throw(size, (size_t) al); }
+void *operator new[](size_t size, std::align_val_t al) { return stats::counted_alloc_throw(size, (size_t) al); }
+void *operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return stats::counted_alloc(size, (size_t) al); }
+void *operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return stats::counted_alloc(size, (size_t) al); }
+
+void operator delete(void *ptr) noexcept { stats::counted_free(ptr); }
+void operator delete[](void *ptr) noexcept { stats::counted_free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { stats::counted_free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { stats::counted_free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t&) noexcept { stats::counted_free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept { stats::counted_free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { stats::counted_free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { stats::counted_free(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { stats::counted_free(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { stats::counted_free(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t&) noexcept { stats::counted_free(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t&) noexcept { stats::counted_free(ptr); }
+
+#else
+
+namespace stats {
+  /**
+   * Read the current allocator counters (not maintained in this build)
+   * @return zeroed counters
+   */
+  alloc_snapshot_t alloc_snapshot() {
+    return {0, 0, 0, 0, 0};
+  }
+
+  /**
+   * Reset the peak (not maintained in this build)
+   */
+  void alloc_reset_peak() {}
+}
+
+#endif /*ALLOC_STATS*/
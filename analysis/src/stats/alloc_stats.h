@@ -0,0 +1,39 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _ALLOC_STATS_H
+#define _ALLOC_STATS_H
+
+#include <stdint.h>
+
+namespace stats {
+  /*
+   * Global allocator counters (only maintained when built with ALLOC_STATS=1)
+   */
+  struct alloc_snapshot_t {
+    //number of calls to operator new
+    uint64_t allocs;
+    //bytes requested from operator new
+    uint64_t bytes;
+    //number of calls to operator delete
+    uint64_t frees;
+    //bytes currently allocated (usable size)
+    int64_t live;
+    //highest value of live since the last peak reset
+    int64_t peak;
+  };
+
+  /**
+   * Read the current allocator counters
+   * @return the counters
+   */
+  alloc_snapshot_t alloc_snapshot();
+
+  /**
+   * Reset the peak to the current live byte count
+   */
+  void alloc_reset_peak();
+}
+
+#endif /*_ALLOC_STATS_H*/
@@ -0,0 +1,129 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "perf_counters.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace stats {
+  //file descriptors for each counter (-1 if unavailable)
+  static int counter_fds[PERF_COUNTER_COUNT] = {-1, -1, -1, -1, -1};
+  static bool enabled = false;
+
+  /**
+   * Get the display name of a counter
+   * @param  counter the counter
+   * @return         the name
+   */
+  const char *perf_counter_name(int counter) {
+    switch (counter) {
+      case PERF_CYCLES:        return "cycles";
+      case PERF_INSTRUCTIONS:  return "instructions";
+      case PERF_CACHE_MISSES:  return "cache-misses";
+      case PERF_BRANCH_MISSES: return "branch-misses";
+      case PERF_PAGE_FAULTS:   return "page-faults";
+      default:                 return "?";
+    }
+  }
+
+#ifdef __linux__
+  /**
+   * Open a single counter for the calling process (and threads it creates)
+   * @param  type   the event type
+   * @param  config the event
+   * @return        the fd or -1
+   */
+  int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.inherit = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    //user space only for hardware events (allowed at perf_event_paranoid <= 2)
+    attr.exclude_kernel = (type == PERF_TYPE_HARDWARE) ? 1 : 0;
+    attr.exclude_hv = 1;
+
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+#endif
+
+  /**
+   * Open hardware/software counters for this process (perf_event_open)
+   * @return whether at least one counter is available
+   */
+  bool perf_counters_open() {
+#ifdef __linux__
+    const uint32_t types[PERF_COUNTER_COUNT] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+    };
+    const uint64_t configs[PERF_COUNTER_COUNT] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_PAGE_FAULTS
+    };
+
+    bool any = false;
+    for (int i=0; i<PERF_COUNTER_COUNT; i++) {
+      counter_fds[i] = open_counter(types[i], configs[i]);
+      if (counter_fds[i] < 0) {
+        std::cerr << "WARN: perf counter " << perf_counter_name(i) << " unavailable: " << strerror(errno) << std::endl;
+      } else {
+        any = true;
+      }
+    }
+
+    if (!any) {
+      std::cerr << "WARN: no perf counters available (check /proc/sys/kernel/perf_event_paranoid), reporting time only" << std::endl;
+    }
+    enabled = true;
+    return any;
+#else
+    std::cerr << "WARN: perf counters are only supported on linux, reporting time only" << std::endl;
+    enabled = true;
+    return false;
+#endif
+  }
+
+  /**
+   * Whether counters have been opened
+   * @return if enabled
+   */
+  bool perf_counters_enabled() {
+    return enabled;
+  }
+
+  /**
+   * Read the current counter values (scaled if the kernel multiplexed them)
+   * @return the sample
+   */
+  perf_sample_t perf_counters_read() {
+    perf_sample_t sample;
+
+    for (int i=0; i<PERF_COUNTER_COUNT; i++) {
+      sample.values[i] = 0;
+      sample.valid[i] = false;
+
+#ifdef __linux__
+      uint64_t data[3];
+      if ((counter_fds[i] >= 0) && (read(counter_fds[i], data, sizeof(data)) == (ssize_t) sizeof(data))) {
+        //data = {value, time enabled, time running}
+        sample.values[i] = ((data[2] > 0) && (data[2] < data[1]))
+          ? (uint64_t) ((double) data[0] * ((double) data[1] / (double) data[2]))
+          : data[0];
+        sample.valid[i] = true;
+      }
+#endif
+    }
+    return sample;
+  }
+}
@@ -0,0 +1,56 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _PERF_COUNTERS_H
+#define _PERF_COUNTERS_H
+
+#include <stdint.h>
+
+namespace stats {
+
+  //counters recorded for each phase
+  enum perf_counter_e {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_PAGE_FAULTS,
+    PERF_COUNTER_COUNT
+  };
+
+  /*
+   * A reading of all counters (counters that could not be opened are invalid)
+   */
+  struct perf_sample_t {
+    uint64_t values[PERF_COUNTER_COUNT];
+    bool valid[PERF_COUNTER_COUNT];
+  };
+
+  /**
+   * Open hardware/software counters for this process (perf_event_open)
+   * @return whether at least one counter is available
+   */
+  bool perf_counters_open();
+
+  /**
+   * Whether counters have been opened
+   * @return if enabled
+   */
+  bool perf_counters_enabled();
+
+  /**
+   * Read the current counter values (scaled if the kernel multiplexed them)
+   * @return the sample
+   */
+  perf_sample_t perf_counters_read();
+
+  /**
+   * Get the display name of a counter
+   * @param  counter the counter
+   * @return         the name
+   */
+  const char *perf_counter_name(int counter);
+}
+
+#endif /*_PERF_COUNTERS_H*/
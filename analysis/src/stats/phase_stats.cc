@@ -0,0 +1,141 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "phase_stats.h"
+#include "alloc_stats.h"
+#include "perf_counters.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+namespace stats {
+  //phases are per thread (batch workers run their own pipelines)
+  //the phase currently being recorded (empty if none)
+  static thread_local std::string current_phase;
+  //elements processed in the current phase
+  static thread_local uint64_t phase_element_count = 0;
+  static thread_local std::chrono::steady_clock::time_point phase_start_time;
+  //counters at the start of the current phase
+  static thread_local perf_sample_t phase_start_perf;
+#ifdef ALLOC_STATS
+  static thread_local alloc_snapshot_t phase_start_alloc;
+#endif
+  //whether phases on this thread are reported (the allocator and perf counters are
+  //process wide, so concurrent batch workers would report each other's work)
+  static thread_local bool phases_enabled = true;
+
+  /**
+   * Enable or disable phase reporting on the calling thread (enabled by default)
+   * @param enabled whether phases begun on this thread are recorded and reported
+   */
+  void phase_stats_enable(bool enabled) {
+    phases_enabled = enabled;
+  }
+
+  /**
+   * Begin a pipeline phase (ends the current phase if one is still open)
+   * @param name the name of the phase
+   */
+  void phase_begin(const std::string& name) {
+    if (!current_phase.empty()) {
+      phase_end();
+    }
+
+    if (!phases_enabled) {
+      return;
+    }
+
+    current_phase = name;
+    phase_element_count = 0;
+#ifdef ALLOC_STATS
+    alloc_reset_peak();
+    phase_start_alloc = alloc_snapshot();
+#endif
+    if (perf_counters_enabled()) {
+      phase_start_perf = perf_counters_read();
+    }
+    phase_start_time = std::chrono::steady_clock::now();
+  }
+
+  /**
+   * Record elements processed in the current phase (for per element rates)
+   * @param count the number of elements
+   */
+  void phase_elements(uint64_t count) {
+    phase_element_count += count;
+  }
+
+  /**
+   * Report hardware counters for the phase
+   * @param elapsed the phase wall time
+   */
+  void report_perf(double elapsed) {
+    perf_sample_t end = perf_counters_read();
+    uint64_t delta[PERF_COUNTER_COUNT];
+
+    std::cerr << "STATS: [perf] " << std::left << std::setw(24) << current_phase << std::right
+              << " time " << std::fixed << std::setprecision(3) << elapsed << "s"
+              << " elements " << phase_element_count;
+
+    for (int i=0; i<PERF_COUNTER_COUNT; i++) {
+      delta[i] = end.values[i] - phase_start_perf.values[i];
+      std::cerr << " " << perf_counter_name(i) << " ";
+      if (end.valid[i] && phase_start_perf.valid[i]) {
+        std::cerr << delta[i];
+      } else {
+        std::cerr << "n/a";
+      }
+    }
+
+    //instructions per cycle
+    if (end.valid[PERF_CYCLES] && end.valid[PERF_INSTRUCTIONS] && (delta[PERF_CYCLES] > 0)) {
+      std::cerr << " ipc " << std::setprecision(2) << ((double) delta[PERF_INSTRUCTIONS] / (double) delta[PERF_CYCLES]);
+    }
+
+    //misses per element processed
+    if (phase_element_count > 0) {
+      for (int i : {PERF_CACHE_MISSES, PERF_BRANCH_MISSES}) {
+        if (end.valid[i]) {
+          std::cerr << " " << perf_counter_name(i) << "/elem " << std::setprecision(3)
+                    << ((double) delta[i] / (double) phase_element_count);
+        }
+      }
+    }
+
+    std::cerr << std::defaultfloat << std::endl;
+  }
+
+  /**
+   * End the current phase and report what was recorded for it
+   * (no-op unless built with a stats flavour or perf counters are enabled)
+   */
+  void phase_end() {
+    if (current_phase.empty()) {
+      return;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - phase_start_time).count();
+
+    if (perf_counters_enabled()) {
+      report_perf(elapsed);
+    }
+
+#ifdef ALLOC_STATS
+    alloc_snapshot_t end = alloc_snapshot();
+
+    std::cerr << "STATS: [alloc] " << std::left << std::setw(24) << current_phase << std::right
+              << " allocs " << std::setw(10) << (end.allocs - phase_start_alloc.allocs)
+              << " bytes " << std::setw(12) << (end.bytes - phase_start_alloc.bytes)
+              << " frees " << std::setw(10) << (end.frees - phase_start_alloc.frees)
+              << " live " << std::setw(12) << end.live
+              << " peak " << std::setw(12) << end.peak
+              << " time " << std::fixed << std::setprecision(3) << elapsed << "s"
+              << std::defaultfloat << std::endl;
+#else
+    (void) elapsed;
+#endif
+
+    current_phase.clear();
+  }
+}
@@ -0,0 +1,38 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _PHASE_STATS_H
+#define _PHASE_STATS_H
+
+#include <string>
+#include <stdint.h>
+
+namespace stats {
+
+  /**
+   * Begin a pipeline phase (ends the current phase if one is still open)
+   * @param name the name of the phase
+   */
+  void phase_begin(const std::string& name);
+
+  /**
+   * Record elements processed in the current phase (for per element rates)
+   * @param count the number of elements
+   */
+  void phase_elements(uint64_t count);
+
+  /**
+   * End the current phase and report what was recorded for it
+   * (no-op unless built with a stats flavour or perf counters are enabled)
+   */
+  void phase_end();
+
+  /**
+   * Enable or disable phase reporting on the calling thread (enabled by default)
+   * @param enabled whether phases begun on this thread are recorded and reported
+   */
+  void phase_stats_enable(bool enabled);
+}
+
+#endif /*_PHASE_STATS_H*/
@@ -0,0 +1,142 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "byte_source.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace stream {
+
+  //how often a growing file is checked for new data
+  #define POLL_INTERVAL_MS 50
+  //bytes needed to detect compression
+  #define MAGIC_SIZE 2
+
+  /**
+   * Constructor
+   * @param follow          whether to wait for a regular file to grow at its end
+   * @param idle_timeout_ms how long to wait for new data (or the file to appear)
+   */
+  byte_source_t::byte_source_t(bool follow, int idle_timeout_ms)
+    : fd(-1), follow(follow), pipe(false), idle_timeout_ms(idle_timeout_ms), detected(false), pending_pos(0), closing(false) {}
+
+  /**
+   * Destructor: close the file
+   */
+  byte_source_t::~byte_source_t() {
+    //stop inflating before the file is closed (the inflate thread may be waiting for more members)
+    this->closing = true;
+    this->gzip.reset();
+
+    if (this->fd >= 0) {
+      close(this->fd);
+    }
+  }
+
+  /**
+   * Open the file (in follow mode, wait for it to be created)
+   * @param  path the path
+   * @return      success or failure
+   */
+  bool byte_source_t::open(const std::string& path) {
+    int waited_ms = 0;
+
+    //opening a pipe blocks until the writer opens it
+    while ((this->fd = ::open(path.c_str(), O_RDONLY)) < 0) {
+      if (!this->follow || (errno != ENOENT) || (waited_ms >= this->idle_timeout_ms)) {
+        std::cerr << "ERR: unable to open input: " << path << std::endl;
+        return false;
+      }
+      usleep(POLL_INTERVAL_MS * 1000);
+      waited_ms += POLL_INTERVAL_MS;
+    }
+
+    struct stat f_info;
+    this->pipe = (fstat(this->fd, &f_info) == 0) && S_ISFIFO(f_info.st_mode);
+
+    if (!this->pipe) {
+      //the file is read front to back
+      posix_fadvise(this->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    return true;
+  }
+
+  /**
+   * Read the next bytes, inflated if compressed (blocks until data is available when following)
+   * @param  buff the buffer
+   * @param  size the buffer size
+   * @return      the bytes read, 0 at the end (or idle timeout), -1 on error
+   */
+  ssize_t byte_source_t::read(char *buff, size_t size) {
+    if (!this->detected) {
+      this->detected = true;
+
+      //check the magic (a growing file may have fewer bytes so far)
+      char magic[MAGIC_SIZE];
+      size_t got = 0;
+      while (got < MAGIC_SIZE) {
+        ssize_t n = read_file(magic + got, MAGIC_SIZE - got);
+        if (n < 0) {
+          return n;
+        } else if (n == 0) {
+          break;
+        }
+        got += n;
+      }
+
+      if (is_gzip(magic, got)) {
+        this->gzip = std::make_unique<gzip_source_t>([this] (char *b, size_t s) {
+          return this->read_file(b, s);
+        }, magic, got);
+      } else {
+        this->pending.assign(magic, magic + got);
+      }
+    }
+
+    if (this->gzip) {
+      return this->gzip->read(buff, size);
+    }
+
+    if (this->pending_pos < this->pending.size()) {
+      size_t n = std::min(size, this->pending.size() - this->pending_pos);
+      memcpy(buff, this->pending.data() + this->pending_pos, n);
+      this->pending_pos += n;
+      return n;
+    }
+
+    return read_file(buff, size);
+  }
+
+  /**
+   * Read the next bytes from the file
+   * @param  buff the buffer
+   * @param  size the buffer size
+   * @return      the bytes read, 0 at the end (or idle timeout), -1 on error
+   */
+  ssize_t byte_source_t::read_file(char *buff, size_t size) {
+    int waited_ms = 0;
+
+    while (true) {
+      ssize_t n = ::read(this->fd, buff, size);
+
+      if ((n < 0) && (errno == EINTR)) {
+        continue;
+      } else if ((n != 0) || !this->follow || this->pipe || this->closing) {
+        return n;
+      } else if (waited_ms >= this->idle_timeout_ms) {
+        std::cerr << "WARN: no new input for " << (waited_ms / 1000) << "s" << std::endl;
+        return 0;
+      }
+
+      //the writer has not caught up: wait for the file to grow
+      usleep(POLL_INTERVAL_MS * 1000);
+      waited_ms += POLL_INTERVAL_MS;
+    }
+  }
+}
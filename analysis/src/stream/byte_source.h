@@ -0,0 +1,81 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _BYTE_SOURCE_H
+#define _BYTE_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <sys/types.h>
+#include "gzip_source.h"
+
+namespace stream {
+  /*
+   * Reads a file that may still be written (follow mode: the end of a regular
+   * file is waited on until it grows) or a named pipe (ends when the writer closes).
+   * Gzip compressed input is detected and inflated on its own thread
+   */
+  struct byte_source_t {
+  private:
+    int fd;
+    bool follow;
+    //end of file is final for pipes
+    bool pipe;
+    //give up after this long without new data (follow mode)
+    int idle_timeout_ms;
+    //whether the first bytes have been checked for compression
+    bool detected;
+    //bytes read while checking (plain input)
+    std::vector<char> pending;
+    size_t pending_pos;
+    //inflates compressed input (reads the file on its thread)
+    std::unique_ptr<gzip_source_t> gzip;
+    //stops waiting for the file to grow (the reader is done)
+    std::atomic<bool> closing;
+
+    /**
+     * Read the next bytes from the file
+     * @param  buff the buffer
+     * @param  size the buffer size
+     * @return      the bytes read, 0 at the end (or idle timeout), -1 on error
+     */
+    ssize_t read_file(char *buff, size_t size);
+
+  public:
+    /**
+     * Constructor
+     * @param follow          whether to wait for a regular file to grow at its end
+     * @param idle_timeout_ms how long to wait for new data (or the file to appear)
+     */
+    byte_source_t(bool follow, int idle_timeout_ms);
+
+    /**
+     * Destructor: close the file
+     */
+    ~byte_source_t();
+
+    //no copy
+    byte_source_t(const byte_source_t&) = delete;
+    byte_source_t& operator=(const byte_source_t&) = delete;
+
+    /**
+     * Open the file (in follow mode, wait for it to be created)
+     * @param  path the path
+     * @return      success or failure
+     */
+    [[nodiscard]] bool open(const std::string& path);
+
+    /**
+     * Read the next bytes, inflated if compressed (blocks until data is available when following)
+     * @param  buff the buffer
+     * @param  size the buffer size
+     * @return      the bytes read, 0 at the end (or idle timeout), -1 on error
+     */
+    ssize_t read(char *buff, size_t size);
+  };
+}
+
+#endif /*_BYTE_SOURCE_H*/
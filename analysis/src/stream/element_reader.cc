@@ -0,0 +1,270 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "element_reader.h"
+#include <iostream>
+#include <cstring>
+#include <cctype>
+
+namespace stream {
+
+  //initial buffer size (grows to fit the largest element)
+  #define INITIAL_BUFFER (1 << 20)
+
+  static const size_t npos = std::string::npos;
+
+  /**
+   * Constructor
+   * @param source the source of the document
+   */
+  element_reader_t::element_reader_t(byte_source_t& source)
+    : source(source), buff(INITIAL_BUFFER), begin(0), end(0), scan(0), elem_start(npos), depth(0),
+      terminated_at(npos), terminated_char(0), opened(false), closed(false) {}
+
+  /**
+   * Find the end of the markup (tag, comment, declaration) starting at pos
+   * @param  pos the position of '<'
+   * @return     the position after its '>' (npos if not read yet)
+   */
+  size_t element_reader_t::markup_end(size_t pos) const {
+    const char *data = this->buff.data();
+    size_t remaining = this->end - pos;
+
+    //constructs with their own terminators
+    const char *terminator = nullptr;
+    if ((remaining >= 4) && (strncmp(data + pos, "<!--", 4) == 0)) {
+      terminator = "-->";
+    } else if ((remaining >= 9) && (strncmp(data + pos, "<![CDATA[", 9) == 0)) {
+      terminator = "]]>";
+    } else if ((remaining >= 2) && (data[pos + 1] == '?')) {
+      terminator = "?>";
+    } else if (remaining < 9) {
+      //may still turn out to be a comment or cdata
+      if (((remaining < 4) && (strncmp(data + pos, "<!--", remaining) == 0)) ||
+          (strncmp(data + pos, "<![CDATA[", remaining) == 0)) {
+        return npos;
+      }
+    }
+
+    if (terminator != nullptr) {
+      size_t t_size = strlen(terminator);
+      for (size_t i=pos + 2; i + t_size <= this->end; i++) {
+        if (strncmp(data + i, terminator, t_size) == 0) {
+          return i + t_size;
+        }
+      }
+      return npos;
+    }
+
+    //tags: '>' outside of quoted attribute values
+    char quote = 0;
+    for (size_t i=pos + 1; i<this->end; i++) {
+      if (quote != 0) {
+        if (data[i] == quote) {
+          quote = 0;
+        }
+      } else if ((data[i] == '"') || (data[i] == '\'')) {
+        quote = data[i];
+      } else if (data[i] == '>') {
+        return i + 1;
+      }
+    }
+    return npos;
+  }
+
+  /**
+   * Split the next complete element from the read data
+   * @param  elem the element text
+   * @param  size the element size
+   * @return      1 if an element was split, 0 if more data is needed, -1 at the closing root tag
+   */
+  int element_reader_t::split(char*& elem, size_t& size) {
+    char *data = this->buff.data();
+    size_t pos = this->scan;
+
+    while (pos < this->end) {
+      //find the next markup
+      while ((pos < this->end) && (data[pos] != '<')) {
+        pos++;
+      }
+      if (pos == this->end) {
+        break;
+      }
+
+      size_t close = markup_end(pos);
+      if (close == npos) {
+        //resume at this markup
+        break;
+      }
+
+      bool is_end_tag = (data[pos + 1] == '/');
+      bool is_start_tag = !is_end_tag && (data[pos + 1] != '!') && (data[pos + 1] != '?');
+      bool self_closing = is_start_tag && (data[close - 2] == '/');
+
+      if (this->elem_start == npos) {
+        if (is_end_tag && this->opened) {
+          //closing root tag
+          this->closed = true;
+          this->begin = this->scan = close;
+          return -1;
+
+        } else if (is_start_tag && !this->opened) {
+          //root tag
+          size_t name_end = pos + 1;
+          while ((name_end < close) && !isspace((unsigned char) data[name_end]) &&
+                 (data[name_end] != '>') && (data[name_end] != '/')) {
+            name_end++;
+          }
+          this->root.assign(data + pos + 1, name_end - pos - 1);
+          this->opened = true;
+          this->closed = self_closing;
+          if (self_closing) {
+            this->begin = this->scan = close;
+            return -1;
+          }
+
+        } else if (is_start_tag) {
+          //child element
+          this->elem_start = pos;
+          this->depth = self_closing ? 0 : 1;
+        }
+
+        if (this->elem_start == npos) {
+          //declarations, comments, text between elements are consumed
+          this->begin = close;
+        }
+
+      } else if (is_end_tag) {
+        this->depth--;
+      } else if (is_start_tag && !self_closing) {
+        this->depth++;
+      }
+
+      pos = close;
+
+      if ((this->elem_start != npos) && (this->depth == 0)) {
+        //terminate in place (restored on the next read)
+        this->terminated_at = pos;
+        this->terminated_char = data[pos];
+        data[pos] = '\0';
+
+        elem = data + this->elem_start;
+        size = pos - this->elem_start;
+        this->elem_start = npos;
+        this->begin = this->scan = pos;
+        return 1;
+      }
+    }
+
+    this->scan = pos;
+    return 0;
+  }
+
+  /**
+   * Read the next complete child element of the root
+   * @param  elem the element text (null terminated, modifiable until the next call)
+   * @param  size the element size
+   * @return      whether an element was read (false at the closing root tag or the end of the source)
+   */
+  bool element_reader_t::next(char*& elem, size_t& size) {
+    if (this->terminated_at != npos) {
+      this->buff[this->terminated_at] = this->terminated_char;
+      this->terminated_at = npos;
+    }
+
+    while (!this->closed) {
+      int split_stat = split(elem, size);
+      if (split_stat != 0) {
+        return split_stat > 0;
+      }
+
+      //drop consumed data
+      if (this->begin > 0) {
+        memmove(this->buff.data(), this->buff.data() + this->begin, this->end - this->begin);
+        this->end -= this->begin;
+        this->scan -= this->begin;
+        if (this->elem_start != npos) {
+          this->elem_start -= this->begin;
+        }
+        this->begin = 0;
+      }
+
+      //grow to fit the element (keeping space for a terminator)
+      if (this->end + 1 >= this->buff.size()) {
+        this->buff.resize(this->buff.size() * 2);
+      }
+
+      ssize_t n = this->source.read(this->buff.data() + this->end, this->buff.size() - this->end - 1);
+      if (n <= 0) {
+        return false;
+      }
+      this->end += n;
+    }
+    return false;
+  }
+
+  /**
+   * Parse each child element of the root of a document as it is written, execute handler
+   * @param  path            the path to the file or named pipe
+   * @param  root_name       the expected root element
+   * @param  follow          whether to wait for the file to grow until the root is closed
+   * @param  idle_timeout_ms how long to wait for new data
+   * @param  handler         called with each element (valid for the call)
+   * @param  accept          if set, called with the element text first: rejected elements are not parsed
+   * @return                 success or failure (parse error, handler exception, no closing root tag)
+   */
+  bool follow_elements(const std::string& path,
+                       const char *root_name,
+                       bool follow,
+                       int idle_timeout_ms,
+                       std::function<void(rapidxml::xml_node<>*)> handler,
+                       std::function<bool(const char*,size_t)> accept) {
+    byte_source_t source(follow, idle_timeout_ms);
+    if (!source.open(path)) {
+      return false;
+    }
+
+    element_reader_t reader(source);
+    rapidxml::xml_document<> doc;
+    char *elem;
+    size_t size;
+
+    while (reader.next(elem, size)) {
+      if (reader.root_name() != root_name) {
+        std::cerr << "ERR doc root node not: " << root_name << std::endl;
+        return false;
+      }
+
+      if (accept && !accept(elem, size)) {
+        //skipped without parsing
+        continue;
+      }
+
+      try {
+        //each element is parsed as its own document
+        doc.clear();
+        doc.parse<0>(elem);
+        handler(doc.first_node());
+
+      } catch (rapidxml::parse_error& e) {
+        std::cerr << "ERR: parse error in " << path << ": " << e.what() << std::endl;
+        return false;
+      } catch (...) {
+        std::cerr << "ERR handler for " << path << " threw exception" << std::endl;
+        return false;
+      }
+    }
+
+    if (!reader.is_closed()) {
+      std::cerr << "ERR: " << path << " ended before the closing root tag" << std::endl;
+      return false;
+    }
+
+    if (reader.root_name() != root_name) {
+      std::cerr << "ERR doc root node not: " << root_name << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
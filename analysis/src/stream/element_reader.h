@@ -0,0 +1,106 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _ELEMENT_READER_H
+#define _ELEMENT_READER_H
+
+#include <rapidxml.hpp>
+#include <string>
+#include <vector>
+#include <functional>
+#include "byte_source.h"
+
+namespace stream {
+  /*
+   * Incremental tokenizer that splits an xml document into the complete children
+   * of its root element as bytes arrive (the document is never held in memory).
+   * Tag scanning resumes where it stopped when an element is incomplete
+   */
+  struct element_reader_t {
+  private:
+    byte_source_t& source;
+    std::vector<char> buff;
+    //unconsumed data starts at begin, read data ends at end
+    size_t begin;
+    size_t end;
+    //where tag scanning resumes
+    size_t scan;
+    //the start of the element being scanned (npos between elements)
+    size_t elem_start;
+    //open tags in the element being scanned
+    int depth;
+    //the byte overwritten to terminate the last element
+    size_t terminated_at;
+    char terminated_char;
+    //the root element name, and whether it has been opened and closed
+    std::string root;
+    bool opened;
+    bool closed;
+
+    /**
+     * Find the end of the markup (tag, comment, declaration) starting at pos
+     * @param  pos the position of '<'
+     * @return     the position after its '>' (npos if not read yet)
+     */
+    size_t markup_end(size_t pos) const;
+
+    /**
+     * Split the next complete element from the read data
+     * @param  elem the element text
+     * @param  size the element size
+     * @return      1 if an element was split, 0 if more data is needed, -1 at the closing root tag
+     */
+    int split(char*& elem, size_t& size);
+
+  public:
+    /**
+     * Constructor
+     * @param source the source of the document
+     */
+    element_reader_t(byte_source_t& source);
+
+    //no copy
+    element_reader_t(const element_reader_t&) = delete;
+    element_reader_t& operator=(const element_reader_t&) = delete;
+
+    /**
+     * Read the next complete child element of the root
+     * @param  elem the element text (null terminated, modifiable until the next call)
+     * @param  size the element size
+     * @return      whether an element was read (false at the closing root tag or the end of the source)
+     */
+    bool next(char*& elem, size_t& size);
+
+    /**
+     * Whether the closing root tag has been read
+     * @return whether the document is complete
+     */
+    bool is_closed() const { return this->closed; }
+
+    /**
+     * Get the name of the root element
+     * @return the name (empty until read)
+     */
+    const std::string& root_name() const { return this->root; }
+  };
+
+  /**
+   * Parse each child element of the root of a document as it is written, execute handler
+   * @param  path            the path to the file or named pipe
+   * @param  root_name       the expected root element
+   * @param  follow          whether to wait for the file to grow until the root is closed
+   * @param  idle_timeout_ms how long to wait for new data
+   * @param  handler         called with each element (valid for the call)
+   * @param  accept          if set, called with the element text first: rejected elements are not parsed
+   * @return                 success or failure (parse error, handler exception, no closing root tag)
+   */
+  [[nodiscard]] bool follow_elements(const std::string& path,
+                                     const char *root_name,
+                                     bool follow,
+                                     int idle_timeout_ms,
+                                     std::function<void(rapidxml::xml_node<>*)> handler,
+                                     std::function<bool(const char*,size_t)> accept = nullptr);
+}
+
+#endif /*_ELEMENT_READER_H*/
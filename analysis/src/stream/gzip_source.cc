@@ -0,0 +1,465 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "gzip_source.h"
+#include <zlib.h>
+#include <iostream>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+namespace stream {
+
+  #define GZIP_ID1        0x1f
+  #define GZIP_ID2        0x8b
+  #define GZIP_CM_DEFLATE 8
+  #define GZIP_FEXTRA     0x04
+  //fixed header, extra length
+  #define GZIP_HEADER     10
+  #define GZIP_XLEN       2
+  //crc32, input size
+  #define GZIP_TRAILER    8
+  //bgzf extra subfield: compressed block size - 1
+  #define BGZF_SI1        'B'
+  #define BGZF_SI2        'C'
+  #define BGZF_SLEN       2
+
+  //compressed reads, inflated chunks
+  #define READ_CHUNK         (256 << 10)
+  #define INFLATE_CHUNK      (1 << 20)
+  //inflated chunks held ahead of the reader
+  #define READ_AHEAD_CHUNKS  8
+  //window bits: any zlib/gzip header, raw deflate
+  #define WBITS_AUTO         (15 + 32)
+  #define WBITS_RAW          -15
+
+  /**
+   * Read a little endian uint16
+   * @param  p the bytes
+   * @return   the value
+   */
+  inline uint32_t le16(const unsigned char *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8);
+  }
+
+  /**
+   * Read a little endian uint32
+   * @param  p the bytes
+   * @return   the value
+   */
+  inline uint32_t le32(const unsigned char *p) {
+    return le16(p) | (le16(p + 2) << 16);
+  }
+
+  /**
+   * Whether data starts with the gzip magic
+   * @param  data the data
+   * @param  size the data size
+   * @return      whether the data is gzip compressed
+   */
+  bool is_gzip(const char *data, size_t size) {
+    return (size >= 2) &&
+           ((unsigned char) data[0] == GZIP_ID1) &&
+           ((unsigned char) data[1] == GZIP_ID2);
+  }
+
+  /**
+   * Constructor: start inflating
+   * @param read_compressed reads the compressed stream (0 at the end, -1 on error)
+   * @param prefix          compressed bytes already read from the stream
+   * @param prefix_size     the prefix size
+   */
+  gzip_source_t::gzip_source_t(std::function<ssize_t(char*,size_t)> read_compressed,
+                               const char *prefix,
+                               size_t prefix_size)
+    : read_compressed(read_compressed),
+      prefix(prefix, prefix + prefix_size),
+      chunk_pos(0),
+      finished(false),
+      failed(false),
+      stopping(false) {
+    this->worker = std::thread(&gzip_source_t::run, this);
+  }
+
+  /**
+   * Destructor: stop inflating
+   */
+  gzip_source_t::~gzip_source_t() {
+    {
+      std::lock_guard<std::mutex> guard(this->lock);
+      this->stopping = true;
+    }
+    this->space.notify_all();
+    this->worker.join();
+  }
+
+  /**
+   * Queue an inflated chunk (blocks while the read-ahead is full)
+   * @param  chunk the chunk
+   * @return       false if the reader stopped
+   */
+  bool gzip_source_t::push(std::vector<char>&& chunk) {
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->space.wait(guard, [this] {
+      return this->stopping || (this->chunks.size() < READ_AHEAD_CHUNKS);
+    });
+
+    if (this->stopping) {
+      return false;
+    }
+    this->chunks.push_back(std::move(chunk));
+    this->ready.notify_one();
+    return true;
+  }
+
+  /**
+   * Inflate the stream into chunks (inflate thread)
+   */
+  void gzip_source_t::run() {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    bool ok = (inflateInit2(&zs, WBITS_AUTO) == Z_OK);
+
+    std::vector<char> in(this->prefix);
+    in.resize(std::max(in.size(), (size_t) READ_CHUNK));
+    zs.next_in = reinterpret_cast<Bytef*>(in.data());
+    zs.avail_in = this->prefix.size();
+
+    std::vector<char> out(INFLATE_CHUNK);
+    size_t out_used = 0;
+    //whether the last member was complete (nothing is inflated mid member)
+    bool member_end = false;
+
+    while (ok) {
+      if (zs.avail_in == 0) {
+        //hand over what is inflated before a read that may wait (a followed file)
+        if (out_used > 0) {
+          out.resize(out_used);
+          if (!push(std::move(out))) {
+            inflateEnd(&zs);
+            return;
+          }
+          out = std::vector<char>(INFLATE_CHUNK);
+          out_used = 0;
+        }
+
+        ssize_t n = this->read_compressed(in.data(), in.size());
+        if (n < 0) {
+          ok = false;
+          break;
+        } else if (n == 0) {
+          if (!member_end) {
+            std::cerr << "ERR: truncated gzip input" << std::endl;
+            ok = false;
+          }
+          break;
+        }
+        zs.next_in = reinterpret_cast<Bytef*>(in.data());
+        zs.avail_in = n;
+      }
+
+      zs.next_out = reinterpret_cast<Bytef*>(out.data() + out_used);
+      zs.avail_out = out.size() - out_used;
+
+      int ret = inflate(&zs, Z_NO_FLUSH);
+      out_used = out.size() - zs.avail_out;
+
+      if (ret == Z_STREAM_END) {
+        //another member may follow
+        member_end = true;
+        inflateReset(&zs);
+
+      } else if ((ret == Z_OK) || (ret == Z_BUF_ERROR)) {
+        member_end = false;
+
+      } else if (member_end) {
+        //as gzip: trailing data after the last member is ignored
+        std::cerr << "WARN: ignoring trailing data after gzip input" << std::endl;
+        break;
+
+      } else {
+        std::cerr << "ERR: gzip inflate failed: " << (zs.msg ? zs.msg : "corrupt input") << std::endl;
+        ok = false;
+      }
+
+      if (out_used == out.size()) {
+        if (!push(std::move(out))) {
+          inflateEnd(&zs);
+          return;
+        }
+        out = std::vector<char>(INFLATE_CHUNK);
+        out_used = 0;
+      }
+    }
+
+    inflateEnd(&zs);
+
+    if (ok && (out_used > 0)) {
+      out.resize(out_used);
+      ok = push(std::move(out));
+    }
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->finished = true;
+    this->failed = !ok;
+    this->ready.notify_one();
+  }
+
+  /**
+   * Read the next inflated bytes
+   * @param  buff the buffer
+   * @param  size the buffer size
+   * @return      the bytes read, 0 at the end, -1 on error
+   */
+  ssize_t gzip_source_t::read(char *buff, size_t size) {
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->ready.wait(guard, [this] {
+      return this->finished || !this->chunks.empty();
+    });
+
+    if (this->chunks.empty()) {
+      return this->failed ? -1 : 0;
+    }
+
+    std::vector<char>& chunk = this->chunks.front();
+    size_t n = std::min(size, chunk.size() - this->chunk_pos);
+    memcpy(buff, chunk.data() + this->chunk_pos, n);
+    this->chunk_pos += n;
+
+    if (this->chunk_pos == chunk.size()) {
+      this->chunks.pop_front();
+      this->chunk_pos = 0;
+      this->space.notify_one();
+    }
+    return n;
+  }
+
+  /*
+   * A member of a block compressed file
+   */
+  struct gzip_block_t {
+    //deflate data
+    size_t data_offset;
+    size_t data_size;
+    //inflated position
+    uint64_t out_offset;
+    uint32_t out_size;
+    uint32_t crc;
+  };
+
+  /**
+   * Get the size of a member from its bgzf extra subfield
+   * @param  data the member
+   * @param  size the size of the data from the member start
+   * @return      the member size (0 if not a bgzf member)
+   */
+  size_t bgzf_block_size(const unsigned char *data, size_t size) {
+    if ((size < GZIP_HEADER + GZIP_XLEN) ||
+        !is_gzip(reinterpret_cast<const char*>(data), size) ||
+        (data[2] != GZIP_CM_DEFLATE) ||
+        (data[3] != GZIP_FEXTRA)) {
+      return 0;
+    }
+
+    size_t xlen = le16(data + GZIP_HEADER);
+    if (size < GZIP_HEADER + GZIP_XLEN + xlen) {
+      return 0;
+    }
+
+    //find the block size subfield
+    const unsigned char *extra = data + GZIP_HEADER + GZIP_XLEN;
+    for (size_t pos = 0; pos + 4 <= xlen; pos += 4 + le16(extra + pos + 2)) {
+      if ((extra[pos] == BGZF_SI1) && (extra[pos + 1] == BGZF_SI2) && (le16(extra + pos + 2) == BGZF_SLEN)) {
+        return (pos + 6 <= xlen) ? le16(extra + pos + 4) + 1 : 0;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * Inflate a file of independent gzip blocks (bgzf: each member records its compressed
+   * size) with a thread per core into a null terminated buffer
+   * @param  path the path to the file
+   * @param  buff the inflated data (malloc'd, freed by the caller)
+   * @param  size the inflated size
+   * @return      1 if inflated, 0 if the file is not block compressed, -1 on error
+   */
+  int inflate_blocks(const std::string& path, char *&buff, uint64_t& size) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+      std::cerr << "ERR: unable to open input: " << path << std::endl;
+      return -1;
+    }
+
+    //check the first member before reading everything
+    unsigned char header[64];
+    size_t header_size = fread(header, 1, sizeof(header), file);
+    if (bgzf_block_size(header, header_size) == 0) {
+      fclose(file);
+      return 0;
+    }
+
+    fseek(file, 0, SEEK_END);
+    size_t file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    std::vector<unsigned char> data(file_size);
+    bool read = fread(data.data(), 1, file_size, file) == file_size;
+    fclose(file);
+    if (!read) {
+      std::cerr << "ERR: failed to read from " << path << std::endl;
+      return -1;
+    }
+
+    //index the members
+    std::vector<gzip_block_t> blocks;
+    uint64_t total = 0;
+    for (size_t pos = 0; pos < file_size;) {
+      size_t block_size = bgzf_block_size(data.data() + pos, file_size - pos);
+      size_t header_size = GZIP_HEADER + GZIP_XLEN + le16(data.data() + pos + GZIP_HEADER);
+
+      if ((block_size == 0) || (block_size < header_size + GZIP_TRAILER) || (pos + block_size > file_size)) {
+        std::cerr << "ERR: corrupt gzip block at offset " << pos << " in " << path << std::endl;
+        return -1;
+      }
+
+      const unsigned char *trailer = data.data() + pos + block_size - GZIP_TRAILER;
+      blocks.push_back({
+        pos + header_size,
+        block_size - header_size - GZIP_TRAILER,
+        total,
+        le32(trailer + 4),
+        le32(trailer)
+      });
+      total += blocks.back().out_size;
+      pos += block_size;
+    }
+
+    buff = (char*) malloc(total + 1);
+    if (buff == NULL) {
+      std::cerr << "ERR: failed to allocate " << total << " bytes for " << path << std::endl;
+      return -1;
+    }
+
+    //blocks are claimed in order by each thread
+    std::atomic<size_t> next(0);
+    std::atomic<bool> ok(true);
+    unsigned threads = std::max(1u, std::min(std::thread::hardware_concurrency(), (unsigned) blocks.size()));
+
+    std::function<void()> inflate_worker = [&] () {
+      z_stream zs;
+      memset(&zs, 0, sizeof(zs));
+      if (inflateInit2(&zs, WBITS_RAW) != Z_OK) {
+        ok = false;
+        return;
+      }
+
+      for (size_t i = next++; ok && (i < blocks.size()); i = next++) {
+        const gzip_block_t& block = blocks[i];
+        Bytef *out = reinterpret_cast<Bytef*>(buff + block.out_offset);
+
+        inflateReset(&zs);
+        zs.next_in = const_cast<Bytef*>(data.data() + block.data_offset);
+        zs.avail_in = block.data_size;
+        zs.next_out = out;
+        zs.avail_out = block.out_size;
+
+        if ((inflate(&zs, Z_FINISH) != Z_STREAM_END) ||
+            (zs.total_out != block.out_size) ||
+            (crc32(crc32(0, Z_NULL, 0), out, block.out_size) != block.crc)) {
+          std::cerr << "ERR: corrupt gzip block " << i << " in " << path << std::endl;
+          ok = false;
+        }
+      }
+      inflateEnd(&zs);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t=1; t<threads; t++) {
+      workers.emplace_back(inflate_worker);
+    }
+    inflate_worker();
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+
+    if (!ok) {
+      free(buff);
+      buff = NULL;
+      return -1;
+    }
+
+    buff[total] = 0;
+    size = total;
+    return 1;
+  }
+
+  /**
+   * Get the inflated size of a gzip file without inflating it: the sum of the member sizes
+   * of a block compressed (bgzf) file, otherwise the size in the trailer of the last member
+   * (stored modulo 4GB: raised in 4GB steps to at least the compressed size)
+   * @param  path the path to the file
+   * @param  size the inflated size
+   * @return      whether the file is gzip compressed (size is only set if it is)
+   */
+  bool inflated_size(const std::string& path, uint64_t& size) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+      return false;
+    }
+
+    unsigned char header[64];
+    size_t header_size = fread(header, 1, sizeof(header), file);
+    if (!is_gzip(reinterpret_cast<const char*>(header), header_size)) {
+      fclose(file);
+      return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    uint64_t file_size = ftell(file);
+    unsigned char trailer[4];
+    uint64_t total = 0;
+    bool blocks = (bgzf_block_size(header, header_size) > 0);
+
+    //bgzf: walk the member headers, reading the size from each trailer
+    for (uint64_t pos = 0; blocks && (pos < file_size);) {
+      size_t block_size = 0;
+      if (fseek(file, pos, SEEK_SET) == 0) {
+        header_size = fread(header, 1, sizeof(header), file);
+        block_size = bgzf_block_size(header, header_size);
+      }
+
+      if ((block_size < GZIP_TRAILER) || (pos + block_size > file_size) ||
+          (fseek(file, pos + block_size - 4, SEEK_SET) != 0) ||
+          (fread(trailer, 1, sizeof(trailer), file) != sizeof(trailer))) {
+        //not block compressed throughout
+        blocks = false;
+        break;
+      }
+
+      total += le32(trailer);
+      pos += block_size;
+    }
+
+    if (!blocks) {
+      //the last member only (the whole file unless members were concatenated)
+      if ((file_size < GZIP_HEADER + GZIP_TRAILER) ||
+          (fseek(file, file_size - 4, SEEK_SET) != 0) ||
+          (fread(trailer, 1, sizeof(trailer), file) != sizeof(trailer))) {
+        fclose(file);
+        return false;
+      }
+
+      total = le32(trailer);
+      while (total < file_size) {
+        total += (uint64_t) 1 << 32;
+      }
+    }
+
+    fclose(file);
+    size = total;
+    return true;
+  }
+}
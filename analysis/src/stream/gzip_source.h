@@ -0,0 +1,111 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _GZIP_SOURCE_H
+#define _GZIP_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace stream {
+  /**
+   * Whether data starts with the gzip magic
+   * @param  data the data
+   * @param  size the data size
+   * @return      whether the data is gzip compressed
+   */
+  bool is_gzip(const char *data, size_t size);
+
+  /*
+   * Inflates a gzip stream (any number of concatenated members) on its own thread,
+   * keeping a bounded number of inflated chunks ahead of the reader
+   */
+  struct gzip_source_t {
+  private:
+    //reads the compressed stream (called on the inflate thread)
+    std::function<ssize_t(char*,size_t)> read_compressed;
+    //compressed bytes already read from the stream
+    std::vector<char> prefix;
+
+    std::mutex lock;
+    std::condition_variable ready;
+    std::condition_variable space;
+    std::deque<std::vector<char>> chunks;
+    //read position in the front chunk
+    size_t chunk_pos;
+    bool finished;
+    bool failed;
+    bool stopping;
+    std::thread worker;
+
+    /**
+     * Inflate the stream into chunks (inflate thread)
+     */
+    void run();
+
+    /**
+     * Queue an inflated chunk (blocks while the read-ahead is full)
+     * @param  chunk the chunk
+     * @return       false if the reader stopped
+     */
+    bool push(std::vector<char>&& chunk);
+
+  public:
+    /**
+     * Constructor: start inflating
+     * @param read_compressed reads the compressed stream (0 at the end, -1 on error)
+     * @param prefix          compressed bytes already read from the stream
+     * @param prefix_size     the prefix size
+     */
+    gzip_source_t(std::function<ssize_t(char*,size_t)> read_compressed,
+                  const char *prefix,
+                  size_t prefix_size);
+
+    /**
+     * Destructor: stop inflating
+     */
+    ~gzip_source_t();
+
+    //no copy
+    gzip_source_t(const gzip_source_t&) = delete;
+    gzip_source_t& operator=(const gzip_source_t&) = delete;
+
+    /**
+     * Read the next inflated bytes
+     * @param  buff the buffer
+     * @param  size the buffer size
+     * @return      the bytes read, 0 at the end, -1 on error
+     */
+    ssize_t read(char *buff, size_t size);
+  };
+
+  /**
+   * Inflate a file of independent gzip blocks (bgzf: each member records its compressed
+   * size) with a thread per core into a null terminated buffer
+   * @param  path the path to the file
+   * @param  buff the inflated data (malloc'd, freed by the caller)
+   * @param  size the inflated size
+   * @return      1 if inflated, 0 if the file is not block compressed, -1 on error
+   */
+  int inflate_blocks(const std::string& path, char *&buff, uint64_t& size);
+
+  /**
+   * Get the inflated size of a gzip file without inflating it: the sum of the member sizes
+   * of a block compressed (bgzf) file, otherwise the size in the trailer of the last member
+   * (stored modulo 4GB: raised in 4GB steps to at least the compressed size)
+   * @param  path the path to the file
+   * @param  size the inflated size
+   * @return      whether the file is gzip compressed (size is only set if it is)
+   */
+  bool inflated_size(const std::string& path, uint64_t& size);
+}
+
+#endif /*_GZIP_SOURCE_H*/
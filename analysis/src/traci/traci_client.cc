@@ -0,0 +1,532 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "traci_client.h"
+#include <iostream>
+#include <exception>
+#include <cstring>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace traci {
+
+  //commands
+  #define CMD_GETVERSION                    0x00
+  #define CMD_SIMSTEP                       0x02
+  #define CMD_CLOSE                         0x7F
+  #define CMD_SUBSCRIBE_VEHICLE_VARIABLE    0xd4
+  #define RESPONSE_SUBSCRIBE_VEHICLE        0xe4
+  #define CMD_SUBSCRIBE_SIM_VARIABLE        0xdb
+  #define RESPONSE_SUBSCRIBE_SIM            0xeb
+
+  //variables
+  #define VAR_SPEED                         0x40
+  #define VAR_POSITION                      0x42
+  #define VAR_LANE_ID                       0x51
+  #define VAR_LANEPOSITION                  0x56
+  #define VAR_TIME                          0x66
+  #define VAR_DEPARTED_VEHICLES_IDS         0x74
+  #define VAR_MIN_EXPECTED_VEHICLES         0x7d
+
+  //value types
+  #define POSITION_2D                       0x01
+  #define POSITION_3D                       0x03
+  #define TYPE_UBYTE                        0x07
+  #define TYPE_BYTE                         0x08
+  #define TYPE_INTEGER                      0x09
+  #define TYPE_DOUBLE                       0x0B
+  #define TYPE_STRING                       0x0C
+  #define TYPE_STRINGLIST                   0x0E
+  #define TYPE_COMPOUND                     0x0F
+  #define TYPE_DOUBLELIST                   0x10
+  #define TYPE_COLOR                        0x11
+
+  #define RTYPE_OK                          0x00
+
+  //subscribe for the whole simulation
+  #define INVALID_DOUBLE_VALUE              -1073741824.0
+  //between connection attempts
+  #define CONNECT_RETRY_MS                  100
+
+  /*
+   * Big endian message writer
+   */
+  struct writer_t {
+    std::vector<uint8_t> bytes;
+
+    void ubyte(uint8_t v) { this->bytes.push_back(v); }
+    void integer(int32_t v) {
+      for (int shift=24; shift>=0; shift-=8) {
+        this->bytes.push_back((uint8_t) (((uint32_t) v) >> shift));
+      }
+    }
+    void real(double v) {
+      uint64_t bits;
+      memcpy(&bits, &v, sizeof(bits));
+      for (int shift=56; shift>=0; shift-=8) {
+        this->bytes.push_back((uint8_t) (bits >> shift));
+      }
+    }
+    void string(const std::string& v) {
+      this->integer((int32_t) v.size());
+      this->bytes.insert(this->bytes.end(), v.begin(), v.end());
+    }
+
+    /**
+     * Frame a command (short or extended length)
+     * @param commands the message to append to
+     * @param id       the command id
+     */
+    void frame(std::vector<uint8_t>& commands, uint8_t id) const {
+      size_t length = this->bytes.size() + 2;
+      if (length <= 255) {
+        commands.push_back((uint8_t) length);
+      } else {
+        writer_t extended;
+        extended.ubyte(0);
+        extended.integer((int32_t) (length + 4));
+        commands.insert(commands.end(), extended.bytes.begin(), extended.bytes.end());
+      }
+      commands.push_back(id);
+      commands.insert(commands.end(), this->bytes.begin(), this->bytes.end());
+    }
+  };
+
+  /*
+   * Big endian message reader (throws past the end)
+   */
+  struct reader_t {
+    const std::vector<uint8_t>& bytes;
+    size_t pos = 0;
+
+    reader_t(const std::vector<uint8_t>& bytes) : bytes(bytes) {}
+
+    bool done() const { return this->pos >= this->bytes.size(); }
+    void need(size_t n) const {
+      if (this->pos + n > this->bytes.size()) {
+        std::cerr << "ERR: truncated traci message" << std::endl;
+        throw std::exception();
+      }
+    }
+    uint8_t ubyte() { need(1); return this->bytes[this->pos++]; }
+    int32_t integer() {
+      need(4);
+      uint32_t v = 0;
+      for (int i=0; i<4; i++) {
+        v = (v << 8) | this->bytes[this->pos++];
+      }
+      return (int32_t) v;
+    }
+    double real() {
+      need(8);
+      uint64_t bits = 0;
+      for (int i=0; i<8; i++) {
+        bits = (bits << 8) | this->bytes[this->pos++];
+      }
+      double v;
+      memcpy(&v, &bits, sizeof(v));
+      return v;
+    }
+    std::string string() {
+      int32_t size = integer();
+      need(size);
+      std::string v(reinterpret_cast<const char*>(this->bytes.data() + this->pos), size);
+      this->pos += size;
+      return v;
+    }
+
+    /**
+     * Read a command header
+     * @param  end the position after the command
+     * @return     the command id
+     */
+    uint8_t command(size_t& end) {
+      size_t start = this->pos;
+      size_t length = ubyte();
+      if (length == 0) {
+        length = (size_t) integer();
+      }
+      end = start + length;
+      return ubyte();
+    }
+
+    /**
+     * Read a status response
+     * @param  expected the command it answers
+     * @return          whether the command succeeded
+     */
+    bool status(uint8_t expected) {
+      size_t end;
+      uint8_t id = command(end);
+      uint8_t result = ubyte();
+      std::string description = string();
+      this->pos = end;
+
+      if ((id != expected) || (result != RTYPE_OK)) {
+        std::cerr << "ERR: traci command 0x" << std::hex << (int) expected << std::dec
+                  << " failed: " << description << std::endl;
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * Skip a typed value
+     * @param type the value type
+     */
+    void skip(uint8_t type) {
+      switch (type) {
+        case TYPE_UBYTE: case TYPE_BYTE: need(1); this->pos += 1; break;
+        case TYPE_INTEGER: case TYPE_COLOR: need(4); this->pos += 4; break;
+        case TYPE_DOUBLE: need(8); this->pos += 8; break;
+        case POSITION_2D: need(16); this->pos += 16; break;
+        case POSITION_3D: need(24); this->pos += 24; break;
+        case TYPE_STRING: string(); break;
+        case TYPE_STRINGLIST: for (int32_t n = integer(); n > 0; n--) { string(); } break;
+        case TYPE_DOUBLELIST: { int32_t n = integer(); need(8 * (size_t) n); this->pos += 8 * (size_t) n; break; }
+        case TYPE_COMPOUND: for (int32_t n = integer(); n > 0; n--) { skip(ubyte()); } break;
+        default:
+          std::cerr << "ERR: unsupported traci type 0x" << std::hex << (int) type << std::dec << std::endl;
+          throw std::exception();
+      }
+    }
+  };
+
+  /**
+   * Read a variable subscription response into the step
+   * @param reader the reader (at the response)
+   * @param step   the step
+   */
+  void read_subscription(reader_t& reader, step_t& step) {
+    size_t end;
+    uint8_t id = reader.command(end);
+    std::string object_id = reader.string();
+    uint8_t count = reader.ubyte();
+
+    vehicle_state_t *vehicle = nullptr;
+    if (id == RESPONSE_SUBSCRIBE_VEHICLE) {
+      step.vehicles.emplace_back();
+      vehicle = &step.vehicles.back();
+      vehicle->id = object_id;
+    }
+
+    for (uint8_t i=0; i<count; i++) {
+      uint8_t var = reader.ubyte();
+      uint8_t status = reader.ubyte();
+      uint8_t type = reader.ubyte();
+
+      if (status != RTYPE_OK) {
+        reader.skip(type);
+      } else if ((id == RESPONSE_SUBSCRIBE_SIM) && (var == VAR_TIME) && (type == TYPE_DOUBLE)) {
+        step.time = reader.real();
+      } else if ((id == RESPONSE_SUBSCRIBE_SIM) && (var == VAR_MIN_EXPECTED_VEHICLES) && (type == TYPE_INTEGER)) {
+        step.min_expected = reader.integer();
+      } else if ((id == RESPONSE_SUBSCRIBE_SIM) && (var == VAR_DEPARTED_VEHICLES_IDS) && (type == TYPE_STRINGLIST)) {
+        for (int32_t n = reader.integer(); n > 0; n--) {
+          step.departed.push_back(reader.string());
+        }
+      } else if (vehicle && (var == VAR_LANE_ID) && (type == TYPE_STRING)) {
+        vehicle->lane = reader.string();
+      } else if (vehicle && (var == VAR_POSITION) && (type == POSITION_2D)) {
+        vehicle->x = reader.real();
+        vehicle->y = reader.real();
+      } else if (vehicle && (var == VAR_SPEED) && (type == TYPE_DOUBLE)) {
+        vehicle->speed = reader.real();
+      } else if (vehicle && (var == VAR_LANEPOSITION) && (type == TYPE_DOUBLE)) {
+        vehicle->lane_pos = reader.real();
+      } else {
+        reader.skip(type);
+      }
+    }
+    reader.pos = end;
+  }
+
+  /**
+   * Constructor
+   */
+  traci_client_t::traci_client_t() : fd(-1) {}
+
+  /**
+   * Destructor: close the connection
+   */
+  traci_client_t::~traci_client_t() {
+    if (this->fd >= 0) {
+      ::close(this->fd);
+    }
+  }
+
+  /**
+   * Send a message (commands are already framed)
+   * @param  commands the commands
+   * @return          success or failure
+   */
+  bool traci_client_t::send_message(const std::vector<uint8_t>& commands) {
+    writer_t message;
+    message.integer((int32_t) (commands.size() + 4));
+    message.bytes.insert(message.bytes.end(), commands.begin(), commands.end());
+
+    size_t sent = 0;
+    while (sent < message.bytes.size()) {
+      ssize_t n = send(this->fd, message.bytes.data() + sent, message.bytes.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        std::cerr << "ERR: traci connection lost" << std::endl;
+        return false;
+      }
+      sent += n;
+    }
+    return true;
+  }
+
+  /**
+   * Receive a message
+   * @param  message the message (without the length)
+   * @return         1 if received, 0 if the server closed the connection, -1 on error
+   */
+  int traci_client_t::receive_message(std::vector<uint8_t>& message) {
+    uint8_t header[4];
+    size_t got = 0;
+    while (got < sizeof(header)) {
+      ssize_t n = recv(this->fd, header + got, sizeof(header) - got, 0);
+      if (n <= 0) {
+        //closed between messages: the simulation ended
+        return ((n == 0) && (got == 0)) ? 0 : -1;
+      }
+      got += n;
+    }
+
+    uint32_t length = ((uint32_t) header[0] << 24) | ((uint32_t) header[1] << 16) |
+                      ((uint32_t) header[2] << 8) | (uint32_t) header[3];
+    if (length < sizeof(header)) {
+      return -1;
+    }
+
+    message.resize(length - sizeof(header));
+    got = 0;
+    while (got < message.size()) {
+      ssize_t n = recv(this->fd, message.data() + got, message.size() - got, 0);
+      if (n <= 0) {
+        return -1;
+      }
+      got += n;
+    }
+    return 1;
+  }
+
+  /**
+   * Connect to a simulation (retried while it starts up)
+   * @param  host       the host
+   * @param  port       the port
+   * @param  timeout_ms how long to retry
+   * @return            success or failure
+   */
+  bool traci_client_t::connect(const std::string& host, int port, int timeout_ms) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *addrs = NULL;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addrs) != 0) {
+      std::cerr << "ERR: unable to resolve traci host: " << host << std::endl;
+      return false;
+    }
+
+    for (int waited_ms = 0; waited_ms <= timeout_ms; waited_ms += CONNECT_RETRY_MS) {
+      for (struct addrinfo *addr = addrs; addr; addr = addr->ai_next) {
+        this->fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (this->fd < 0) {
+          continue;
+        }
+        if (::connect(this->fd, addr->ai_addr, addr->ai_addrlen) == 0) {
+          //commands are small request/response pairs
+          int flag = 1;
+          setsockopt(this->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+          freeaddrinfo(addrs);
+          return true;
+        }
+        ::close(this->fd);
+        this->fd = -1;
+      }
+      usleep(CONNECT_RETRY_MS * 1000);
+    }
+
+    freeaddrinfo(addrs);
+    std::cerr << "ERR: unable to connect to traci server: " << host << ":" << port << std::endl;
+    return false;
+  }
+
+  /**
+   * Get the api version of the server
+   * @param  api_version the api version
+   * @param  identifier  the server identifier
+   * @return             success or failure
+   */
+  bool traci_client_t::get_version(int& api_version, std::string& identifier) {
+    std::vector<uint8_t> commands;
+    writer_t().frame(commands, CMD_GETVERSION);
+
+    std::vector<uint8_t> message;
+    if (!send_message(commands) || (receive_message(message) != 1)) {
+      return false;
+    }
+
+    try {
+      reader_t reader(message);
+      if (!reader.status(CMD_GETVERSION)) {
+        return false;
+      }
+      size_t end;
+      reader.command(end);
+      api_version = reader.integer();
+      identifier = reader.string();
+      return true;
+
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+
+  /**
+   * Subscribe to the simulation time, departed vehicles and expected vehicles
+   * @return success or failure
+   */
+  bool traci_client_t::subscribe_simulation() {
+    writer_t command;
+    command.real(INVALID_DOUBLE_VALUE);
+    command.real(INVALID_DOUBLE_VALUE);
+    command.string("");
+    command.ubyte(3);
+    command.ubyte(VAR_TIME);
+    command.ubyte(VAR_DEPARTED_VEHICLES_IDS);
+    command.ubyte(VAR_MIN_EXPECTED_VEHICLES);
+
+    std::vector<uint8_t> commands;
+    command.frame(commands, CMD_SUBSCRIBE_SIM_VARIABLE);
+
+    std::vector<uint8_t> message;
+    if (!send_message(commands) || (receive_message(message) != 1)) {
+      return false;
+    }
+
+    try {
+      //the initial values are not needed
+      reader_t reader(message);
+      return reader.status(CMD_SUBSCRIBE_SIM_VARIABLE);
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+
+  /**
+   * Subscribe to the lane, position, speed and lane position of vehicles
+   * @param  ids  the vehicle ids
+   * @param  step the current values are added to the step's vehicles
+   * @return      success or failure
+   */
+  bool traci_client_t::subscribe_vehicles(const std::vector<std::string>& ids, step_t& step) {
+    if (ids.empty()) {
+      return true;
+    }
+
+    //one message for all new vehicles
+    std::vector<uint8_t> commands;
+    for (const std::string& id : ids) {
+      writer_t command;
+      command.real(INVALID_DOUBLE_VALUE);
+      command.real(INVALID_DOUBLE_VALUE);
+      command.string(id);
+      command.ubyte(4);
+      command.ubyte(VAR_LANE_ID);
+      command.ubyte(VAR_POSITION);
+      command.ubyte(VAR_SPEED);
+      command.ubyte(VAR_LANEPOSITION);
+      command.frame(commands, CMD_SUBSCRIBE_VEHICLE_VARIABLE);
+    }
+
+    std::vector<uint8_t> message;
+    if (!send_message(commands) || (receive_message(message) != 1)) {
+      return false;
+    }
+
+    try {
+      reader_t reader(message);
+      for (size_t i=0; i<ids.size(); i++) {
+        if (!reader.status(CMD_SUBSCRIBE_VEHICLE_VARIABLE)) {
+          return false;
+        }
+        read_subscription(reader, step);
+      }
+      return true;
+
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+
+  /**
+   * Advance the simulation by one step
+   * @param  step the subscription results
+   * @return      1 if stepped, 0 if the server closed the connection, -1 on error
+   */
+  int traci_client_t::step(step_t& step) {
+    writer_t command;
+    //target time 0: a single step
+    command.real(0.0);
+
+    std::vector<uint8_t> commands;
+    command.frame(commands, CMD_SIMSTEP);
+
+    if (!send_message(commands)) {
+      return -1;
+    }
+
+    std::vector<uint8_t> message;
+    int received = receive_message(message);
+    if (received != 1) {
+      return received;
+    }
+
+    step.departed.clear();
+    step.vehicles.clear();
+
+    try {
+      reader_t reader(message);
+      if (!reader.status(CMD_SIMSTEP)) {
+        return -1;
+      }
+
+      for (int32_t n = reader.integer(); n > 0; n--) {
+        read_subscription(reader, step);
+      }
+      return 1;
+
+    } catch (const std::exception&) {
+      return -1;
+    }
+  }
+
+  /**
+   * End the simulation and close the connection
+   */
+  void traci_client_t::close() {
+    if (this->fd < 0) {
+      return;
+    }
+
+    std::vector<uint8_t> commands;
+    writer_t().frame(commands, CMD_CLOSE);
+
+    std::vector<uint8_t> message;
+    if (send_message(commands)) {
+      //acknowledged before the server exits
+      receive_message(message);
+    }
+    ::close(this->fd);
+    this->fd = -1;
+  }
+}
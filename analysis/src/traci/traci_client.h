@@ -0,0 +1,122 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _TRACI_CLIENT_H
+#define _TRACI_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace traci {
+  /*
+   * The subscribed state of a vehicle after a simulation step
+   */
+  struct vehicle_state_t {
+    std::string id;
+    std::string lane;
+    double x = 0.0;
+    double y = 0.0;
+    double speed = 0.0;
+    //position along the lane
+    double lane_pos = 0.0;
+  };
+
+  /*
+   * The subscription results of a simulation step
+   */
+  struct step_t {
+    //simulation time (s)
+    double time = 0.0;
+    //vehicles that are running or waiting to depart
+    int min_expected = 0;
+    //vehicles that departed in this step (not yet subscribed)
+    std::vector<std::string> departed;
+    std::vector<vehicle_state_t> vehicles;
+  };
+
+  /*
+   * Minimal TraCI client: steps a running simulation and receives vehicle lanes,
+   * positions and speeds through variable subscriptions
+   * @see https://sumo.dlr.de/docs/TraCI/Protocol.html
+   */
+  struct traci_client_t {
+  private:
+    int fd;
+
+    /**
+     * Send a message (commands are already framed)
+     * @param  commands the commands
+     * @return          success or failure
+     */
+    bool send_message(const std::vector<uint8_t>& commands);
+
+    /**
+     * Receive a message
+     * @param  message the message (without the length)
+     * @return         1 if received, 0 if the server closed the connection, -1 on error
+     */
+    int receive_message(std::vector<uint8_t>& message);
+
+  public:
+    /**
+     * Constructor
+     */
+    traci_client_t();
+
+    /**
+     * Destructor: close the connection
+     */
+    ~traci_client_t();
+
+    //no copy
+    traci_client_t(const traci_client_t&) = delete;
+    traci_client_t& operator=(const traci_client_t&) = delete;
+
+    /**
+     * Connect to a simulation (retried while it starts up)
+     * @param  host       the host
+     * @param  port       the port
+     * @param  timeout_ms how long to retry
+     * @return            success or failure
+     */
+    [[nodiscard]] bool connect(const std::string& host, int port, int timeout_ms);
+
+    /**
+     * Get the api version of the server
+     * @param  api_version the api version
+     * @param  identifier  the server identifier
+     * @return             success or failure
+     */
+    [[nodiscard]] bool get_version(int& api_version, std::string& identifier);
+
+    /**
+     * Subscribe to the simulation time, departed vehicles and expected vehicles
+     * @return success or failure
+     */
+    [[nodiscard]] bool subscribe_simulation();
+
+    /**
+     * Subscribe to the lane, position, speed and lane position of vehicles
+     * @param  ids  the vehicle ids
+     * @param  step the current values are added to the step's vehicles
+     * @return      success or failure
+     */
+    [[nodiscard]] bool subscribe_vehicles(const std::vector<std::string>& ids, step_t& step);
+
+    /**
+     * Advance the simulation by one step
+     * @param  step the subscription results
+     * @return      1 if stepped, 0 if the server closed the connection, -1 on error
+     */
+    int step(step_t& step);
+
+    /**
+     * End the simulation and close the connection
+     */
+    void close();
+  };
+}
+
+#endif /*_TRACI_CLIENT_H*/
@@ -0,0 +1,70 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <memory_resource>
+#include <string>
+#include <set>
+#include <new>
+#include <utility>
+
+namespace types {
+
+  //set of ids (ordered: indices into these sets are used in the outputs)
+  typedef std::pmr::set<std::pmr::string> id_set_t;
+
+  /*
+   * Monotonic arena for data that is built up during a phase and freed all at once:
+   * allocation is a pointer bump and teardown is a single release
+   */
+  struct arena_t {
+  private:
+    //initial block size (later blocks grow geometrically)
+    static constexpr size_t INITIAL_BLOCK = 1 << 16;
+
+    std::pmr::monotonic_buffer_resource resource;
+
+  public:
+    /**
+     * Constructor
+     */
+    arena_t() : resource(INITIAL_BLOCK) {}
+
+    //no copy
+    arena_t(const arena_t&) = delete;
+    arena_t& operator=(const arena_t&) = delete;
+
+    /**
+     * Get the memory resource for containers in this arena
+     * @return the resource
+     */
+    std::pmr::memory_resource *get() {
+      return &this->resource;
+    }
+
+    /**
+     * Construct an allocator aware object in the arena. The object is never
+     * destroyed: everything it allocates must also come from the arena
+     * (pmr types propagate the arena to their elements), and it is freed by release()
+     * @param  args constructor arguments (the arena allocator is appended)
+     * @return      the object (valid until release)
+     */
+    template<typename T, typename... Args>
+    T& make(Args&&... args) {
+      void *mem = this->resource.allocate(sizeof(T), alignof(T));
+      return *new (mem) T(std::forward<Args>(args)..., typename T::allocator_type(&this->resource));
+    }
+
+    /**
+     * Free everything in the arena at once (invalidates all objects made in it)
+     */
+    void release() {
+      this->resource.release();
+    }
+  };
+}
+
+#endif /*_ARENA_H*/
@@ -0,0 +1,82 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "contact_interval.h"
+#include <algorithm>
+
+namespace types {
+  /**
+   * Constructor (single recognition)
+   * @param timestep   the timestep
+   * @param dist       the distance
+   * @param curve_step the curve sample step (0 for no curve)
+   * @param alloc      the allocator for the curve
+   */
+  contact_interval_t::contact_interval_t(int timestep, float dist, int curve_step,
+                                         const std::pmr::polymorphic_allocator<float>& alloc)
+    : start(timestep),
+      end(timestep),
+      min_dist(dist),
+      max_dist(dist),
+      sum_dist(dist),
+      last_dist(dist),
+      curve(alloc) {
+    if (curve_step > 0) {
+      this->curve.push_back(dist);
+    }
+  }
+
+  /**
+   * Extend the interval by a recognition at the next timestep
+   * @param  timestep   the timestep
+   * @param  dist       the distance
+   * @param  curve_step the curve sample step (0 for no curve)
+   * @return            whether the recognition extends this interval
+   */
+  bool contact_interval_t::extend(int timestep, float dist, int curve_step) {
+    if (timestep != this->end + 1) {
+      return false;
+    }
+
+    this->end = timestep;
+    this->min_dist = std::min(this->min_dist, dist);
+    this->max_dist = std::max(this->max_dist, dist);
+    this->sum_dist += dist;
+    this->last_dist = dist;
+
+    if ((curve_step > 0) && ((timestep - this->start) % curve_step == 0)) {
+      this->curve.push_back(dist);
+    }
+    return true;
+  }
+
+  /**
+   * Get the distance at a timestep in the interval: exact with a curve step of 1,
+   * interpolated from the curve otherwise (the mean without a curve)
+   * @param  timestep   the timestep
+   * @param  curve_step the curve sample step
+   * @return            the distance (-1 if not in the interval)
+   */
+  double contact_interval_t::distance_at(int timestep, int curve_step) const {
+    if ((timestep < this->start) || (timestep > this->end)) {
+      return -1;
+    }
+
+    if ((curve_step <= 0) || this->curve.empty()) {
+      return this->mean_dist();
+    }
+
+    //the sample at or before the timestep
+    size_t j = (timestep - this->start) / curve_step;
+    int t0 = this->start + (int) j * curve_step;
+    if (timestep == t0) {
+      return this->curve[j];
+    }
+
+    //interpolate to the next sample (or the last distance)
+    int t1 = (j + 1 < this->curve.size()) ? t0 + curve_step : this->end;
+    double d1 = (j + 1 < this->curve.size()) ? this->curve[j + 1] : this->last_dist;
+    return this->curve[j] + (d1 - this->curve[j]) * (timestep - t0) / (double) (t1 - t0);
+  }
+}
@@ -0,0 +1,66 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _CONTACT_INTERVAL_H
+#define _CONTACT_INTERVAL_H
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace types {
+  /*
+   * A contiguous run of timesteps in which a tower recognizes a vehicle
+   */
+  struct contact_interval_t {
+    //first and last timestep (inclusive)
+    int start;
+    int end;
+    //distance statistics
+    float min_dist;
+    float max_dist;
+    double sum_dist;
+    //the distance at the last timestep
+    float last_dist;
+    //distances sampled every curve step timesteps from start (empty without a curve)
+    std::pmr::vector<float> curve;
+
+    /**
+     * Constructor (single recognition)
+     * @param timestep   the timestep
+     * @param dist       the distance
+     * @param curve_step the curve sample step (0 for no curve)
+     * @param alloc      the allocator for the curve
+     */
+    contact_interval_t(int timestep, float dist, int curve_step,
+                       const std::pmr::polymorphic_allocator<float>& alloc = {});
+
+    /**
+     * Extend the interval by a recognition at the next timestep
+     * @param  timestep   the timestep
+     * @param  dist       the distance
+     * @param  curve_step the curve sample step (0 for no curve)
+     * @return            whether the recognition extends this interval
+     */
+    bool extend(int timestep, float dist, int curve_step);
+
+    /**
+     * @return the mean distance
+     */
+    double mean_dist() const {
+      return this->sum_dist / (this->end - this->start + 1);
+    }
+
+    /**
+     * Get the distance at a timestep in the interval: exact with a curve step of 1,
+     * interpolated from the curve otherwise (the mean without a curve)
+     * @param  timestep   the timestep
+     * @param  curve_step the curve sample step
+     * @return            the distance (-1 if not in the interval)
+     */
+    double distance_at(int timestep, int curve_step) const;
+  };
+}
+
+#endif /*_CONTACT_INTERVAL_H*/
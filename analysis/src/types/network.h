@@ -0,0 +1,82 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _NETWORK_H
+#define _NETWORK_H
+
+#include <memory_resource>
+#include <string_view>
+#include "arena.h"
+#include "road_edge.h"
+
+namespace types {
+  /*
+   * The parsed road network (read only once loaded, so it can be shared between runs)
+   */
+  struct network_t {
+  public:
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+    //all segment (lane, or edge if grouped) ids in the network
+    id_set_t edges;
+    //the shapes of all lanes
+    road_edge_map_t edge_shapes;
+    //the shapes of internal (junction) lanes, if loaded
+    road_edge_map_t internal_shapes;
+    //whether segments are whole edges (lanes grouped by edge) instead of lanes
+    bool edge_segments = false;
+    //the shapes of whole edges (the center line of their lanes), if grouped
+    road_edge_map_t edge_segment_shapes;
+
+    /**
+     * Constructor
+     * @param alloc the allocator for network storage
+     */
+    network_t(const allocator_type& alloc = {})
+      : edges(alloc), edge_shapes(alloc), internal_shapes(alloc), edge_segment_shapes(alloc) {}
+
+    //no copy
+    network_t(const network_t&) = delete;
+    network_t& operator=(const network_t&) = delete;
+
+    /**
+     * Get the shapes of the segments
+     * @return the segment shapes (by segment id)
+     */
+    const road_edge_map_t& segment_shapes() const {
+      return this->edge_segments ? this->edge_segment_shapes : this->edge_shapes;
+    }
+  };
+
+  /**
+   * Get the edge of a lane (sumo lane ids are "<edge id>_<lane index>")
+   * @param  lane_id the lane id
+   * @return         the edge id (the lane id if it has no index)
+   */
+  inline std::string_view lane_edge_id(std::string_view lane_id) {
+    size_t split = lane_id.rfind('_');
+    if ((split == std::string_view::npos) || (split + 1 == lane_id.size()) ||
+        (lane_id.find_first_not_of("0123456789", split + 1) != std::string_view::npos)) {
+      return lane_id;
+    }
+    return lane_id.substr(0, split);
+  }
+
+  /**
+   * Get the index of a lane in its edge (sumo lane ids are "<edge id>_<lane index>")
+   * @param  lane_id the lane id
+   * @return         the lane index (0 if the lane id has no index)
+   */
+  inline int lane_index(std::string_view lane_id) {
+    int index = 0;
+    for (char c : lane_id.substr(lane_edge_id(lane_id).size())) {
+      if (c != '_') {
+        index = index * 10 + (c - '0');
+      }
+    }
+    return index;
+  }
+}
+
+#endif /*_NETWORK_H*/
@@ -5,13 +5,14 @@
 #include "road_edge.h"
 #include <cmath>
 #include <limits>
+#include <algorithm>
 
 namespace types {
   /**
    * Constructor
-   * @param edge_id the id of the edge
+   * @param alloc the allocator for edge storage
    */
-  road_edge_t::road_edge_t() : vertices() {}
+  road_edge_t::road_edge_t(const allocator_type& alloc) : vertices(alloc), cumulative(alloc), length(-1) {}
 
   /**
    * Add a vertex for this edge
@@ -19,7 +20,73 @@ namespace types {
    * @param y vertex position y
    */
   void road_edge_t::add_vertex(double x, double y) {
+    double prev = 0;
+    if (!this->vertices.empty()) {
+      prev = this->cumulative.back() + sqrt(pow(x - this->vertices.back().first, 2) +
+                                            pow(y - this->vertices.back().second, 2));
+    }
     this->vertices.emplace_back(std::make_pair(x,y));
+    this->cumulative.push_back(prev);
+  }
+
+  /**
+   * Set the lane length (sumo lane positions are relative to this, not the shape length)
+   * @param length the length
+   */
+  void road_edge_t::set_length(double length) {
+    this->length = length;
+  }
+
+  /**
+   * Get the vertices of the edge
+   * @return the vertices
+   */
+  const std::pmr::vector<std::pair<double,double>>& road_edge_t::get_vertices() const {
+    return this->vertices;
+  }
+
+  /**
+   * Get the lane length
+   * @return the length (-1 if not set)
+   */
+  double road_edge_t::get_length() const {
+    return this->length;
+  }
+
+  /**
+   * Get the cartesian position of a lane position (sumo pos attribute)
+   * @param  pos the position along the lane
+   * @param  x   position x
+   * @param  y   position y
+   * @return     whether the edge has a shape
+   */
+  bool road_edge_t::position_at(double pos, double& x, double& y) const {
+    if (this->vertices.empty()) {
+      return false;
+    }
+
+    if (this->vertices.size() == 1) {
+      x = this->vertices.front().first;
+      y = this->vertices.front().second;
+      return true;
+    }
+
+    //scale the lane position onto the shape
+    double shape_length = this->cumulative.back();
+    double target = ((this->length > 0) && (shape_length > 0)) ? pos * (shape_length / this->length) : pos;
+
+    //find the segment containing the target (clamped to the first/last segment)
+    size_t i = std::upper_bound(this->cumulative.begin(), this->cumulative.end(), target) - this->cumulative.begin();
+    i = std::min(std::max(i, (size_t) 1), this->vertices.size() - 1);
+
+    double x0 = this->vertices[i - 1].first;
+    double y0 = this->vertices[i - 1].second;
+    double seg = this->cumulative[i] - this->cumulative[i - 1];
+    double t = (seg > 0) ? std::fmin(std::fmax((target - this->cumulative[i - 1]) / seg, 0.0), 1.0) : 0;
+
+    x = x0 + t * (this->vertices[i].first - x0);
+    y = y0 + t * (this->vertices[i].second - y0);
+    return true;
   }
 
   /**
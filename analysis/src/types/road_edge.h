@@ -9,21 +9,31 @@
 #include <memory>
 #include <vector>
 #include <utility>
+#include <memory_resource>
+#include <unordered_map>
 
 namespace types {
   /*
    * Defines some discrete edge of the road network made up of various vertices
    */
   struct road_edge_t {
+  public:
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
   private:
     //the vertices of the edge (defines edge shape)
-    std::vector<std::pair<double,double>> vertices;
+    std::pmr::vector<std::pair<double,double>> vertices;
+    //the shape length up to each vertex (binary searched for positions)
+    std::pmr::vector<double> cumulative;
+    //the lane length in sumo position units (-1 if not set: use the shape length)
+    double length;
 
   public:
     /**
      * Constructor
+     * @param alloc the allocator for edge storage
      */
-    road_edge_t();
+    road_edge_t(const allocator_type& alloc = {});
 
     //no copy
     road_edge_t(const road_edge_t&) = delete;
@@ -36,6 +46,33 @@ namespace types {
      */
     void add_vertex(double x, double y);
 
+    /**
+     * Set the lane length (sumo lane positions are relative to this, not the shape length)
+     * @param length the length
+     */
+    void set_length(double length);
+
+    /**
+     * Get the vertices of the edge
+     * @return the vertices
+     */
+    const std::pmr::vector<std::pair<double,double>>& get_vertices() const;
+
+    /**
+     * Get the lane length
+     * @return the length (-1 if not set)
+     */
+    double get_length() const;
+
+    /**
+     * Get the cartesian position of a lane position (sumo pos attribute)
+     * @param  pos the position along the lane
+     * @param  x   position x
+     * @param  y   position y
+     * @return     whether the edge has a shape
+     */
+    bool position_at(double pos, double& x, double& y) const;
+
     /**
      * Get the distance from the edge to some point
      * @param  x      position x
@@ -44,6 +81,9 @@ namespace types {
      */
     double distance(double x, double y) const;
   };
+
+  //edges by lane id
+  typedef std::pmr::unordered_map<std::pmr::string,road_edge_t> road_edge_map_t;
 }
 
 #endif /*_ROAD_EDGE_H*/
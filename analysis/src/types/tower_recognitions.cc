@@ -3,20 +3,28 @@
  */
 
 #include "tower_recognitions.h"
+#include <iterator>
+#include <cstdlib>
 
 namespace types {
 
   /**
    * Constructor
    * @param tower_id the tower id
-   * @param x        the tower position x
-   * @param y        the tower position y
+   * @param alloc    the allocator for recognition storage
    */
-  tower_recognitions_t::tower_recognitions_t(const std::string& tower_id)
-    : tower_id(tower_id),
+  tower_recognitions_t::tower_recognitions_t(std::string_view tower_id, const allocator_type& alloc)
+    : tower_id(tower_id, alloc),
       x(0),
       y(0),
-      vehicles() {}
+      vehicles(alloc),
+      intervals(alloc),
+      use_intervals(false),
+      curve_step(0),
+      series(alloc),
+      use_compact(false),
+      dist_scale(1),
+      codec(codec::CODEC_VARINT) {}
 
 
   /**
@@ -30,25 +38,31 @@ namespace types {
   }
 
   /**
-   * Get the distance from a vehicle to the tower
-   * (-1 if out of range)
-   * @param  timestep   the timestep to check for
-   * @param  vehicle_id the id of the vehicle
-   * @return            the distance
+   * Store recognitions as contact intervals (call before adding recognitions)
+   * @param curve_step keep a distance every curve_step timesteps of each interval (0 for none)
    */
-  double tower_recognitions_t::distance(const std::string& timestep, const std::string& vehicle_id) const {
-    //look for the vehicle in the map
-    std::unordered_map<std::string,std::unordered_map<std::string,double>>::const_iterator it
-      = vehicles.find(timestep);
+  void tower_recognitions_t::set_intervals(int curve_step) {
+    this->use_intervals = true;
+    this->curve_step = curve_step;
+  }
 
-    if (it != vehicles.end()) {
-      //find the vehicle for this timestep
-      std::unordered_map<std::string,double>::const_iterator it2 = it->second.find(vehicle_id);
-      if (it2 != it->second.end()) {
-        return it2->second;
-      }
-    }
-    return -1;
+  /**
+   * Store recognitions as encoded timesteps and fixed point distances for each vehicle
+   * (call before adding recognitions)
+   * @param dist_scale fixed point distance units per meter (distances saturate at 65535 units)
+   * @param codec      the timestep codec
+   */
+  void tower_recognitions_t::set_compact(double dist_scale, codec::codec_t codec) {
+    this->use_compact = true;
+    this->dist_scale = dist_scale;
+    this->codec = codec;
+  }
+
+  /**
+   * Compare interval starts
+   */
+  inline bool starts_before(int timestep, const contact_interval_t& interval) {
+    return timestep < interval.start;
   }
 
   /**
@@ -57,9 +71,45 @@ namespace types {
    * @param vehicle_id the id of the vehicle
    * @param dist       the distance from the tower to the vehicle
    */
-  void tower_recognitions_t::add_recognition(std::string&& timestep, std::string&& vehicle_id, double dist) {
-    //add to lookup
-    vehicles[timestep][vehicle_id] = dist;
+  void tower_recognitions_t::add_recognition(const std::pmr::string& timestep, const std::pmr::string& vehicle_id, double dist) {
+    if (this->use_compact) {
+      recognition_series_t& vehicle = this->series.try_emplace(vehicle_id, this->codec).first->second;
+      int ts = atoi(timestep.c_str());
+      uint16_t fixed = codec::quantize(dist, this->dist_scale);
+
+      //a repeated timestep replaces the distance (as in the lookup)
+      if (vehicle.distances.size() && (vehicle.timesteps.back() == ts)) {
+        vehicle.distances.back() = fixed;
+      } else {
+        vehicle.timesteps.append(ts);
+        vehicle.distances.push_back(fixed);
+      }
+      return;
+    }
+
+    if (!this->use_intervals) {
+      //add to lookup
+      vehicles[timestep][vehicle_id] = dist;
+      return;
+    }
+
+    std::pmr::vector<contact_interval_t>& contacts = intervals.try_emplace(vehicle_id).first->second;
+    int ts = atoi(timestep.c_str());
+
+    //recognitions usually arrive in timestep order: extend or start an interval
+    if (contacts.empty() || (ts > contacts.back().end)) {
+      if (contacts.empty() || !contacts.back().extend(ts, dist, this->curve_step)) {
+        contacts.emplace_back(ts, dist, this->curve_step, contacts.get_allocator());
+      }
+      return;
+    }
+
+    //out of order: insert by start (already covered timesteps keep the first distance)
+    std::pmr::vector<contact_interval_t>::iterator it
+      = std::upper_bound(contacts.begin(), contacts.end(), ts, starts_before);
+    if ((it == contacts.begin()) || (std::prev(it)->end < ts)) {
+      contacts.emplace(it, ts, dist, this->curve_step, contacts.get_allocator());
+    }
   }
 
   /**
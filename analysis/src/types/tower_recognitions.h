@@ -6,32 +6,77 @@
 #define _TOWER_RECOGNITIONS_H
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 #include <tuple>
+#include <algorithm>
+#include <cstdlib>
 #include "road_edge.h"
+#include "contact_interval.h"
+#include "../codec/int_codec.h"
 
 namespace types {
+  /*
+   * The recognitions of a vehicle by a tower in compact storage: encoded
+   * timesteps (in arrival order) and fixed point distances
+   */
+  struct recognition_series_t {
+  public:
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+    codec::int_column_t timesteps;
+    std::pmr::vector<uint16_t> distances;
+
+    /**
+     * Constructor
+     * @param codec the timestep codec
+     * @param alloc the allocator for the columns
+     */
+    recognition_series_t(codec::codec_t codec, const allocator_type& alloc = {})
+      : timesteps(codec, alloc), distances(alloc) {}
+
+    //no copy
+    recognition_series_t(const recognition_series_t&) = delete;
+    recognition_series_t& operator=(const recognition_series_t&) = delete;
+  };
+
   /*
    * Defines all of the bluetooth recognitions for a given tower
    */
   struct tower_recognitions_t {
+  public:
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
   private:
     //the id of the tower
-    std::string tower_id;
+    std::pmr::string tower_id;
     //the tower position
     double x;
     double y;
     //vehicles this tower has seen for each given timestep (timestep remains a string)
-    std::unordered_map<std::string,std::unordered_map<std::string,double>> vehicles;
+    std::pmr::unordered_map<std::pmr::string,std::pmr::unordered_map<std::pmr::string,double>> vehicles;
+    //contact intervals for each vehicle (by start), used instead of vehicles when enabled
+    std::pmr::unordered_map<std::pmr::string,std::pmr::vector<contact_interval_t>> intervals;
+    bool use_intervals;
+    //interval curve sample step (0 for no curve)
+    int curve_step;
+    //compact recognitions for each vehicle, used instead of vehicles when enabled
+    std::pmr::unordered_map<std::pmr::string,recognition_series_t> series;
+    bool use_compact;
+    //fixed point distance units per meter
+    double dist_scale;
+    codec::codec_t codec;
 
   public:
     /**
      * Constructor
      * @param tower_id the tower id
+     * @param alloc    the allocator for recognition storage
      */
-    tower_recognitions_t(const std::string& tower_id);
+    tower_recognitions_t(std::string_view tower_id, const allocator_type& alloc = {});
 
     //no copy
     tower_recognitions_t(const tower_recognitions_t&) = delete;
@@ -45,13 +90,73 @@ namespace types {
     void set_position(double x, double y);
 
     /**
-     * Get the distance from a vehicle to the tower
-     * (-1 if out of range)
-     * @param  timestep   the timestep to check for
-     * @param  vehicle_id the id of the vehicle
-     * @return            the distance
+     * Store recognitions as contact intervals (call before adding recognitions)
+     * @param curve_step keep a distance every curve_step timesteps of each interval (0 for none)
+     */
+    void set_intervals(int curve_step);
+
+    /**
+     * Store recognitions as encoded timesteps and fixed point distances for each vehicle
+     * (call before adding recognitions)
+     * @param dist_scale fixed point distance units per meter (distances saturate at 65535 units)
+     * @param codec      the timestep codec
+     */
+    void set_compact(double dist_scale, codec::codec_t codec);
+
+    /**
+     * @return whether recognitions are stored as contact intervals
+     */
+    bool has_intervals() const {
+      return this->use_intervals;
+    }
+
+    /**
+     * @return the interval curve sample step
      */
-    double distance(const std::string& timestep, const std::string& vehicle_id) const;
+    int get_curve_step() const {
+      return this->curve_step;
+    }
+
+    /**
+     * @return contact intervals by vehicle id (if enabled)
+     */
+    const std::pmr::unordered_map<std::pmr::string,std::pmr::vector<contact_interval_t>>& contact_intervals() const {
+      return this->intervals;
+    }
+
+    /**
+     * Visit every recognition (expands contact intervals, distances as in contact_interval_t::distance_at,
+     * compact distances at their fixed point precision)
+     * @param fn called with (timestep, vehicle id, distance)
+     */
+    template<typename F>
+    void expand(F&& fn) const {
+      if (this->use_intervals) {
+        for (const auto& vehicle : this->intervals) {
+          for (const contact_interval_t& interval : vehicle.second) {
+            for (int ts=interval.start; ts<=interval.end; ts++) {
+              fn(ts, vehicle.first, interval.distance_at(ts, this->curve_step));
+            }
+          }
+        }
+      } else if (this->use_compact) {
+        std::vector<int32_t> timesteps;
+        for (const auto& vehicle : this->series) {
+          timesteps.resize(vehicle.second.timesteps.size());
+          vehicle.second.timesteps.decode(timesteps.data());
+          for (size_t i=0; i<timesteps.size(); i++) {
+            fn(timesteps[i], vehicle.first, codec::dequantize(vehicle.second.distances[i], this->dist_scale));
+          }
+        }
+      } else {
+        for (const auto& ts : this->vehicles) {
+          int timestep = atoi(ts.first.c_str());
+          for (const auto& vehicle : ts.second) {
+            fn(timestep, vehicle.first, vehicle.second);
+          }
+        }
+      }
+    }
 
     /**
      * Add a vehicle recognition for this twoer
@@ -59,7 +164,7 @@ namespace types {
      * @param vehicle_id the id of the vehicle
      * @param dist       the distance from the tower to the vehicle
      */
-    void add_recognition(std::string&& timestep, std::string&& vehicle_id, double dist);
+    void add_recognition(const std::pmr::string& timestep, const std::pmr::string& vehicle_id, double dist);
 
     /**
      * Get the distance from this tower to an edge
@@ -68,6 +173,9 @@ namespace types {
      */
     double edge_distance(const road_edge_t& edge) const;
   };
+
+  //tower recognitions by tower id
+  typedef std::pmr::unordered_map<std::pmr::string,tower_recognitions_t> tower_recognitions_map_t;
 }
 
 #endif /*_TOWER_RECOGNITIONS_H*/
@@ -8,17 +8,19 @@ namespace types {
 
   /**
    * Constructor
+   * @param alloc the allocator for history storage
    */
-  vehicle_lane_hist_t::vehicle_lane_hist_t()
-    : segments() {}
+  vehicle_lane_hist_t::vehicle_lane_hist_t(const allocator_type& alloc)
+    : segments(alloc) {}
 
   /**
    * Constructor with initial value pair
    * @param segment_id segment id
    * @param timestep   current timestep
+   * @param alloc      the allocator for history storage
    */
-  vehicle_lane_hist_t::vehicle_lane_hist_t(const std::string& segment_id, int timestep)
-    : segments() {
+  vehicle_lane_hist_t::vehicle_lane_hist_t(const std::pmr::string& segment_id, int timestep, const allocator_type& alloc)
+    : segments(alloc) {
     this->at_segment(segment_id, timestep);
   }
 
@@ -27,8 +29,9 @@ namespace types {
    * @param segment_id the segment the vehicle is currently on
    * @param timestep   the current simulation timestep
    */
-  void vehicle_lane_hist_t::at_segment(const std::string& segment_id, int timestep) {
-    this->segments.insert(std::make_pair(segment_id, timestep));
+  void vehicle_lane_hist_t::at_segment(const std::pmr::string& segment_id, int timestep) {
+    //only the first time on a segment is kept (try_emplace does not allocate if present)
+    this->segments.try_emplace(segment_id, timestep);
   }
 
   /**
@@ -37,8 +40,8 @@ namespace types {
    * @param  current_ts the current timestep
    * @return            the number of timesteps since being on that segment or -1 if never seen
    */
-  int vehicle_lane_hist_t::timesteps_since_seen(const std::string& segment_id, int current_ts) const {
-    std::unordered_map<std::string,int>::const_iterator it
+  int vehicle_lane_hist_t::timesteps_since_seen(const std::pmr::string& segment_id, int current_ts) const {
+    std::pmr::unordered_map<std::pmr::string,int>::const_iterator it
       = segments.find(segment_id);
 
     if (it != segments.end()) {
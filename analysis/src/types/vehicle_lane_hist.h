@@ -7,6 +7,7 @@
 
 #include <string>
 #include <memory>
+#include <memory_resource>
 #include <unordered_map>
 #include <utility>
 
@@ -15,22 +16,27 @@ namespace types {
    * Defines the history of lanes visited by a vehicle
    */
   struct vehicle_lane_hist_t {
+  public:
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
   private:
     //the segments the vehicle has visited and when
-    std::unordered_map<std::string,int> segments;
+    std::pmr::unordered_map<std::pmr::string,int> segments;
 
   public:
     /**
      * Constructor
+     * @param alloc the allocator for history storage
      */
-    vehicle_lane_hist_t();
+    vehicle_lane_hist_t(const allocator_type& alloc = {});
 
     /**
      * Constructor with initial value pair
      * @param segment_id segment id
      * @param timestep   current timestep
+     * @param alloc      the allocator for history storage
      */
-    vehicle_lane_hist_t(const std::string& segment_id, int timestep);
+    vehicle_lane_hist_t(const std::pmr::string& segment_id, int timestep, const allocator_type& alloc = {});
 
     //no copy
     vehicle_lane_hist_t(const vehicle_lane_hist_t&) = delete;
@@ -41,7 +47,7 @@ namespace types {
      * @param segment_id the segment the vehicle is currently on
      * @param timestep   the current simulation timestep
      */
-    void at_segment(const std::string& segment_id, int timestep);
+    void at_segment(const std::pmr::string& segment_id, int timestep);
 
     /**
      * Get the timesteps since a segment was last seen
@@ -49,8 +55,18 @@ namespace types {
      * @param  current_ts the current timestep
      * @return            the number of timesteps since being on that segment or -1 if never seen
      */
-    int timesteps_since_seen(const std::string& segment_id, int current_ts) const;
+    int timesteps_since_seen(const std::pmr::string& segment_id, int current_ts) const;
+
+    /**
+     * @return the first timestep on each segment by segment id
+     */
+    const std::pmr::unordered_map<std::pmr::string,int>& first_seen() const {
+      return this->segments;
+    }
   };
+
+  //vehicle histories by vehicle id
+  typedef std::pmr::unordered_map<std::pmr::string,vehicle_lane_hist_t> vehicle_lane_hist_map_t;
 }
 
 #endif /*_VEHICLE_LANE_HIST_H*/
@@ -0,0 +1,134 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "vehicle_trajectory.h"
+#include <cmath>
+#include <limits>
+
+namespace types {
+  /**
+   * Constructor
+   * @param alloc the allocator for table storage
+   */
+  trajectory_table_t::trajectory_table_t(const allocator_type& alloc)
+    : lane_ids(alloc), lane_index(alloc),
+      vehicle_ids(alloc), vehicle_index(alloc),
+      vehicle_col(alloc), ts_col(alloc), lane_col(alloc), pos_col(alloc), speed_col(alloc),
+      x_col(alloc), y_col(alloc), offsets(alloc) {}
+
+  /**
+   * Get the index for an id, adding it to the dictionary if new
+   * @param  id    the id
+   * @param  ids   the dictionary
+   * @param  index the dictionary lookup
+   * @return       the index
+   */
+  uint32_t trajectory_table_t::intern(const std::pmr::string& id,
+                                      std::pmr::vector<std::pmr::string>& ids,
+                                      std::pmr::unordered_map<std::pmr::string,uint32_t>& index) {
+    std::pair<std::pmr::unordered_map<std::pmr::string,uint32_t>::iterator,bool> inserted
+      = index.try_emplace(id, (uint32_t) ids.size());
+    if (inserted.second) {
+      ids.push_back(id);
+    }
+    return inserted.first->second;
+  }
+
+  /**
+   * Add a vehicle position
+   * @param vehicle_id the vehicle
+   * @param lane_id    the lane the vehicle is on
+   * @param timestep   the timestep
+   * @param pos        the position along the lane
+   * @param speed      the vehicle speed
+   */
+  void trajectory_table_t::add(const std::pmr::string& vehicle_id,
+                               const std::pmr::string& lane_id,
+                               int timestep, float pos, float speed) {
+    this->vehicle_col.push_back(intern(vehicle_id, this->vehicle_ids, this->vehicle_index));
+    this->lane_col.push_back(intern(lane_id, this->lane_ids, this->lane_index));
+    this->ts_col.push_back(timestep);
+    this->pos_col.push_back(pos);
+    this->speed_col.push_back(speed);
+  }
+
+  /**
+   * Permute a column into row order
+   * @param col   the column
+   * @param order the source row of each destination row
+   */
+  template<typename T>
+  void permute(std::pmr::vector<T>& col, const std::vector<uint64_t>& order) {
+    std::pmr::vector<T> sorted(col.get_allocator());
+    sorted.reserve(col.size());
+    for (uint64_t row : order) {
+      sorted.push_back(col[row]);
+    }
+    col.swap(sorted);
+  }
+
+  /**
+   * Group rows by vehicle (stable: rows stay in timestep order), call once all rows are added
+   */
+  void trajectory_table_t::finish() {
+    //counting sort by vehicle
+    this->offsets.assign(this->vehicle_ids.size() + 1, 0);
+    for (uint32_t v : this->vehicle_col) {
+      this->offsets[v + 1]++;
+    }
+    for (size_t i=1; i<this->offsets.size(); i++) {
+      this->offsets[i] += this->offsets[i - 1];
+    }
+
+    std::vector<uint64_t> next(this->offsets.begin(), this->offsets.end() - 1);
+    std::vector<uint64_t> order(this->vehicle_col.size());
+    for (uint64_t row=0; row<this->vehicle_col.size(); row++) {
+      order[next[this->vehicle_col[row]]++] = row;
+    }
+
+    permute(this->ts_col, order);
+    permute(this->lane_col, order);
+    permute(this->pos_col, order);
+    permute(this->speed_col, order);
+
+    //implied by the offsets
+    this->vehicle_col.clear();
+    this->vehicle_col.shrink_to_fit();
+  }
+
+  /**
+   * Project lane positions to x/y through the lane shapes (NaN for unknown lanes)
+   * @param edge_shapes     the shapes of all lanes
+   * @param internal_shapes the shapes of internal (junction) lanes
+   */
+  void trajectory_table_t::project(const road_edge_map_t& edge_shapes,
+                                   const road_edge_map_t& internal_shapes) {
+    //resolve each lane once
+    std::vector<const road_edge_t*> shapes;
+    shapes.reserve(this->lane_ids.size());
+    for (const std::pmr::string& lane_id : this->lane_ids) {
+      road_edge_map_t::const_iterator it = edge_shapes.find(lane_id);
+      if (it == edge_shapes.end()) {
+        it = internal_shapes.find(lane_id);
+        shapes.push_back((it == internal_shapes.end()) ? nullptr : &it->second);
+      } else {
+        shapes.push_back(&it->second);
+      }
+    }
+
+    this->x_col.resize(this->size());
+    this->y_col.resize(this->size());
+
+    for (size_t row=0; row<this->size(); row++) {
+      const road_edge_t *shape = shapes[this->lane_col[row]];
+      double x = std::numeric_limits<double>::quiet_NaN();
+      double y = std::numeric_limits<double>::quiet_NaN();
+      if (shape != nullptr) {
+        shape->position_at(this->pos_col[row], x, y);
+      }
+      this->x_col[row] = (float) x;
+      this->y_col[row] = (float) y;
+    }
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _VEHICLE_TRAJECTORY_H
+#define _VEHICLE_TRAJECTORY_H
+
+#include <string>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+#include "road_edge.h"
+
+namespace types {
+  /*
+   * Vehicle trajectories (timestep, lane, lane position, speed) stored as columns:
+   * rows are appended in netstate order then grouped by vehicle by finish(), so the
+   * rows of vehicle i are [offsets[i], offsets[i + 1]) in timestep order
+   */
+  struct trajectory_table_t {
+  public:
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+  private:
+    //lane dictionary
+    std::pmr::vector<std::pmr::string> lane_ids;
+    std::pmr::unordered_map<std::pmr::string,uint32_t> lane_index;
+    //vehicle dictionary
+    std::pmr::vector<std::pmr::string> vehicle_ids;
+    std::pmr::unordered_map<std::pmr::string,uint32_t> vehicle_index;
+
+    //row columns
+    std::pmr::vector<uint32_t> vehicle_col;
+    std::pmr::vector<int32_t> ts_col;
+    std::pmr::vector<uint32_t> lane_col;
+    std::pmr::vector<float> pos_col;
+    std::pmr::vector<float> speed_col;
+    //projected positions (set by project)
+    std::pmr::vector<float> x_col;
+    std::pmr::vector<float> y_col;
+
+    //row range of each vehicle (set by finish)
+    std::pmr::vector<uint64_t> offsets;
+
+    /**
+     * Get the index for an id, adding it to the dictionary if new
+     * @param  id    the id
+     * @param  ids   the dictionary
+     * @param  index the dictionary lookup
+     * @return       the index
+     */
+    static uint32_t intern(const std::pmr::string& id,
+                           std::pmr::vector<std::pmr::string>& ids,
+                           std::pmr::unordered_map<std::pmr::string,uint32_t>& index);
+
+  public:
+    /**
+     * Constructor
+     * @param alloc the allocator for table storage
+     */
+    trajectory_table_t(const allocator_type& alloc = {});
+
+    //no copy
+    trajectory_table_t(const trajectory_table_t&) = delete;
+    trajectory_table_t& operator=(const trajectory_table_t&) = delete;
+
+    /**
+     * Add a vehicle position
+     * @param vehicle_id the vehicle
+     * @param lane_id    the lane the vehicle is on
+     * @param timestep   the timestep
+     * @param pos        the position along the lane
+     * @param speed      the vehicle speed
+     */
+    void add(const std::pmr::string& vehicle_id,
+             const std::pmr::string& lane_id,
+             int timestep, float pos, float speed);
+
+    /**
+     * Group rows by vehicle (stable: rows stay in timestep order), call once all rows are added
+     */
+    void finish();
+
+    /**
+     * Project lane positions to x/y through the lane shapes (NaN for unknown lanes)
+     * @param edge_shapes     the shapes of all lanes
+     * @param internal_shapes the shapes of internal (junction) lanes
+     */
+    void project(const road_edge_map_t& edge_shapes,
+                 const road_edge_map_t& internal_shapes);
+
+    /**
+     * @return the number of rows
+     */
+    size_t size() const { return this->ts_col.size(); }
+
+    //dictionaries
+    const std::pmr::vector<std::pmr::string>& lanes() const { return this->lane_ids; }
+    const std::pmr::vector<std::pmr::string>& vehicles() const { return this->vehicle_ids; }
+
+    //columns (grouped by vehicle after finish)
+    const std::pmr::vector<uint64_t>& vehicle_offsets() const { return this->offsets; }
+    const std::pmr::vector<int32_t>& timesteps() const { return this->ts_col; }
+    const std::pmr::vector<uint32_t>& lane_indices() const { return this->lane_col; }
+    const std::pmr::vector<float>& positions() const { return this->pos_col; }
+    const std::pmr::vector<float>& speeds() const { return this->speed_col; }
+    const std::pmr::vector<float>& xs() const { return this->x_col; }
+    const std::pmr::vector<float>& ys() const { return this->y_col; }
+  };
+}
+
+#endif /*_VEHICLE_TRAJECTORY_H*/
@@ -0,0 +1,201 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "tower_positions.h"
+#include "../parse/xml_loader.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <unordered_map>
+#include <cstring>
+#include <exception>
+#include <algorithm>
+
+#define ADDITIONAL_NODE   "additional"
+#define PARKING_AREA_NODE "parkingArea"
+#define VEHICLE_NODE      "vehicle"
+#define STOP_NODE         "stop"
+#define ID_ATTR           "id"
+#define LANE_ATTR         "lane"
+#define END_POS_ATTR      "endPos"
+#define PARKING_AREA_ATTR "parkingArea"
+
+namespace what_if {
+
+  /*
+   * A lane position (parking area or stop)
+   */
+  struct lane_pos_t {
+    std::string lane;
+    double pos;
+  };
+
+  /**
+   * Read the lane and end position attributes of a node
+   * @param  node the node
+   * @param  out  the lane position
+   * @return      whether the lane was found
+   */
+  bool read_lane_pos(rapidxml::xml_node<> *node, lane_pos_t& out) {
+    bool found = false;
+    out.pos = 0;
+
+    for (rapidxml::xml_attribute<> *attr = node->first_attribute();
+         attr;
+         attr = attr->next_attribute()) {
+      if (strcmp(attr->name(), LANE_ATTR) == 0) {
+        out.lane = std::string(attr->value());
+        found = true;
+      } else if (strcmp(attr->name(), END_POS_ATTR) == 0) {
+        out.pos = atof(attr->value());
+      }
+    }
+    return found;
+  }
+
+  /**
+   * Get an attribute value
+   * @param  node the node
+   * @param  name the attribute name
+   * @return      the value or empty
+   */
+  std::string attr_value(rapidxml::xml_node<> *node, const char *name) {
+    rapidxml::xml_attribute<> *attr = node->first_attribute(name);
+    return attr ? std::string(attr->value()) : std::string();
+  }
+
+  /**
+   * Load towers from a sumo additional file
+   * @param  path        the path to the file
+   * @param  edge_shapes lane shapes
+   * @param  towers      the loaded towers
+   * @param  region      if set, lanes outside the region are not in edge_shapes
+   * @return             success or failure
+   */
+  bool load_additional(const std::string& path,
+                       const types::road_edge_map_t& edge_shapes,
+                       std::vector<tower_position_t>& towers,
+                       const filter::region_t *region) {
+    return parse::load_from_path(path, [&edge_shapes, &towers, region] (const rapidxml::xml_document<>& doc) {
+      if (strcmp(doc.first_node()->name(), ADDITIONAL_NODE) != 0) {
+        std::cerr << "ERR doc root node not: " << ADDITIONAL_NODE << std::endl;
+        throw std::exception();
+      }
+
+      std::unordered_map<std::string,lane_pos_t> parking_areas;
+
+      for (rapidxml::xml_node<> *node = doc.first_node(ADDITIONAL_NODE)->first_node();
+           node;
+           node = node->next_sibling()) {
+
+        if (strcmp(node->name(), PARKING_AREA_NODE) == 0) {
+          lane_pos_t lp;
+          if (read_lane_pos(node, lp)) {
+            parking_areas[attr_value(node, ID_ATTR)] = lp;
+          }
+
+        } else if (strcmp(node->name(), VEHICLE_NODE) == 0) {
+          rapidxml::xml_node<> *stop_node = node->first_node(STOP_NODE);
+          if (stop_node == NULL) {
+            continue;
+          }
+
+          //the stop is either at a parking area or directly on a lane
+          lane_pos_t lp;
+          std::string parking_area = attr_value(stop_node, PARKING_AREA_ATTR);
+          if (!parking_area.empty()) {
+            std::unordered_map<std::string,lane_pos_t>::const_iterator it = parking_areas.find(parking_area);
+            if (it == parking_areas.end()) {
+              std::cerr << "ERR unknown parking area " << parking_area << std::endl;
+              throw std::exception();
+            }
+            lp = it->second;
+          } else if (!read_lane_pos(stop_node, lp)) {
+            continue;
+          }
+
+          types::road_edge_map_t::const_iterator lane_it = edge_shapes.find(std::pmr::string(lp.lane));
+          tower_position_t tower = {attr_value(node, ID_ATTR), 0, 0};
+
+          if ((lane_it == edge_shapes.end()) && region) {
+            //on a lane outside the region of interest
+            continue;
+          } else if ((lane_it == edge_shapes.end()) || !lane_it->second.position_at(lp.pos, tower.x, tower.y)) {
+            std::cerr << "ERR tower " << tower.id << " is on unknown lane " << lp.lane << std::endl;
+            throw std::exception();
+          }
+          towers.push_back(tower);
+        }
+      }
+    });
+  }
+
+  /**
+   * Load towers from a text list
+   * @param  path   the path to the file
+   * @param  towers the loaded towers
+   * @return        success or failure
+   */
+  bool load_list(const std::string& path, std::vector<tower_position_t>& towers) {
+    std::ifstream in_file(path);
+    std::string line;
+    size_t line_no = 0;
+
+    while (std::getline(in_file, line)) {
+      line_no++;
+      line = line.substr(0, line.find('#'));
+      std::replace(line.begin(), line.end(), ',', ' ');
+
+      std::istringstream sstream(line);
+      tower_position_t tower;
+      if (!(sstream >> tower.id)) {
+        //blank
+        continue;
+      }
+
+      if (!(sstream >> tower.x >> tower.y)) {
+        std::cerr << "ERR: " << path << ":" << line_no << ": expected <id> <x> <y>" << std::endl;
+        return false;
+      }
+      towers.push_back(tower);
+    }
+    return true;
+  }
+
+  /**
+   * Load tower positions from either:
+   *  - a sumo additional file (like generation/tower_placer.py writes): towers are vehicles
+   *    stopped at parking areas, positioned at the parking area end position on its lane
+   *  - a text file with one "<id> <x> <y>" per line ('#' comments, commas allowed)
+   * @param  path        the path to the file
+   * @param  edge_shapes lane shapes (for parking area positions)
+   * @param  towers      the loaded towers
+   * @param  region      if set, towers outside the region are skipped
+   * @return             success or failure
+   */
+  bool load_tower_positions(const std::string& path,
+                            const types::road_edge_map_t& edge_shapes,
+                            std::vector<tower_position_t>& towers,
+                            const filter::region_t *region) {
+    //sniff the format
+    std::ifstream in_file(path);
+    char c = 0;
+    while (in_file.get(c) && isspace((unsigned char) c)) {}
+    in_file.close();
+
+    bool success = (c == '<') ? load_additional(path, edge_shapes, towers, region) : load_list(path, towers);
+
+    if (success && region) {
+      towers.erase(std::remove_if(towers.begin(), towers.end(), [region] (const tower_position_t& tower) {
+        return !region->contains(tower.x, tower.y);
+      }), towers.end());
+    }
+
+    if (success && towers.empty()) {
+      std::cerr << "ERR: no towers in " << path << (region ? " (in the region of interest)" : "") << std::endl;
+      return false;
+    }
+    return success;
+  }
+}
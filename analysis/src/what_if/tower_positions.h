@@ -0,0 +1,40 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _TOWER_POSITIONS_H
+#define _TOWER_POSITIONS_H
+
+#include <string>
+#include <vector>
+#include "../types/road_edge.h"
+#include "../filter/region.h"
+
+namespace what_if {
+  /*
+   * A hypothetical tower placement
+   */
+  struct tower_position_t {
+    std::string id;
+    double x;
+    double y;
+  };
+
+  /**
+   * Load tower positions from either:
+   *  - a sumo additional file (like generation/tower_placer.py writes): towers are vehicles
+   *    stopped at parking areas, positioned at the parking area end position on its lane
+   *  - a text file with one "<id> <x> <y>" per line ('#' comments, commas allowed)
+   * @param  path        the path to the file
+   * @param  edge_shapes lane shapes (for parking area positions)
+   * @param  towers      the loaded towers
+   * @param  region      if set, towers outside the region are skipped
+   * @return             success or failure
+   */
+  [[nodiscard]] bool load_tower_positions(const std::string& path,
+                                          const types::road_edge_map_t& edge_shapes,
+                                          std::vector<tower_position_t>& towers,
+                                          const filter::region_t *region = nullptr);
+}
+
+#endif /*_TOWER_POSITIONS_H*/
@@ -0,0 +1,44 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#include "vehicle_grid.h"
+
+namespace what_if {
+
+  /**
+   * Constructor
+   * @param cell_size the width of a grid cell (the query radius is best)
+   */
+  vehicle_grid_t::vehicle_grid_t(double cell_size)
+    : cell_size(cell_size),
+      entries() {}
+
+  /**
+   * Remove all vehicles (keeps capacity)
+   */
+  void vehicle_grid_t::clear() {
+    this->entries.clear();
+  }
+
+  /**
+   * Add a vehicle position
+   * @param id the vehicle id
+   * @param x  position x
+   * @param y  position y
+   */
+  void vehicle_grid_t::add(std::string_view id, double x, double y) {
+    int64_t ix = (int64_t) floor(x / this->cell_size);
+    int64_t iy = (int64_t) floor(y / this->cell_size);
+    this->entries.push_back({key(ix, iy), x, y, id});
+  }
+
+  /**
+   * Sort entries by cell (call after adding, before querying)
+   */
+  void vehicle_grid_t::build() {
+    //stable: keeps netstate order within a cell
+    std::stable_sort(this->entries.begin(), this->entries.end(),
+      [] (const grid_entry_t& a, const grid_entry_t& b) { return a.cell < b.cell; });
+  }
+}
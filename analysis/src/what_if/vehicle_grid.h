@@ -0,0 +1,116 @@
+/*
+ * Jack Hay, Oct 2026
+ */
+
+#ifndef _VEHICLE_GRID_H
+#define _VEHICLE_GRID_H
+
+#include <vector>
+#include <string_view>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+namespace what_if {
+  /*
+   * A vehicle position in the grid
+   */
+  struct grid_entry_t {
+    //the cell the vehicle is in
+    int64_t cell;
+    double x;
+    double y;
+    //the vehicle id (points into the parsed input, valid for the timestep)
+    std::string_view id;
+  };
+
+  /*
+   * Uniform grid over the vehicle positions of a single timestep
+   * (entries sorted by cell so the grid is rebuilt without allocating)
+   */
+  struct vehicle_grid_t {
+  private:
+    //the width of a grid cell
+    double cell_size;
+    std::vector<grid_entry_t> entries;
+
+    /**
+     * Get the key for a cell
+     * @param  ix column
+     * @param  iy row
+     * @return    the key
+     */
+    static int64_t key(int64_t ix, int64_t iy) {
+      return (int64_t) (((uint64_t) ix << 32) ^ (uint32_t) iy);
+    }
+
+  public:
+    /**
+     * Constructor
+     * @param cell_size the width of a grid cell (the query radius is best)
+     */
+    vehicle_grid_t(double cell_size);
+
+    //no copy
+    vehicle_grid_t(const vehicle_grid_t&) = delete;
+    vehicle_grid_t& operator=(const vehicle_grid_t&) = delete;
+
+    /**
+     * Remove all vehicles (keeps capacity)
+     */
+    void clear();
+
+    /**
+     * Add a vehicle position
+     * @param id the vehicle id
+     * @param x  position x
+     * @param y  position y
+     */
+    void add(std::string_view id, double x, double y);
+
+    /**
+     * Sort entries by cell (call after adding, before querying)
+     */
+    void build();
+
+    /**
+     * @return the number of vehicles in the grid
+     */
+    size_t size() const {
+      return this->entries.size();
+    }
+
+    /**
+     * Visit every vehicle within some radius of a point
+     * @param x      query position x
+     * @param y      query position y
+     * @param radius the radius (inclusive)
+     * @param fn     called with (vehicle id, distance)
+     */
+    template<typename F>
+    void query(double x, double y, double radius, F&& fn) const {
+      int64_t x0 = (int64_t) floor((x - radius) / this->cell_size);
+      int64_t x1 = (int64_t) floor((x + radius) / this->cell_size);
+      int64_t y0 = (int64_t) floor((y - radius) / this->cell_size);
+      int64_t y1 = (int64_t) floor((y + radius) / this->cell_size);
+
+      for (int64_t ix=x0; ix<=x1; ix++) {
+        for (int64_t iy=y0; iy<=y1; iy++) {
+          int64_t cell = key(ix, iy);
+          std::vector<grid_entry_t>::const_iterator it = std::lower_bound(
+            this->entries.begin(), this->entries.end(), cell,
+            [] (const grid_entry_t& e, int64_t c) { return e.cell < c; });
+
+          for (; (it != this->entries.end()) && (it->cell == cell); it++) {
+            double d = sqrt(pow(it->x - x, 2) + pow(it->y - y, 2));
+            if (d <= radius) {
+              fn(it->id, d);
+            }
+          }
+        }
+      }
+    }
+  };
+}
+
+#endif /*_VEHICLE_GRID_H*/
@@ -0,0 +1,417 @@
+"""Mock TraCI server: replays a netstate dump as a running simulation
+
+Serves a single client over the TraCI protocol (getVersion, simulationStep,
+close and variable subscriptions for the simulation and vehicles). Each
+simulation step replays the next netstate timestep. Vehicle positions are
+computed from the network lane shapes the same way the transformer places
+netstate vehicles, and towers ("<id> <x> <y>" list) are added as parked
+vehicles departing in the first step.
+
+Prints "PORT <port>" on stdout once listening.
+"""
+import argparse
+import bisect
+import math
+import socket
+import struct
+import sys
+import xml.etree.ElementTree as ET
+
+#commands
+CMD_GETVERSION = 0x00
+CMD_SIMSTEP = 0x02
+CMD_CLOSE = 0x7F
+CMD_SUBSCRIBE_VEHICLE_VARIABLE = 0xd4
+RESPONSE_SUBSCRIBE_VEHICLE = 0xe4
+CMD_SUBSCRIBE_SIM_VARIABLE = 0xdb
+RESPONSE_SUBSCRIBE_SIM = 0xeb
+
+#variables
+VAR_SPEED = 0x40
+VAR_POSITION = 0x42
+VAR_LANE_ID = 0x51
+VAR_LANEPOSITION = 0x56
+VAR_TIME = 0x66
+VAR_DEPARTED_VEHICLES_IDS = 0x74
+VAR_MIN_EXPECTED_VEHICLES = 0x7d
+
+#value types
+POSITION_2D = 0x01
+TYPE_INTEGER = 0x09
+TYPE_DOUBLE = 0x0B
+TYPE_STRING = 0x0C
+TYPE_STRINGLIST = 0x0E
+
+RTYPE_OK = 0x00
+RTYPE_ERR = 0xFF
+
+API_VERSION = 21
+IDENTIFIER = "mock traci server"
+
+
+def log(msg):
+    sys.stderr.write("[mock_server] %s\n" % msg)
+
+
+class Lane:
+    """A lane shape (mirrors road_edge_t::position_at)"""
+
+    def __init__(self, length, vertices):
+        self.length = length
+        self.vertices = vertices
+        self.cumulative = [0.0]
+        for (x0, y0), (x1, y1) in zip(vertices, vertices[1:]):
+            self.cumulative.append(self.cumulative[-1] +
+                                   math.sqrt(math.pow(x1 - x0, 2) + math.pow(y1 - y0, 2)))
+
+    def position_at(self, pos):
+        if len(self.vertices) == 1:
+            return self.vertices[0]
+
+        shape_length = self.cumulative[-1]
+        target = pos * (shape_length / self.length) if (self.length > 0 and shape_length > 0) else pos
+
+        i = bisect.bisect_right(self.cumulative, target)
+        i = min(max(i, 1), len(self.vertices) - 1)
+
+        x0, y0 = self.vertices[i - 1]
+        x1, y1 = self.vertices[i]
+        seg = self.cumulative[i] - self.cumulative[i - 1]
+        t = min(max((target - self.cumulative[i - 1]) / seg, 0.0), 1.0) if seg > 0 else 0
+        return x0 + t * (x1 - x0), y0 + t * (y1 - y0)
+
+
+def load_lanes(net_path):
+    """Load all lane shapes (the first of duplicate ids)"""
+    lanes = {}
+    for lane in ET.parse(net_path).getroot().iter("lane"):
+        if lane.get("id") in lanes:
+            continue
+        vertices = [tuple(float(v) for v in p.split(",")) for p in lane.get("shape").split(" ")]
+        lanes[lane.get("id")] = Lane(float(lane.get("length", "-1")), vertices)
+    return lanes
+
+
+def load_towers(towers_path):
+    towers = []
+    with open(towers_path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) == 3 and not line.startswith("#"):
+                towers.append((fields[0], float(fields[1]), float(fields[2])))
+    return towers
+
+
+def timesteps(netstate_path):
+    """Yield (time, [(vehicle id, lane id, pos, speed)]) for each netstate timestep"""
+    for _, elem in ET.iterparse(netstate_path):
+        if elem.tag != "timestep":
+            continue
+        vehicles = []
+        for lane in elem.iter("lane"):
+            for vehicle in lane.iter("vehicle"):
+                vehicles.append((vehicle.get("id"), lane.get("id"),
+                                 float(vehicle.get("pos")), float(vehicle.get("speed", "0"))))
+        yield float(elem.get("time")), vehicles
+        elem.clear()
+
+
+def last_steps(netstate_path):
+    """The index of the last timestep each vehicle is in (for the expected vehicle count)"""
+    last = {}
+    for i, (_, vehicles) in enumerate(timesteps(netstate_path)):
+        for vehicle in vehicles:
+            last[vehicle[0]] = i
+    return last
+
+
+class Writer:
+    def __init__(self):
+        self.data = bytearray()
+
+    def ubyte(self, v):
+        self.data += struct.pack(">B", v)
+
+    def integer(self, v):
+        self.data += struct.pack(">i", v)
+
+    def double(self, v):
+        self.data += struct.pack(">d", v)
+
+    def string(self, v):
+        encoded = v.encode()
+        self.integer(len(encoded))
+        self.data += encoded
+
+    def stringlist(self, v):
+        self.integer(len(v))
+        for s in v:
+            self.string(s)
+
+    def command(self, cmd, content):
+        """Append a framed command (short or extended length)"""
+        length = len(content) + 2
+        if length <= 255:
+            self.ubyte(length)
+        else:
+            self.ubyte(0)
+            self.integer(length + 4)
+        self.ubyte(cmd)
+        self.data += content
+
+    def status(self, cmd, result=RTYPE_OK, description=""):
+        content = Writer()
+        content.ubyte(result)
+        content.string(description)
+        self.command(cmd, content.data)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, n):
+        v = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return v
+
+    def ubyte(self):
+        return struct.unpack(">B", self.take(1))[0]
+
+    def integer(self):
+        return struct.unpack(">i", self.take(4))[0]
+
+    def double(self):
+        return struct.unpack(">d", self.take(8))[0]
+
+    def string(self):
+        return self.take(self.integer()).decode()
+
+    def commands(self):
+        """Yield (command id, content reader) for each command"""
+        while self.pos < len(self.data):
+            start = self.pos
+            length = self.ubyte()
+            if length == 0:
+                length = self.integer()
+            cmd = self.ubyte()
+            end = start + length
+            yield cmd, Reader(self.data[self.pos:end])
+            self.pos = end
+
+
+class Simulation:
+    """Replays the netstate one timestep per simulation step"""
+
+    def __init__(self, lanes, towers, netstate_path):
+        self.lanes = lanes
+        self.towers = towers
+        self.steps = timesteps(netstate_path)
+        self.last = last_steps(netstate_path)
+        self.index = -1
+        self.time = 0.0
+        self.vehicles = {}
+        self.departed = []
+
+    def step(self):
+        """Advance one timestep, False once the netstate is exhausted"""
+        try:
+            self.time, vehicles = next(self.steps)
+        except StopIteration:
+            return False
+
+        self.index += 1
+        previous = self.vehicles
+        self.vehicles = {}
+
+        if self.index == 0:
+            for tower_id, x, y in self.towers:
+                self.vehicles[tower_id] = ("", x, y, 0.0, 0.0)
+
+        for vehicle_id, lane_id, pos, speed in vehicles:
+            x, y = self.lanes[lane_id].position_at(pos)
+            self.vehicles[vehicle_id] = (lane_id, x, y, speed, pos)
+
+        if self.index > 0:
+            for tower_id, x, y in self.towers:
+                self.vehicles[tower_id] = previous[tower_id]
+
+        self.departed = [v for v in self.vehicles if v not in previous]
+        return True
+
+    def min_expected(self):
+        """Vehicles that are still in later timesteps (towers stay parked)"""
+        return sum(1 for last in self.last.values() if last > self.index)
+
+
+def vehicle_value(out, var, state):
+    lane_id, x, y, speed, pos = state
+    out.ubyte(var)
+    if var == VAR_LANE_ID:
+        out.ubyte(RTYPE_OK)
+        out.ubyte(TYPE_STRING)
+        out.string(lane_id)
+    elif var == VAR_POSITION:
+        out.ubyte(RTYPE_OK)
+        out.ubyte(POSITION_2D)
+        out.double(x)
+        out.double(y)
+    elif var == VAR_SPEED:
+        out.ubyte(RTYPE_OK)
+        out.ubyte(TYPE_DOUBLE)
+        out.double(speed)
+    elif var == VAR_LANEPOSITION:
+        out.ubyte(RTYPE_OK)
+        out.ubyte(TYPE_DOUBLE)
+        out.double(pos)
+    else:
+        out.ubyte(RTYPE_ERR)
+        out.ubyte(TYPE_STRING)
+        out.string("unsupported variable")
+
+
+def sim_value(out, var, sim):
+    out.ubyte(var)
+    if var == VAR_TIME:
+        out.ubyte(RTYPE_OK)
+        out.ubyte(TYPE_DOUBLE)
+        out.double(sim.time)
+    elif var == VAR_DEPARTED_VEHICLES_IDS:
+        out.ubyte(RTYPE_OK)
+        out.ubyte(TYPE_STRINGLIST)
+        out.stringlist(sim.departed)
+    elif var == VAR_MIN_EXPECTED_VEHICLES:
+        out.ubyte(RTYPE_OK)
+        out.ubyte(TYPE_INTEGER)
+        out.integer(sim.min_expected())
+    else:
+        out.ubyte(RTYPE_ERR)
+        out.ubyte(TYPE_STRING)
+        out.string("unsupported variable")
+
+
+def subscription(out, response, object_id, variables, value):
+    content = Writer()
+    content.string(object_id)
+    content.ubyte(len(variables))
+    for var in variables:
+        value(content, var)
+    out.command(response, content.data)
+
+
+def recv_exact(conn, n):
+    data = bytearray()
+    while len(data) < n:
+        chunk = conn.recv(n - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return bytes(data)
+
+
+def serve(conn, sim):
+    sim_variables = None
+    vehicle_variables = {}
+
+    while True:
+        header = recv_exact(conn, 4)
+        if header is None:
+            return
+        message = recv_exact(conn, struct.unpack(">i", header)[0] - 4)
+        if message is None:
+            return
+
+        out = Writer()
+        for cmd, reader in Reader(message).commands():
+            if cmd == CMD_GETVERSION:
+                out.status(cmd)
+                content = Writer()
+                content.integer(API_VERSION)
+                content.string(IDENTIFIER)
+                out.command(cmd, content.data)
+
+            elif cmd == CMD_SIMSTEP:
+                if not sim.step():
+                    #the simulation has ended
+                    log("netstate replayed")
+                    return
+                out.status(cmd)
+
+                #arrived vehicles are unsubscribed
+                vehicle_variables = {v: variables for v, variables in vehicle_variables.items()
+                                     if v in sim.vehicles}
+                results = Writer()
+                count = 0
+                if sim_variables is not None:
+                    subscription(results, RESPONSE_SUBSCRIBE_SIM, "", sim_variables,
+                                 lambda o, var: sim_value(o, var, sim))
+                    count += 1
+                for vehicle_id, state in sim.vehicles.items():
+                    if vehicle_id in vehicle_variables:
+                        subscription(results, RESPONSE_SUBSCRIBE_VEHICLE, vehicle_id,
+                                     vehicle_variables[vehicle_id],
+                                     lambda o, var, state=state: vehicle_value(o, var, state))
+                        count += 1
+                out.integer(count)
+                out.data += results.data
+
+            elif cmd in (CMD_SUBSCRIBE_SIM_VARIABLE, CMD_SUBSCRIBE_VEHICLE_VARIABLE):
+                reader.double()
+                reader.double()
+                object_id = reader.string()
+                variables = [reader.ubyte() for _ in range(reader.ubyte())]
+
+                if cmd == CMD_SUBSCRIBE_SIM_VARIABLE:
+                    sim_variables = variables
+                    out.status(cmd)
+                    subscription(out, RESPONSE_SUBSCRIBE_SIM, object_id, variables,
+                                 lambda o, var: sim_value(o, var, sim))
+                elif object_id in sim.vehicles:
+                    vehicle_variables[object_id] = variables
+                    out.status(cmd)
+                    subscription(out, RESPONSE_SUBSCRIBE_VEHICLE, object_id, variables,
+                                 lambda o, var: vehicle_value(o, var, sim.vehicles[object_id]))
+                else:
+                    out.status(cmd, RTYPE_ERR, "Vehicle '%s' is not known" % object_id)
+
+            elif cmd == CMD_CLOSE:
+                out.status(cmd)
+                conn.sendall(struct.pack(">i", len(out.data) + 4) + out.data)
+                return
+
+            else:
+                out.status(cmd, RTYPE_ERR, "unsupported command 0x%02x" % cmd)
+
+        conn.sendall(struct.pack(">i", len(out.data) + 4) + out.data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-n", "--net", required=True, help="sumo network")
+    parser.add_argument("-r", "--netstate", required=True, help="netstate dump to replay")
+    parser.add_argument("-t", "--towers", help="tower positions (<id> <x> <y> per line)")
+    parser.add_argument("-p", "--port", type=int, default=0, help="port (0: any free port)")
+    args = parser.parse_args()
+
+    lanes = load_lanes(args.net)
+    towers = load_towers(args.towers) if args.towers else []
+    sim = Simulation(lanes, towers, args.netstate)
+
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind(("127.0.0.1", args.port))
+    listener.listen(1)
+    print("PORT %d" % listener.getsockname()[1], flush=True)
+
+    conn, _ = listener.accept()
+    conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    try:
+        serve(conn, sim)
+    finally:
+        conn.close()
+        listener.close()
+
+
+if __name__ == "__main__":
+    main()
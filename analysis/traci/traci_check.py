@@ -0,0 +1,121 @@
+"""End to end check of the transformer's traci ingestion mode
+
+Replays the small synthetic netstate through the mock traci server (with the
+towers of the synthetic bt output parked as vehicles) and checks that the
+outputs match a what-if run over the same netstate and tower positions
+(both compute recognitions from the positions of vehicles).
+"""
+import argparse
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+
+TRACI_DIR = os.path.dirname(os.path.abspath(__file__))
+ANALYSIS_DIR = os.path.dirname(TRACI_DIR)
+sys.path.insert(0, os.path.join(ANALYSIS_DIR, "perf"))
+
+import perf_check  # noqa: E402
+
+MOCK_SERVER = os.path.join(TRACI_DIR, "mock_server.py")
+OUTPUTS = perf_check.OUTPUTS + ["vehicle_trajectory_output.bin"]
+OBSERVER_POS = re.compile(r'<bt id="([^"]+)">\s*<seen [^>]*observerPosBeg="([^,"]+),([^"]+)"')
+
+
+def log(msg):
+    sys.stderr.write("[traci_check] %s\n" % msg)
+
+
+def write_towers(bt_path, towers_path):
+    """Extract the (parked) tower positions from the bt output"""
+    with open(bt_path) as f:
+        towers = OBSERVER_POS.findall(f.read())
+    with open(towers_path, "w") as f:
+        for tower_id, x, y in towers:
+            f.write("%s %s %s\n" % (tower_id, x, y))
+    return len(towers)
+
+
+def trajectory_rows(path):
+    """Decode the trajectory output into sorted rows
+    (lane and vehicle ids are indexed in the order they are first seen)"""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    lane_count, vehicle_count, row_count = struct.unpack_from("<IIQ", data, 8)
+    offset = 24
+    ids = []
+    for _ in range(lane_count + vehicle_count):
+        (size,) = struct.unpack_from("<H", data, offset)
+        ids.append(data[offset + 2:offset + 2 + size].decode())
+        offset += 2 + size
+    lanes, vehicles = ids[:lane_count], ids[lane_count:]
+
+    offsets = struct.unpack_from("<%dQ" % (vehicle_count + 1), data, offset)
+    offset += 8 * (vehicle_count + 1)
+    cols = []
+    for fmt in ("i", "I", "f", "f", "f", "f"):
+        cols.append(struct.unpack_from("<%d%s" % (row_count, fmt), data, offset))
+        offset += 4 * row_count
+
+    rows = []
+    for v in range(vehicle_count):
+        for row in range(offsets[v], offsets[v + 1]):
+            rows.append((vehicles[v], cols[0][row], lanes[cols[1][row]]) + tuple(col[row] for col in cols[2:]))
+    return sorted(rows, key=repr)
+
+
+def digest(path):
+    if path.endswith(".json"):
+        return perf_check.canonical_digest(path)
+    return trajectory_rows(path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--range", default="100", help="recognition range (meters)")
+    args = parser.parse_args()
+
+    name, vehicles, towers, duration, seed, lanes, _ = perf_check.SCALES[0]
+    bt_path, ns_path, _ = perf_check.generate(name, vehicles, towers, duration, seed, lanes)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        towers_path = os.path.join(tmp, "towers.txt")
+        log("%d towers" % write_towers(bt_path, towers_path))
+
+        what_if_dir = os.path.join(tmp, "what_if")
+        traci_dir = os.path.join(tmp, "traci")
+        os.makedirs(what_if_dir)
+        os.makedirs(traci_dir)
+        common = ["-n", perf_check.NET_PATH, "--range", args.range, "--trajectories"]
+
+        subprocess.run([perf_check.TRANSFORMER, "--what-if", towers_path, "-r", ns_path,
+                        "-o", what_if_dir] + common, check=True, stderr=subprocess.DEVNULL)
+
+        server = subprocess.Popen([sys.executable, MOCK_SERVER, "-n", perf_check.NET_PATH,
+                                   "-r", ns_path, "-t", towers_path],
+                                  stdout=subprocess.PIPE, text=True)
+        try:
+            port = server.stdout.readline().split()[1]
+            subprocess.run([perf_check.TRANSFORMER, "--traci", "localhost:" + port,
+                            "-o", traci_dir] + common, check=True, stderr=subprocess.DEVNULL)
+        finally:
+            server.wait(timeout=60)
+
+        failed = False
+        for output in OUTPUTS:
+            same = digest(os.path.join(what_if_dir, output)) == digest(os.path.join(traci_dir, output))
+            log("%s %s" % (output, "ok" if same else "DIFFERS"))
+            failed |= not same
+
+    if failed:
+        log("FAIL: traci outputs differ from the what-if outputs")
+        return 1
+    log("OK")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())